@@ -0,0 +1,101 @@
+#include <CPlus/Parser/Keywords.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief keywords benchmark
+ * @details identifier throughput of the perfect hash against the std::unordered_map it replaced,
+ * on a stream mixing keywords with identifiers shaped like them (same length, same first/last character)
+ */
+
+/** @brief the baseline, filled from the same KEYWORDS table the perfect hash is built from */
+static std::unordered_map<std::string_view, cplus::lx::TokenKind> _map()
+{
+    std::unordered_map<std::string_view, cplus::lx::TokenKind> map;
+
+    for (const auto &keyword : cplus::lx::KEYWORDS) {
+        map.emplace(keyword.lexeme, keyword.kind);
+    }
+    return map;
+}
+
+static constexpr cplus::u64 LEXEMES = 1 << 16;
+static constexpr cplus::u32 ROUNDS = 200;
+
+static std::vector<std::string> _lexemes()
+{
+    static constexpr char alphabet[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+    std::mt19937_64 random(42);
+    std::vector<std::string> lexemes;
+
+    lexemes.reserve(LEXEMES);
+    for (cplus::u64 i = 0; i < LEXEMES; ++i) {
+        const auto &keyword = cplus::lx::KEYWORDS[random() % std::size(cplus::lx::KEYWORDS)];
+
+        switch (random() % 4) {
+            case 0:
+                lexemes.emplace_back(keyword.lexeme);
+                break;
+            case 1: {
+                std::string lookalike(keyword.lexeme);
+
+                lookalike[lookalike.size() / 2] = alphabet[random() % 26];
+                lexemes.push_back(lookalike);
+                break;
+            }
+            default: {
+                std::string identifier(1, alphabet[random() % 26]);
+
+                for (cplus::u64 length = 1 + random() % 12; length > 0; --length) {
+                    identifier += alphabet[random() % (sizeof(alphabet) - 1)];
+                }
+                lexemes.push_back(identifier);
+                break;
+            }
+        }
+    }
+    return lexemes;
+}
+
+template<typename Lookup>
+static cplus::f64 _measure(const char *name, const std::vector<std::string> &lexemes, Lookup &&lookup)
+{
+    cplus::u64 keywords = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (cplus::u32 round = 0; round < ROUNDS; ++round) {
+        for (const auto &lexeme : lexemes) {
+            keywords += lookup(std::string_view(lexeme)) != cplus::lx::TokenKind::TOKEN_IDENTIFIER;
+        }
+    }
+
+    const std::chrono::duration<cplus::f64> elapsed = std::chrono::steady_clock::now() - start;
+    const cplus::f64 throughput = static_cast<cplus::f64>(LEXEMES * ROUNDS) / elapsed.count() / 1e6;
+
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << throughput
+              << " M identifiers/s  (" << keywords << " keywords)" << std::endl;
+    return throughput;
+}
+
+int main()
+{
+    const auto lexemes = _lexemes();
+
+    const auto keywords = _map();
+
+    const cplus::f64 map = _measure("unordered_map", lexemes, [&keywords](const std::string_view lexeme) {
+        const auto it = keywords.find(lexeme);
+
+        return it != keywords.end() ? it->second : cplus::lx::TokenKind::TOKEN_IDENTIFIER;
+    });
+    const cplus::f64 perfect = _measure("perfect hash", lexemes, [](const std::string_view lexeme) { return cplus::lx::keyword(lexeme); });
+
+    std::cout << "speedup: " << std::setprecision(2) << perfect / map << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,23 @@
+/* case values may be module constants or constant expressions, a clause runs until the next label */
+const K = 7;
+
+@inline(never)
+def pick(x: int) -> int
+{
+    r = 0;
+    case (x) {
+        1: r = 10;
+        K: r = 20;
+        (0 - 1): r = 30;
+        K + 1, 2 * 5:
+            y: int = x * 2;
+            r = y;
+        default: r = 99;
+    }
+    return r;
+}
+
+def main() -> int
+{
+    return pick(1) + pick(7) + pick(0 - 1) + pick(8) + pick(10) + pick(3);
+}
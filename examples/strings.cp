@@ -0,0 +1,21 @@
+/* name is pure, but returns the address of a literal: only known once linked */
+def name(x: int) -> string
+{
+    return "hello";
+}
+
+/* both calls return the same literal, whatever the optimization level */
+@export def entry(n: int) -> int
+{
+    a = name(3);
+    b = name(n);
+    if a == b {
+        return 1;
+    }
+    return 2;
+}
+
+def main() -> int
+{
+    return entry(7);
+}
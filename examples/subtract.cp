@@ -0,0 +1,12 @@
+/* p - p is zero, even when the difference reuses the register of p */
+def main() -> int
+{
+    p = 1;
+    q = 3;
+    for (i = 0; i < 4; i = i + 1) {
+        p = p * 2 + q;
+        q = q + i;
+    }
+    t = q * 3;
+    return (p - p) * t + 1;
+}
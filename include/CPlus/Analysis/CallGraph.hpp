@@ -0,0 +1,114 @@
+#pragma once
+
+#include <CPlus/Codegen/IR.hpp>
+
+namespace cplus::ir {
+
+/**
+ * @brief effects
+ * @details bits of what a call may do besides computing its result, see CallGraph::effects
+ */
+enum Effects : u8 {
+    EFFECT_NONE = 0,
+    EFFECT_READS_MEMORY = 1 << 0,//<< loads from a global
+    EFFECT_WRITES_MEMORY = 1 << 1,//<< stores to a global
+    EFFECT_IO = 1 << 2,//<< reserved for runtime calls, C+ has none yet so no function sets it
+    EFFECT_MAY_RECURSE = 1 << 3,//<< may re-enter a function still running: a cycle in the call graph
+};
+
+/**
+ * @brief CallGraph
+ * @details direct calls between the functions of a module, with its strongly connected components
+ *
+ * components are found with an iterative Tarjan and listed callees first, so a bottom-up walk sees every callee
+ * before its callers except within a cycle. a function is recursive when its component has more than one function
+ * or when it calls itself.
+ *
+ * every function has an effect summary: the effects of its own instructions and of everything it may call, every
+ * callee is defined in the module. the summary is shared by a component, whose functions may all call each other.
+ * the memoization tables are left out of it: they cache results without changing them, nothing else can tell a hit
+ * from a recomputation.
+ *
+ * a function is pure when calling it twice with the same arguments gives the same result and nothing else can tell
+ * the two calls apart: it neither reads nor writes memory and performs no I/O, recursing is fine.
+ */
+class CallGraph
+{
+    public:
+        explicit CallGraph(const Module &module);
+
+        inline u32 size() const
+        {
+            return static_cast<u32>(_callees.size());
+        }
+
+        /** @brief distinct, in the order of their first call */
+        inline const std::vector<FunctionId> &callees(const FunctionId function) const
+        {
+            return _callees[function];
+        }
+
+        /** @brief distinct, in layout order */
+        inline const std::vector<FunctionId> &callers(const FunctionId function) const
+        {
+            return _callers[function];
+        }
+
+        /** @brief static number of `call` instructions targeting a function */
+        inline u32 call_sites(const FunctionId function) const
+        {
+            return _call_sites[function];
+        }
+
+        inline bool is_recursive(const FunctionId function) const
+        {
+            return _recursive[function];
+        }
+
+        inline bool is_pure(const FunctionId function) const
+        {
+            return (_effects[function] & (EFFECT_READS_MEMORY | EFFECT_WRITES_MEMORY | EFFECT_IO)) == 0;
+        }
+
+        /** @brief mask of Effects */
+        inline u8 effects(const FunctionId function) const
+        {
+            return _effects[function];
+        }
+
+        /** @brief components, callees before callers */
+        inline const std::vector<std::vector<FunctionId>> &components() const
+        {
+            return _components;
+        }
+
+        /** @brief index of the component of a function in components */
+        inline u32 component_of(const FunctionId function) const
+        {
+            return _component[function];
+        }
+
+        /** @brief every function, components flattened callees first */
+        inline const std::vector<FunctionId> &bottom_up() const
+        {
+            return _order;
+        }
+
+    private:
+        std::vector<std::vector<FunctionId>> _callees;
+        std::vector<std::vector<FunctionId>> _callers;
+        std::vector<u32> _call_sites;
+        std::vector<bool> _recursive;
+        std::vector<u8> _effects;
+        std::vector<std::vector<FunctionId>> _components;
+        std::vector<u32> _component;
+        std::vector<FunctionId> _order;
+
+        void _find_components();
+        void _find_effects(const Module &module);
+};
+
+/** @brief `effects(reads, writes, io, recurse)`, or `effects(none)` */
+std::string describe_effects(const u8 effects);
+
+}// namespace cplus::ir
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <CPlus/Codegen/IR.hpp>
+
+namespace cplus::ir {
+
+/**
+ * @brief ControlFlowGraph
+ * @details successor and predecessor lists of the blocks of a function, with their reverse post-order from the entry
+ *
+ * edges come from the terminators and are distinct, blocks the entry cannot reach keep their edges
+ * but are left out of the order, see is_reachable.
+ */
+class ControlFlowGraph
+{
+    public:
+        explicit ControlFlowGraph(const Function &function);
+
+        inline u32 size() const
+        {
+            return static_cast<u32>(_successors.size());
+        }
+
+        inline const std::vector<BlockId> &successors(const BlockId block) const
+        {
+            return _successors[block];
+        }
+
+        inline const std::vector<BlockId> &predecessors(const BlockId block) const
+        {
+            return _predecessors[block];
+        }
+
+        /** @brief reachable blocks, every block before its successors except along back edges */
+        inline const std::vector<BlockId> &reverse_post_order() const
+        {
+            return _order;
+        }
+
+        inline bool is_reachable(const BlockId block) const
+        {
+            return _order_index[block] != INVALID_ID;
+        }
+
+        /** @brief position of a reachable block in the reverse post-order */
+        inline u32 order_index(const BlockId block) const
+        {
+            return _order_index[block];
+        }
+
+    private:
+        std::vector<std::vector<BlockId>> _successors;
+        std::vector<std::vector<BlockId>> _predecessors;
+        std::vector<BlockId> _order;
+        std::vector<u32> _order_index;
+};
+
+}// namespace cplus::ir
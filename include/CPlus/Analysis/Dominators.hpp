@@ -0,0 +1,75 @@
+#pragma once
+
+#include <CPlus/Analysis/ControlFlowGraph.hpp>
+
+namespace cplus::ir {
+
+/**
+ * @brief DominatorTree
+ * @details immediate dominators of the reachable blocks, semi-NCA (Georgiadis et al.): semidominators from a
+ * depth-first numbering with path compression, then each immediate dominator is the nearest common ancestor
+ * of its block's parent and semidominator. dominance queries are constant time through tree entry/exit numbers
+ */
+class DominatorTree
+{
+    public:
+        explicit DominatorTree(const ControlFlowGraph &cfg);
+
+        /** @brief INVALID_ID for the entry and the unreachable blocks */
+        inline BlockId idom(const BlockId block) const
+        {
+            return _idom[block];
+        }
+
+        inline const std::vector<BlockId> &children(const BlockId block) const
+        {
+            return _children[block];
+        }
+
+        /** @brief every path from the entry to b goes through a, a block dominates itself */
+        inline bool dominates(const BlockId a, const BlockId b) const
+        {
+            return _enter[a] != INVALID_ID && _enter[b] != INVALID_ID && _enter[a] <= _enter[b] && _exit[b] <= _exit[a];
+        }
+
+        inline bool strictly_dominates(const BlockId a, const BlockId b) const
+        {
+            return a != b && dominates(a, b);
+        }
+
+        /** @brief reachable blocks, children after their parent */
+        inline const std::vector<BlockId> &pre_order() const
+        {
+            return _pre_order;
+        }
+
+    private:
+        std::vector<BlockId> _idom;
+        std::vector<std::vector<BlockId>> _children;
+        std::vector<u32> _enter;
+        std::vector<u32> _exit;
+        std::vector<BlockId> _pre_order;
+
+        void _number();
+};
+
+/**
+ * @brief DominanceFrontier
+ * @details blocks where the dominance of a block ends, i.e. where its definitions meet others (phi placement):
+ * walks up the dominator tree from the predecessors of every join block (Cooper, Harvey & Kennedy)
+ */
+class DominanceFrontier
+{
+    public:
+        DominanceFrontier(const ControlFlowGraph &cfg, const DominatorTree &dominators);
+
+        inline const std::vector<BlockId> &frontier(const BlockId block) const
+        {
+            return _frontiers[block];
+        }
+
+    private:
+        std::vector<std::vector<BlockId>> _frontiers;
+};
+
+}// namespace cplus::ir
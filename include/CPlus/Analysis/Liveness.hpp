@@ -0,0 +1,87 @@
+#pragma once
+
+#include <CPlus/Codegen/IR.hpp>
+
+namespace cplus::ir {
+
+/**
+ * @brief ValueSet
+ * @details dense bitset over the SSA values of a function
+ */
+class ValueSet
+{
+    public:
+        ValueSet() = default;
+        explicit ValueSet(const u32 values) : _words((values + 63) / 64, 0)
+        {
+            /* __ctor__ */
+        }
+
+        inline bool contains(const ValueId value) const
+        {
+            return (_words[value / 64] >> (value % 64)) & 1;
+        }
+
+        inline void insert(const ValueId value)
+        {
+            _words[value / 64] |= u64{1} << (value % 64);
+        }
+
+        inline void erase(const ValueId value)
+        {
+            _words[value / 64] &= ~(u64{1} << (value % 64));
+        }
+
+        /** @brief union in place, returns true when the set grew */
+        inline bool merge(const ValueSet &other)
+        {
+            bool changed = false;
+
+            for (u64 i = 0; i < _words.size(); ++i) {
+                const u64 merged = _words[i] | other._words[i];
+
+                changed |= merged != _words[i];
+                _words[i] = merged;
+            }
+            return changed;
+        }
+
+        template<typename Fn>
+        inline void for_each(Fn &&fn) const
+        {
+            for (u64 i = 0; i < _words.size(); ++i) {
+                for (u64 word = _words[i]; word; word &= word - 1) {
+                    fn(static_cast<ValueId>(i * 64 + static_cast<u64>(__builtin_ctzll(word))));
+                }
+            }
+        }
+
+    private:
+        std::vector<u64> _words;
+};
+
+/**
+ * @brief Liveness
+ * @details backward dataflow over the blocks of a function, phi operands are live-out of their incoming block
+ */
+class Liveness
+{
+    public:
+        explicit Liveness(const Function &function);
+
+        inline const ValueSet &live_in(const BlockId block) const
+        {
+            return _live_in[block];
+        }
+
+        inline const ValueSet &live_out(const BlockId block) const
+        {
+            return _live_out[block];
+        }
+
+    private:
+        std::vector<ValueSet> _live_in;
+        std::vector<ValueSet> _live_out;
+};
+
+}// namespace cplus::ir
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <CPlus/Analysis/Dominators.hpp>
+
+namespace cplus::ir {
+
+// clang-format off
+struct Loop {
+    BlockId header;
+    u32 parent = INVALID_ID;//<< index of the enclosing loop in LoopInfo::loops
+    u32 depth = 1;//<< 1 for an outermost loop
+    std::vector<BlockId> latches;//<< blocks with a back edge to the header
+    std::vector<BlockId> blocks;//<< header first, nested loops included
+};
+// clang-format on
+
+/**
+ * @brief LoopInfo
+ * @details natural loop nest of a function: a back edge goes to a block dominating its source, the loop of a header
+ * is every block reaching one of its latches without going through it
+ *
+ * headers are visited in dominator tree post-order so inner loops are found first, the outer loop walking back from
+ * its latches adopts the outermost loop already found for a block instead of walking it again.
+ */
+class LoopInfo
+{
+    public:
+        LoopInfo(const ControlFlowGraph &cfg, const DominatorTree &dominators);
+
+        /** @brief inner loops before the loops containing them */
+        inline const std::vector<Loop> &loops() const
+        {
+            return _loops;
+        }
+
+        /** @brief innermost loop of a block, INVALID_ID outside any loop */
+        inline u32 loop_of(const BlockId block) const
+        {
+            return _innermost[block];
+        }
+
+        /** @brief number of loops containing a block, 0 outside any loop */
+        inline u32 depth(const BlockId block) const
+        {
+            return _innermost[block] == INVALID_ID ? 0 : _loops[_innermost[block]].depth;
+        }
+
+        inline bool is_header(const BlockId block) const
+        {
+            return _innermost[block] != INVALID_ID && _loops[_innermost[block]].header == block;
+        }
+
+    private:
+        std::vector<Loop> _loops;
+        std::vector<u32> _innermost;
+
+        u32 _outermost(u32 loop) const;
+};
+
+}// namespace cplus::ir
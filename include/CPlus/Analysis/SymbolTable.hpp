@@ -69,6 +69,10 @@ class SymbolTable : public CompilerPass<std::unique_ptr<ast::Module>, std::uniqu
         constexpr ~SymbolTable() override = default;
 
         std::unique_ptr<ast::Module> run(const std::unique_ptr<ast::Module> &module) override;
+        cstr name() const override
+        {
+            return "symbol-table";
+        }
 
     private:
         std::vector<std::unique_ptr<st::Scope>> _scope_stack;
@@ -77,6 +81,7 @@ class SymbolTable : public CompilerPass<std::unique_ptr<ast::Module>, std::uniqu
 
         st::Scope *_current_scope = nullptr;
         cstr _module;
+        ast::ASTContext *_context = nullptr;//<< symbol and expression types live in the module arena
 
         void visit(ast::LiteralExpression &node) override;
         void visit(ast::IdentifierExpression &node) override;
@@ -90,6 +95,7 @@ class SymbolTable : public CompilerPass<std::unique_ptr<ast::Module>, std::uniqu
         void visit(ast::ReturnStatement &node) override;
         void visit(ast::IfStatement &node) override;
         void visit(ast::ForStatement &node) override;
+        void visit(ast::WhileStatement &node) override;
         void visit(ast::ForeachStatement &node) override;
         void visit(ast::CaseStatement &node) override;
         void visit(ast::FunctionDeclaration &node) override;
@@ -104,6 +110,8 @@ class SymbolTable : public CompilerPass<std::unique_ptr<ast::Module>, std::uniqu
             u64 column = 0);
         st::Symbol *_lookup(const std::string &name);
         ast::TypePtr _infer_type(ast::Expression &expr);
+        ast::TypePtr _make_type(const ast::Type::Kind k);
+        void _check_attributes(const ast::FunctionDeclaration &node) const;
         bool _is_compatible(const ast::Type *left, const ast::Type *right);
 };
 
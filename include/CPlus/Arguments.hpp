@@ -11,12 +11,32 @@ enum Flags {
     FLAG_SHOW_AST = 1 << 3,
     FLAG_SHOW_TOKENS = 1 << 4,
     FLAG_SHOW_IR = 1 << 5,
+    FLAG_EMIT_ASM = 1 << 6,
+    FLAG_EMIT_OBJ = 1 << 7,
+    FLAG_NO_CACHE = 1 << 8,
+    FLAG_CACHE_STATS = 1 << 9,
+    FLAG_TIME_PASSES = 1 << 10,
+    FLAG_AUTO_MEMOIZE = 1 << 11,
     FLAG_NONE,
 };
 
+enum OptLevel : u8 {
+    OPT_O0,//<< fastest compile: no IR transformation, no register allocation
+    OPT_O1,//<< cleanups that never grow the code
+    OPT_O2,
+    OPT_O3,//<< inlines more aggressively than -O2
+    OPT_OS,//<< smallest code: only inlines calls costing more than the callee body
+};
+
 extern i32 cplus_flags;
+extern OptLevel cplus_opt_level;
 extern std::vector<cstr> cplus_input_files;
+extern std::vector<cstr> cplus_link_objects;
 extern cstr cplus_output_file;
+extern u32 cplus_jobs;
+extern cstr cplus_cache_dir;
+extern u64 cplus_cache_size;
+extern cstr cplus_time_report;
 
 void arguments(const i32 argc, const char **argv);
 
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <CPlus/Parser/Types.hpp>
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cplus::ir {
+
+using ValueId = u32;
+using BlockId = u32;
+using FunctionId = u32;
+
+static constexpr u32 INVALID_ID = ~0u;
+
+/**
+ * @brief Opcode
+ * @details every SSA instruction the IR can hold, operand layout is documented per opcode
+ */
+enum class Opcode : u8 {
+    ARG,//<< %d = arg <imm index>
+    MOV,//<< %d = mov a
+    UNDEF,//<< %d = undef
+
+    ADD,//<< %d = add a, b
+    SUB,
+    MUL,
+    SDIV,
+    SREM,
+    AND,
+    OR,
+    NEG,//<< %d = neg a
+
+    ICMP_EQ,//<< %d = icmp.eq a, b (0 or 1)
+    ICMP_NE,
+    ICMP_SLT,
+    ICMP_SLE,
+    ICMP_SGT,
+    ICMP_SGE,
+
+    LOAD,//<< %d = load @global, index (dword element)
+    STORE,//<< store @global, index, a
+
+    CALL,//<< %d = call @callee(args...)
+    PHI,//<< %d = phi [a, block], [b, block]...
+
+    BR,//<< br cond, then_block, else_block
+    JMP,//<< br block
+    SWITCH,//<< switch a, default_block, [imm, block]... (case values are distinct)
+    RET,//<< ret [a]
+};
+
+// clang-format off
+struct Operand {
+    enum Kind : u8 { NONE, VALUE, IMMEDIATE, STRING, BLOCK, GLOBAL };
+
+    Kind kind = NONE;
+    i64 data = 0;
+
+    static constexpr Operand value(const ValueId id) { return {VALUE, id}; }
+    static constexpr Operand immediate(const i64 imm) { return {IMMEDIATE, imm}; }
+    static constexpr Operand string(const u32 index) { return {STRING, index}; }
+    static constexpr Operand block(const BlockId id) { return {BLOCK, id}; }
+    static constexpr Operand global(const u32 index) { return {GLOBAL, index}; }
+
+    constexpr bool is_value() const { return kind == VALUE; }
+    constexpr bool is_immediate() const { return kind == IMMEDIATE; }
+    constexpr u32 id() const { return static_cast<u32>(data); }
+
+    constexpr bool operator==(const Operand &other) const = default;
+};
+
+struct Instruction {
+    Opcode opcode;
+    ValueId result = INVALID_ID;
+    FunctionId callee = INVALID_ID;//<< CALL only, index in Module::functions
+    std::vector<Operand> operands;
+};
+
+struct BasicBlock {
+    cstr name;//<< label hint, e.g. "if.then"
+    u32 label;//<< module-unique suffix of the label
+    std::vector<Instruction> instructions;
+};
+
+struct Function {
+    enum class Inline : u8 { DEFAULT, ALWAYS, NEVER };//<< @inline(always) / @inline(never)
+
+    std::string name;
+    Inline inline_hint = Inline::DEFAULT;
+    bool memoize = false;//<< @memoize
+    bool exported = false;//<< @export, called from outside the module
+    u32 parameters = 0;
+    ast::Type::Kind return_type = ast::Type::VOID;
+    std::vector<BasicBlock> blocks;//<< blocks[0] is the entry, BlockId is the index in layout order
+    u32 values = 0;//<< SSA values are numbered [0, values)
+
+    inline ValueId new_value()
+    {
+        return values++;
+    }
+};
+
+struct Global {
+    std::string name;
+    u32 size;//<< dword elements, zero-initialized (.bss)
+    bool cache = false;//<< memoization table, what it holds never changes a result
+};
+
+struct Module {
+    std::string name;
+    std::vector<Function> functions;
+    std::vector<std::string> strings;//<< string literal pool, referenced by Operand::STRING
+    std::vector<Global> globals;//<< referenced by Operand::GLOBAL
+    u32 labels = 0;
+};
+// clang-format on
+
+static inline constexpr bool is_terminator(const Opcode opcode)
+{
+    return opcode == Opcode::BR || opcode == Opcode::JMP || opcode == Opcode::SWITCH || opcode == Opcode::RET;
+}
+
+static inline constexpr bool is_compare(const Opcode opcode)
+{
+    return opcode >= Opcode::ICMP_EQ && opcode <= Opcode::ICMP_SGE;
+}
+
+cstr to_string(const Opcode opcode);
+
+/**
+ * @brief fold
+ * @details result of an arithmetic or compare opcode on constants, with the 32-bit wrapping semantics of the backend
+ * (b is ignored by `neg`), nothing for a division that would trap or an opcode that is not arithmetic
+ */
+std::optional<i32> fold(const Opcode opcode, const i32 a, const i32 b);
+
+/**
+ * @brief successors
+ * @details distinct blocks the terminator of block may jump to, empty for ret or an unterminated block
+ */
+std::vector<BlockId> successors(const BasicBlock &block);
+
+/**
+ * @brief dump
+ * @details writes the textual form of the IR, only used by --show-ir. annotations, by FunctionId, are appended to the
+ * signature of each function, the optimizer gives the effect summaries of its call graph
+ */
+void dump(const Module &module, std::ostream &out, const std::vector<std::string> &annotations = {});
+
+}// namespace cplus::ir
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <CPlus/Codegen/IR.hpp>
 #include <CPlus/Compiler/Interface.hpp>
 #include <CPlus/Parser/Types.hpp>
 
@@ -11,37 +12,49 @@ namespace cplus::ir {
  * @brief IntermediateRepresentation
  * @details Converts AST + symbol table into IR
  * @input st::ASTScope (AST + symbol table)
- * @output std::string (IR as text)
+ * @output ir::Module (SSA functions made of basic blocks)
  */
-class IntermediateRepresentation : public CompilerPass<std::unique_ptr<ast::Module>, const std::string>, public ast::ASTVisitor
+class IntermediateRepresentation : public CompilerPass<std::unique_ptr<ast::Module>, Module>, public ast::ASTVisitor
 {
     public:
         IntermediateRepresentation() = default;
         ~IntermediateRepresentation() override = default;
 
-        const std::string run(const std::unique_ptr<cplus::ast::Module> &scope) override;
+        Module run(const std::unique_ptr<cplus::ast::Module> &scope) override;
+        cstr name() const override
+        {
+            return "ir";
+        }
 
     private:
-        std::vector<std::unordered_map<std::string, std::string>> _value_map_stack;
+        using ValueMap = std::unordered_map<std::string_view, Operand>;
 
-        std::string _output;
-        std::string _current_function;
-        std::string _last_value;
+        std::vector<ValueMap> _value_map_stack;
+        std::unordered_map<std::string_view, FunctionId> _function_ids;
 
-        u64 _temp_counter = 0;
-        u64 _label_counter = 0;
+        Module _module;
+        Function *_function = nullptr;
+        BlockId _block = 0;
+        std::vector<BlockId> _block_order;
+
+        Operand _last_value;
 
         void _pop();
         void _push();
-        void _push_copy();
 
-        void _emit(const std::string &s);
-        std::string _lookup(const std::string &name) const;
-        std::unordered_map<std::string, std::string> &_current_map();
-        void _set_name(const std::string &name, const std::string &ssa);
+        ValueId _emit(const Opcode opcode, std::vector<Operand> operands = {}, const bool has_result = true);
+        void _emit(Instruction instruction);
+        bool _is_terminated() const;
+
+        BlockId _new_block(cstr name);
+        void _set_block(const BlockId block);
+        void _layout_blocks();
+
+        Operand _lookup(const std::string_view &name) const;
+        void _declare(const std::string_view &name, const Operand &value);
+        void _assign(const std::string_view &name, const Operand &value);
 
-        std::string _new_temp(const std::string &hint);
-        std::string _new_label(const std::string &hint);
+        void _loop(ast::Expression *condition, ast::Statement *body, ast::Expression *increment);
 
         void visit(ast::LiteralExpression &node) override;
         void visit(ast::IdentifierExpression &node) override;
@@ -55,6 +68,7 @@ class IntermediateRepresentation : public CompilerPass<std::unique_ptr<ast::Modu
         void visit(ast::ReturnStatement &node) override;
         void visit(ast::IfStatement &node) override;
         void visit(ast::ForStatement &node) override;
+        void visit(ast::WhileStatement &node) override;
         void visit(ast::ForeachStatement &node) override;
         void visit(ast::CaseStatement &node) override;
         void visit(ast::FunctionDeclaration &node) override;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <CPlus/Types.hpp>
+
+#include <string>
+#include <vector>
+
+namespace cplus::elf {
+
+static constexpr u32 NO_SECTION = ~0u;
+
+// clang-format off
+struct Relocation {
+    u64 offset;//<< offset in the section holding the relocation
+    u32 symbol;//<< index in ObjectFile::symbols
+    u32 type;//<< R_X86_64_*
+    i64 addend;
+};
+
+struct Section {
+    enum Kind : u8 { TEXT, RODATA, DATA, BSS };
+
+    std::string name;
+    Kind kind = TEXT;
+    u64 alignment = 1;
+    std::vector<u8> data;//<< zero-filled for BSS, which is not stored in files
+    std::vector<Relocation> relocations;
+};
+
+struct Symbol {
+    enum Kind : u8 { NOTYPE, FUNCTION, OBJECT, SECTION };
+    enum Binding : u8 { LOCAL, GLOBAL, WEAK };
+
+    std::string name;
+    u32 section = NO_SECTION;//<< index in ObjectFile::sections, NO_SECTION when undefined
+    Kind kind = NOTYPE;
+    Binding binding = LOCAL;
+    u64 value = 0;//<< offset in its section
+    u64 size = 0;
+};
+
+struct ObjectFile {
+    std::string name;
+    std::vector<Section> sections;
+    std::vector<Symbol> symbols;
+};
+// clang-format on
+
+/**
+ * @brief write relocatable
+ * @details serializes an object as an ELF64 x86-64 relocatable (ET_REL) file image
+ */
+std::string write_relocatable(const ObjectFile &object);
+
+/**
+ * @brief read relocatable
+ * @details loads the allocated sections, symbols and RELA relocations of an ELF64 x86-64 relocatable file image,
+ * sections that never reach memory (debug info, comments, notes) are dropped
+ */
+ObjectFile read_relocatable(const std::string &image, const std::string &name);
+
+}// namespace cplus::elf
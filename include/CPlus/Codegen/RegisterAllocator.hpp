@@ -0,0 +1,83 @@
+#pragma once
+
+#include <CPlus/Analysis/Liveness.hpp>
+#include <CPlus/Codegen/IR.hpp>
+#include <CPlus/Codegen/x86-64Registers.hpp>
+
+namespace cplus::x86_64 {
+
+// clang-format off
+struct Location {
+    Register reg = NO_REGISTER;
+    u32 slot = 0;//<< spill slot index when reg is NO_REGISTER
+
+    constexpr bool is_register() const { return reg != NO_REGISTER; }
+};
+// clang-format on
+
+/**
+ * @brief RegisterAllocator
+ * @details linear scan (Poletto & Sarkar) over live intervals computed from ir::Liveness
+ *
+ * eax, ecx and edx are kept as scratch registers for the code generator (results, idiv, shifts, table indexes).
+ * intervals live across a call only get callee-saved registers, the others share r10d/r11d with the argument
+ * registers left: edi, esi, r8d and r9d. the arguments of a call are set by one parallel copy, so a value may sit in
+ * any of them until the call reads it. an argument register is only handed out once the ARG reading the incoming
+ * value is done with it, and an interval prefers the register its value arrives in, or the one it is passed in.
+ *
+ * phis are resolved by copies on their incoming edges: before the scan, a phi and its operands are coalesced into one
+ * class sharing a location whenever none of their values is live where another one is defined, so that their copy
+ * disappears. a class gets a single interval, and a phi result is live at the end of each incoming block (its copy).
+ *
+ * without `allocate` (-O0) nothing is computed: every value gets its own stack slot.
+ */
+class RegisterAllocator
+{
+    public:
+        explicit RegisterAllocator(const ir::Function &function, const bool allocate = true);
+
+        inline const Location &location(const ir::ValueId value) const
+        {
+            return _locations[value];
+        }
+
+        /** @brief number of dword spill slots the frame needs */
+        inline u32 spill_slots() const
+        {
+            return _spill_slots;
+        }
+
+        /** @brief callee-saved registers the function must preserve, in allocation order */
+        inline const std::vector<Register> &callee_saved() const
+        {
+            return _callee_saved;
+        }
+
+    private:
+        // clang-format off
+        struct Interval {
+            ir::ValueId value;
+            u32 start;
+            u32 end;
+            bool crosses_call;
+            Register hint;//<< argument register the value arrives or leaves in, NO_REGISTER without one
+        };
+        // clang-format on
+
+        static constexpr u64 COALESCE_MAX_PAIRS = 1024;//<< interference checks allowed for one merge of two classes
+
+        std::vector<Location> _locations;
+        std::vector<Register> _callee_saved;
+        std::vector<ir::ValueId> _classes;//<< union-find over values, the root holds the location of its class
+        std::vector<std::pair<u32, Register>> _arguments;//<< incoming argument registers, with the position they are read at
+        u32 _spill_slots = 0;
+
+        void _coalesce(const ir::Function &function, const ir::Liveness &liveness);
+        ir::ValueId _find(const ir::ValueId value);
+
+        std::vector<Interval> _build_intervals(const ir::Function &function, const ir::Liveness &liveness);
+        void _linear_scan(std::vector<Interval> &intervals);
+        void _spill(const ir::ValueId value);
+};
+
+}// namespace cplus::x86_64
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <CPlus/Codegen/ObjectFile.hpp>
+#include <CPlus/Codegen/x86-64Instruction.hpp>
+#include <CPlus/Compiler/Interface.hpp>
+
+namespace cplus::x86_64 {
+
+/**
+ * @brief Assembler
+ * @details encodes a machine module into x86-64 machine code, replacing the round trip through `as`
+ *
+ * local jumps are resolved in place and start short (rel8), any jump whose displacement does not fit is
+ * widened to rel32 and the function is encoded again until the layout is stable,
+ * calls, string addresses, jump table entries and globals are left as relocations for the linker.
+ *
+ * every function gets its own `.text.<function>` section, and `.rodata.<function>` for its jump tables, so the
+ * linker can drop the functions nothing calls. strings and globals are shared by the module in .rodata and .bss.
+ */
+class Assembler : public CompilerPass<MachineModule, elf::ObjectFile>
+{
+    public:
+        Assembler() = default;
+        ~Assembler() override = default;
+
+        elf::ObjectFile run(const MachineModule &module) override;
+        cstr name() const override
+        {
+            return "assembler";
+        }
+
+    private:
+        // clang-format off
+        struct Fixup {
+            u64 at;//<< offset of the displacement in the section of the function
+            u32 label;
+            u64 instruction;
+            bool wide;
+        };
+        // clang-format on
+
+        const MachineModule *_module = nullptr;
+        elf::ObjectFile _object;
+        std::vector<u32> _symbol_index;//<< MachineModule::symbols -> ObjectFile::symbols
+        u32 _rodata_symbol = 0;
+        u32 _bss_symbol = 0;
+        std::vector<u64> _string_offsets;
+        std::vector<u64> _table_offsets;//<< in the .rodata section of their function
+        std::vector<u32> _table_symbols;//<< section symbol of the .rodata section of their function
+        std::vector<u64> _global_offsets;
+
+        std::vector<u64> _labels;
+        std::vector<Fixup> _fixups;
+        std::vector<bool> _wide;//<< per instruction, jumps needing a rel32
+        u32 _text = 0;//<< section of the function being encoded
+
+        void _emit_rodata();
+        void _emit_bss();
+        void _declare_symbols();
+        void _emit_tables(const u32 function);
+        void _relocate_tables(const u32 function);
+
+        void _encode_function(const MachineFunction &function);
+        void _encode(const MachineInstruction &instruction, const u64 index);
+
+        void _encode_alu(const MachineInstruction &instruction, const u8 rm_r, const u8 r_rm, const u8 digit);
+        void _encode_mov(const MachineInstruction &instruction);
+        void _encode_imul(const MachineInstruction &instruction);
+        void _encode_jump(const MachineInstruction &instruction, const u64 index);
+
+        void _byte(const u8 byte);
+        void _dword(const u32 dword);
+        void _relocate(const u32 symbol, const u32 type, const i64 addend);
+        void _rex(const bool wide, const u8 reg, const MachineOperand &rm);
+        void _modrm(const u8 reg, const MachineOperand &rm);
+        void _immediate32(const MachineOperand &operand);
+};
+
+}// namespace cplus::x86_64
@@ -1,62 +1,145 @@
 #pragma once
 
+#include <CPlus/Arguments.hpp>
+#include <CPlus/Codegen/IR.hpp>
+#include <CPlus/Codegen/RegisterAllocator.hpp>
+#include <CPlus/Codegen/x86-64Instruction.hpp>
 #include <CPlus/Compiler/Interface.hpp>
 #include <CPlus/Types.hpp>
 
-#include <unordered_map>
+#include <optional>
 
 namespace cplus {
 
 namespace x86_64 {
 
-class Codegen : public CompilerPass<const std::string, const std::string>
+/**
+ * @brief Codegen
+ * @details selects x86-64 machine instructions for an IR module, see x86_64::print for the text form
+ * and x86_64::Assembler for the machine code
+ *
+ * instructions are selected one by one, except for the pairs matched by _is_folded: a compare fused with its branch,
+ * a scaled index folded into an addition, a call whose result is returned at once becomes a jump (tail call).
+ * the address unit computes three-operand additions and small products.
+ * -O0 skips the register allocation, -O2 and -O3 align functions on a fetch block, -Os only lowers a switch to a jump
+ * table where it is smaller than its compares
+ */
+class Codegen : public CompilerPass<ir::Module, MachineModule>
 {
     public:
-        Codegen() = default;
+        explicit Codegen(const OptLevel level = OPT_O2);
         ~Codegen() override = default;
 
-        const std::string run(const std::string &ir) override;
+        MachineModule run(const ir::Module &module) override;
+        cstr name() const override
+        {
+            return "codegen";
+        }
 
     private:
+        // clang-format off
+        struct SwitchCase {
+            i64 value;
+            ir::BlockId block;
+        };
+
+        struct SwitchCluster {
+            enum Kind : u8 { SINGLE, TABLE, BITS };
+
+            Kind kind;
+            u64 first;//<< cases [first, last) of the sorted case list
+            u64 last;
+        };
+
+        struct Copy {
+            MachineOperand dst;
+            MachineOperand src;
+        };
+        // clang-format on
+
+        static constexpr u32 FUNCTION_ALIGNMENT = 16;//<< -O2 and -O3, the instruction fetch block
+        static constexpr u64 JUMP_TABLE_MIN_CASES = 4;
+        static constexpr u64 JUMP_TABLE_MIN_DENSITY = 40;//<< percentage of the range the cases must cover
+        static constexpr u64 JUMP_TABLE_MIN_DENSITY_SIZE = 75;//<< -Os: 8 bytes per entry against ~11 per compare and branch
+        static constexpr u64 JUMP_TABLE_MAX_RANGE = 1024;
+        static constexpr u64 BIT_TEST_MIN_CASES = 3;
+        static constexpr u64 BIT_TEST_MAX_DESTINATIONS = 3;//<< one mask and `bt` per destination
+        static constexpr u64 BIT_TEST_MAX_RANGE = 32;//<< masks are dword immediates
+        static constexpr u64 SWITCH_LINEAR_CLUSTERS = 3;//<< compare tree leaves test up to this many clusters in a row
+
+        OptLevel _level;
         u64 _stack_offset = 0;
-        i32 _next_stack_offset = -4;
-        u8 _register_index = 0;
+        u32 _local_labels = 0;
 
-        std::unordered_map<std::string, std::string> _var_locations;
+        std::optional<RegisterAllocator> _allocator;
+        std::vector<MachineOperand> _var_locations;//<< register or stack slot of each SSA value
 
-        std::string _current_function;
-        std::string _output;
-        std::string _ir;
+        const ir::Module *_module = nullptr;
+        const ir::Function *_function = nullptr;
+        std::vector<u32> _uses;//<< per value, number of operands reading it
+        u64 _block_index = 0;
+        u64 _instruction_index = 0;
+        std::vector<std::pair<ir::BlockId, MachineOperand>> _edge_stubs;//<< successors of the current block entered through copies
 
-        void _emit(const std::string &s);
+        MachineModule _output;
+        MachineFunction *_machine = nullptr;
 
-        void _prologue();
-        void _generate();
-        void _epilogue();
+        void _emit(const Mnemonic mnemonic, const MachineOperand &dst = {}, const MachineOperand &src = {});
+        void _emit(const Condition condition, const Mnemonic mnemonic, const MachineOperand &dst);
 
-        void _generate_line(const std::string &line);
+        void _generate();
 
-        void _emit_function_declaration(const std::string &line);
+        void _emit_function(const ir::Function &function);
         void _emit_function_start();
         void _emit_function_end();
 
-        void _emit_call_instruction(const std::string &line);
-        void _emit_label(const std::string &line);
-        void _emit_function_call(const std::string &line);
-        void _emit_assignement(const std::string &line);
-        void _emit_mov(const std::string &dest, const std::string &src);
-        void _emit_branch(const std::string &label);
-        void _emit_return(const std::string &value);
-        void _emit_phi(const std::string &dest, const std::string &rhs);
-        void _emit_call_result(const std::string &dest);
-        void _emit_arg_load(const std::string &dest, const std::string &rhs);
-        void _emit_binary_op(const std::string &dest, const std::string &src1, const std::string &op);
-        void _emit_unary_op(const std::string &dest, const std::string &src1, const std::string &op);
-        void _emit_div(const std::string &dest, const std::string &src1, const bool is_mod = false);
-        void _emit_compare(const std::string &src1, const std::string &src2);
-
-        const std::string _get_stack_location(const std::string &var);
-        const std::string _get_operand(const std::string &operand);
+        void _emit_instruction(const ir::Instruction &instruction);
+
+        void _emit_label(const ir::BlockId block);
+        void _emit_call_instruction(const ir::Instruction &instruction);
+        void _emit_mov(const ir::ValueId dest, const ir::Operand &src);
+        void _emit_load(const ir::Instruction &instruction);
+        void _emit_store(const ir::Instruction &instruction);
+        void _emit_branch(const ir::Instruction &instruction);
+        void _emit_jump(const ir::BlockId block);
+        void _emit_switch(const ir::Instruction &instruction);
+        void _emit_switch_tree(const std::vector<SwitchCase> &cases, const std::vector<SwitchCluster> &clusters, const u64 first,
+            const u64 last, const ir::BlockId fallback, const bool tail);
+        bool _emit_switch_cluster(const std::vector<SwitchCase> &cases, const SwitchCluster &cluster, const ir::BlockId fallback,
+            const bool last);
+        void _emit_return(const ir::Instruction &instruction);
+        void _emit_tail_call(const ir::Instruction &call);
+        void _emit_phi(const ir::Instruction &instruction);
+        void _prepare_edges();
+        void _emit_edge_jump(const ir::BlockId block);
+        void _emit_edge_stubs();
+        void _emit_parallel_copy(std::vector<Copy> copies);
+        void _emit_arg_load(const ir::Instruction &instruction);
+        void _emit_binary_op(const ir::Instruction &instruction, const Mnemonic op);
+        void _emit_unary_op(const ir::Instruction &instruction, const Mnemonic op);
+        void _emit_div(const ir::Instruction &instruction, const bool is_mod = false);
+        void _emit_compare(const ir::Instruction &instruction);
+        Condition _emit_flags(const ir::Instruction &compare);
+        bool _emit_address_arithmetic(const ir::Instruction &instruction);
+        bool _emit_scale(const MachineOperand &dst, const MachineOperand &src, const i64 factor);
+
+        bool _is_folded(const ir::BasicBlock &block, const u64 index) const;
+        bool _is_tail_call(const ir::Instruction &call, const ir::Instruction &ret) const;
+        std::optional<MachineOperand> _get_scaled_address(const ir::Instruction &add, const ir::Instruction &mul) const;
+
+        void _emit_restore_callee_saved();
+
+        static std::vector<SwitchCluster> _cluster_cases(const std::vector<SwitchCase> &cases, const u64 min_density);
+
+        const MachineOperand &_get_location(const ir::ValueId value) const;
+        MachineOperand _get_operand(const ir::Operand &operand) const;
+        MachineOperand _get_label(const ir::BlockId block) const;
+        MachineOperand _get_edge_label(const ir::BlockId block) const;
+        MachineOperand _new_label(const std::string &name);
+        std::vector<Copy> _get_edge_copies(const ir::BlockId from, const ir::BlockId to) const;
+        std::vector<Copy> _get_argument_copies(const std::vector<ir::Operand> &arguments) const;
+        MachineOperand _get_symbol(const std::string &name);
+        MachineOperand _get_global(const ir::Operand &global, const ir::Operand &index);
 };
 
 }// namespace x86_64
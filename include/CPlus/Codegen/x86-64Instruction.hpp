@@ -0,0 +1,144 @@
+#pragma once
+
+#include <CPlus/Codegen/x86-64Registers.hpp>
+
+#include <string>
+#include <vector>
+
+namespace cplus::x86_64 {
+
+/**
+ * @brief Mnemonic
+ * @details every machine instruction the code generator selects, LABEL is a pseudo instruction marking a block
+ */
+enum class Mnemonic : u8 {
+    MOV,
+    MOVZX,
+    LEA,
+    ADD,
+    SUB,
+    IMUL,
+    AND,
+    OR,
+    SHL,
+    CMP,
+    TEST,
+    NEG,
+    CDQ,
+    IDIV,
+    SETCC,
+    BT,
+    JMP,
+    JCC,
+    CALL,
+    PUSH,
+    LEAVE,
+    RET,
+    SYSCALL,
+    LABEL,
+};
+
+/**
+ * @brief Condition
+ * @details condition codes of setcc/jcc, valued like their hardware encoding
+ */
+enum class Condition : u8 {
+    B = 0x2,
+    AE = 0x3,
+    E = 0x4,
+    NE = 0x5,
+    BE = 0x6,
+    A = 0x7,
+    L = 0xC,
+    GE = 0xD,
+    LE = 0xE,
+    G = 0xF,
+};
+
+// clang-format off
+struct MachineOperand {
+    enum Kind : u8 { NONE, REGISTER, IMMEDIATE, MEMORY, LABEL, SYMBOL, STRING, TABLE, GLOBAL };
+
+    Kind kind = NONE;
+    Register reg = NO_REGISTER;//<< register, or base register of a memory operand
+    u8 size = 4;//<< access size in bytes: 1, 4 or 8
+    i64 value = 0;//<< immediate, displacement, or index of the label/symbol/string/jump table/global
+    Register index_reg = NO_REGISTER;//<< scaled index register of a memory operand
+    u8 scale = 1;//<< 1, 2, 4 or 8
+
+    static constexpr MachineOperand r(const Register reg, const u8 size = 4) { return {REGISTER, reg, size, 0}; }
+    static constexpr MachineOperand imm(const i64 value) { return {IMMEDIATE, NO_REGISTER, 4, value}; }
+    static constexpr MachineOperand mem(const Register base, const i64 disp, const u8 size = 4) { return {MEMORY, base, size, disp}; }
+
+    /** @brief dword [base + index * scale + disp] */
+    static constexpr MachineOperand mem(const Register base, const Register index, const u8 scale, const i64 disp)
+    {
+        return {MEMORY, base, 4, disp, index, scale};
+    }
+
+    static constexpr MachineOperand label(const u32 index) { return {LABEL, NO_REGISTER, 4, index}; }
+    static constexpr MachineOperand symbol(const u32 index) { return {SYMBOL, NO_REGISTER, 4, index}; }
+    static constexpr MachineOperand string(const u32 index) { return {STRING, NO_REGISTER, 4, index}; }
+
+    /** @brief qword [table + reg * 8], an entry of a jump table */
+    static constexpr MachineOperand table(const u32 index, const Register reg)
+    {
+        return {TABLE, reg, 8, index};
+    }
+
+    /** @brief dword [global + reg * 4], an element of a global */
+    static constexpr MachineOperand global(const u32 index, const Register reg)
+    {
+        return {GLOBAL, NO_REGISTER, 4, index, reg, 4};
+    }
+
+    constexpr bool is_register() const { return kind == REGISTER; }
+    constexpr bool is_memory() const { return kind == MEMORY; }
+    constexpr bool is_global() const { return kind == GLOBAL; }
+    constexpr bool is_immediate() const { return kind == IMMEDIATE || kind == STRING; }
+    constexpr u32 index() const { return static_cast<u32>(value); }
+
+    constexpr bool operator==(const MachineOperand &other) const = default;
+};
+
+struct MachineInstruction {
+    Mnemonic mnemonic;
+    Condition condition = Condition::E;//<< SETCC and JCC only
+    MachineOperand dst = {};
+    MachineOperand src = {};
+};
+
+struct MachineFunction {
+    std::string name;
+    std::vector<std::string> labels;//<< local labels, indexed by MachineOperand::label
+    std::vector<MachineInstruction> instructions;
+};
+
+struct JumpTable {
+    u32 function;//<< index in MachineModule::functions
+    std::vector<u32> labels;//<< one entry per value of the dense range, labels of that function
+};
+
+struct Global {
+    std::string name;
+    u64 size;//<< bytes, zero-initialized in .bss
+};
+
+struct MachineModule {
+    std::string name;
+    std::vector<MachineFunction> functions;
+    std::vector<JumpTable> jump_tables;//<< indexed by MachineOperand::table, emitted in .rodata
+    std::vector<std::string> strings;//<< indexed by MachineOperand::string
+    std::vector<std::string> symbols;//<< call targets, indexed by MachineOperand::symbol
+    std::vector<Global> globals;//<< indexed by MachineOperand::global, emitted in .bss
+    u32 function_alignment = 1;//<< boundary of every function entry, padded with int3
+};
+// clang-format on
+
+/**
+ * @brief print
+ * @details renders a machine module as Intel syntax GNU assembly
+ */
+std::string print(const MachineModule &module);
+
+}// namespace cplus::x86_64
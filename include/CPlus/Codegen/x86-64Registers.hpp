@@ -0,0 +1,66 @@
+#pragma once
+
+#include <CPlus/Types.hpp>
+
+namespace cplus::x86_64 {
+
+/**
+ * @brief Register
+ * @details general-purpose registers, numbered like their hardware encoding
+ */
+enum Register : u8 {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+    NO_REGISTER,
+};
+
+/** @brief System V integer argument registers, in order */
+static constexpr Register ARGUMENT_REGISTERS[6] = {RDI, RSI, RDX, RCX, R8, R9};
+
+/** @brief System V callee-saved registers (rbp excluded, it holds the frame) */
+static constexpr Register CALLEE_SAVED_REGISTERS[5] = {RBX, R12, R13, R14, R15};
+
+static inline constexpr bool is_callee_saved(const Register reg)
+{
+    return reg == RBX || reg == RBP || reg == RSP || (reg >= R12 && reg <= R15);
+}
+
+static inline constexpr cstr to_string8(const Register reg)
+{
+    constexpr cstr names[] = {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b",
+        "r15b", "none"};
+
+    return names[reg];
+}
+
+static inline constexpr cstr to_string32(const Register reg)
+{
+    constexpr cstr names[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d",
+        "r15d", "none"};
+
+    return names[reg];
+}
+
+static inline constexpr cstr to_string64(const Register reg)
+{
+    constexpr cstr names[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+        "none"};
+
+    return names[reg];
+}
+
+}// namespace cplus::x86_64
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <CPlus/Compiler/Interface.hpp>
+#include <CPlus/Types.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+
+namespace cplus {
+
+/**
+ * @brief CompileCache
+ * @details on-disk cache of compiled objects, content-addressed by a 128-bit hash of the source,
+ * the flags changing the output and the identity of the compiler binary
+ *
+ * entries are written to a temporary file then renamed so concurrent compilers never read a partial entry,
+ * a hit refreshes the entry's modification time. hit/miss counters and the bytes written are kept for the run and
+ * accumulated on disk by report(), which evicts the least recently used entries once the recorded size grows over the
+ * limit: the cache directory is only walked when it may actually be full.
+ */
+class CompileCache
+{
+    public:
+        // clang-format off
+        struct Entry {
+            std::string object;//<< ELF relocatable image
+            std::string assembly;//<< only when FLAG_EMIT_ASM is part of the key
+        };
+        // clang-format on
+
+        CompileCache(std::filesystem::path directory, const u64 max_size);
+        ~CompileCache() = default;
+
+        CompileCache(const CompileCache &) = delete;
+        CompileCache &operator=(const CompileCache &) = delete;
+
+        std::string key(const FileContent &source) const;
+
+        std::optional<Entry> load(const std::string &key);
+        void store(const std::string &key, const Entry &entry);
+
+        void report();
+
+        static std::optional<std::filesystem::path> default_directory();
+
+    private:
+        std::filesystem::path _directory;
+        u64 _max_size;
+
+        std::atomic<u64> _hits = 0;
+        std::atomic<u64> _misses = 0;
+        std::atomic<u64> _written = 0;//<< bytes stored this run
+
+        std::filesystem::path _path(const std::string &key, const char *extension) const;
+        u64 _trim();
+};
+
+}// namespace cplus
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <CPlus/Analysis/SymbolTable.hpp>
+#include <CPlus/Arguments.hpp>
 #include <CPlus/Codegen/IntermediateRepresentation.hpp>
+#include <CPlus/Codegen/x86-64Assembler.hpp>
 #include <CPlus/Codegen/x86-64Codegen.hpp>
+#include <CPlus/Compiler/Cache.hpp>
 #include <CPlus/Compiler/Pipeline.hpp>
+#include <CPlus/Optimization/Optimizer.hpp>
 #include <CPlus/Parser/AbstractSyntaxTree.hpp>
 #include <CPlus/Parser/LexicalAnalyzer.hpp>
 
@@ -12,13 +16,33 @@ namespace cplus {
 class CompilerDriver
 {
     public:
-        CompilerDriver();
+        CompilerDriver(CompileCache *cache = nullptr);
 
-        void compile(const FileContent &source);
+        elf::ObjectFile compile(const FileContent &source);
+        const PassTimer &timings() const;
+
+        static void link(std::vector<elf::ObjectFile> objects);
 
     private:
-        CompilerPipeline<lx::LexicalAnalyzer, ast::AbstractSyntaxTree, st::SymbolTable, ir::IntermediateRepresentation, x86_64::Codegen>
+        CompilerPipeline<lx::LexicalAnalyzer, ast::AbstractSyntaxTree, st::SymbolTable, ir::IntermediateRepresentation, opt::Optimizer,
+            x86_64::Codegen>
             _pipeline;
+        x86_64::Assembler _assembler;
+        CompileCache *_cache;//<< shared between drivers, nullptr when disabled
+        PassTimer _timer;
+
+        /** @brief steps outside of the pipeline are timed the same way as its passes */
+        template<typename Function>
+        auto _timed(cstr pass, Function &&function)
+        {
+            if (!(cplus_flags & FLAG_TIME_PASSES)) {
+                return function();
+            }
+
+            const PassTimer::Scope scope(_timer, pass);
+
+            return function();
+        }
 };
 
 }// namespace cplus
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <CPlus/Types.hpp>
+
 #include <string>
 
 namespace cplus {
@@ -17,6 +19,9 @@ class CompilerPass
     public:
         virtual ~CompilerPass() = default;
         virtual Output run(const Input &input) = 0;
+
+        /** @brief display name, used by --time-passes */
+        virtual cstr name() const = 0;
 };
 
 }// namespace cplus
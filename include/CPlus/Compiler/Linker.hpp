@@ -0,0 +1,61 @@
+#pragma once
+
+#include <CPlus/Codegen/ObjectFile.hpp>
+
+#include <unordered_map>
+
+namespace cplus {
+
+/**
+ * @brief Linker
+ * @details static linker for x86-64 relocatable objects, in memory or loaded from disk
+ *
+ * sections are merged by kind into three PT_LOAD segments (text with the headers, rodata, data + bss)
+ * mapped at 0x400000, global symbols are resolved across every object (a strong definition overrides a weak one),
+ * and a `_start` stub calling `main` and exiting with its result is synthesized unless an object provides one.
+ *
+ * only the sections reachable from `_start` through relocations are laid out: with one section per function, the
+ * functions nothing calls are left out of the executable.
+ */
+class Linker
+{
+    public:
+        Linker() = default;
+        ~Linker() = default;
+
+        void add(elf::ObjectFile object);
+        void link(const std::string &output);
+
+    private:
+        // clang-format off
+        struct Definition {
+            u32 object;
+            u32 symbol;
+        };
+
+        struct Segment {
+            u64 offset;//<< file offset, also the offset from the image base
+            u64 file_size;
+            u64 memory_size;
+            u32 flags;//<< PF_*
+        };
+        // clang-format on
+
+        std::vector<elf::ObjectFile> _objects;
+        std::unordered_map<std::string, Definition> _globals;
+        std::vector<std::vector<u64>> _addresses;//<< per object, per section
+        std::vector<std::vector<bool>> _live;//<< per object, per section
+        std::vector<Segment> _segments;
+        std::string _image;
+
+        void _add_start_stub();
+        void _resolve_symbols();
+        void _collect_sections();
+        void _layout();
+        void _relocate();
+        void _write(const std::string &output);
+
+        u64 _symbol_address(const u32 object, const u32 symbol) const;
+};
+
+}// namespace cplus
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <CPlus/Types.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace cplus {
+
+// clang-format off
+struct PassTiming {
+    std::string pass;
+    f64 wall;//<< milliseconds
+    f64 cpu;//<< milliseconds of the thread running the pass
+};
+// clang-format on
+
+/**
+ * @brief PassTimer
+ * @details wall and CPU time of every pass run for one file
+ *
+ * CPU time is read from the calling thread's clock (CLOCK_THREAD_CPUTIME_ID), so files compiled in parallel (-j)
+ * never account each other's work, a pass run twice is accumulated under the same row.
+ */
+class PassTimer
+{
+    public:
+        /**
+        * @brief Scope
+        * @details measures from construction to destruction, so a pass that throws is still accounted
+        */
+        class Scope
+        {
+            public:
+                Scope(PassTimer &timer, cstr pass);
+                ~Scope();
+
+                Scope(const Scope &) = delete;
+                Scope &operator=(const Scope &) = delete;
+
+            private:
+                PassTimer &_timer;
+                cstr _pass;
+                std::chrono::steady_clock::time_point _wall;
+                f64 _cpu;
+        };
+
+        PassTimer() = default;
+        ~PassTimer() = default;
+
+        void add(const std::string &pass, const f64 wall, const f64 cpu);
+
+        const std::vector<PassTiming> &timings() const;
+        std::string table(const std::string &title) const;
+
+    private:
+        std::vector<PassTiming> _timings;
+};
+
+/**
+ * @brief TimeReport
+ * @details gathers the PassTimer of every file of the invocation (plus the passes that are not tied to a file,
+ * like linking) into an aggregate table and a JSON document
+ */
+class TimeReport
+{
+    public:
+        TimeReport() = default;
+        ~TimeReport() = default;
+
+        void add(const std::string &file, const PassTimer &timer);
+        PassTimer &global();
+
+        std::string table() const;
+        std::string json() const;
+
+    private:
+        // clang-format off
+        struct File {
+            std::string file;
+            std::vector<PassTiming> timings;
+        };
+        // clang-format on
+
+        std::vector<File> _files;
+        PassTimer _global;
+
+        PassTimer _aggregate() const;
+};
+
+}// namespace cplus
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <CPlus/Compiler/PassTimer.hpp>
+
 #include <memory>
 #include <tuple>
+#include <utility>
 
 namespace cplus {
 
@@ -23,24 +26,46 @@ class CompilerPipeline
             return execute_impl(input, std::index_sequence_for<Passes...>{});
         }
 
+        /** @brief every following pass is timed into `timer`, nullptr disables timing */
+        void time(PassTimer *timer)
+        {
+            _timer = timer;
+        }
+
     private:
         std::tuple<std::unique_ptr<Passes>...> _passes;
+        PassTimer *_timer = nullptr;
+
+        /** @brief runs a single pass, under a timer scope with --time-passes, intermediates are moved into it */
+        template<size_t I, typename Input>
+        auto run_pass(Input &&input)
+        {
+            const auto &pass = std::get<I>(_passes);
+
+            if (!_timer) {
+                return pass->run(std::forward<Input>(input));
+            }
+
+            const PassTimer::Scope scope(*_timer, pass->name());
+
+            return pass->run(std::forward<Input>(input));
+        }
 
         /** @brief single pass */
         template<typename Input>
         auto execute_single_pass(const Input &input, std::index_sequence<0>)
         {
-            return std::get<0>(_passes)->run(input);
+            return run_pass<0>(input);
         }
 
         /** @brief multiple passes */
         template<typename Input, size_t First, size_t... Rest>
-        auto execute_impl_recursive(const Input &input, std::index_sequence<First, Rest...>)
+        auto execute_impl_recursive(Input &&input, std::index_sequence<First, Rest...>)
         {
-            auto intermediate = std::get<First>(_passes)->run(input);
+            auto intermediate = run_pass<First>(std::forward<Input>(input));
 
             if constexpr (sizeof...(Rest) == 0) {
-                return std::move(intermediate);
+                return intermediate;
             } else {
                 return execute_impl_recursive(std::move(intermediate), std::index_sequence<Rest...>{});
             }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <CPlus/Types.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cplus {
+
+/**
+ * @brief WorkerPool
+ * @details fixed-size pool of threads consuming a FIFO of tasks
+ * @note tasks must not throw, callers capture their own exceptions (see cplus_compiler_routine)
+ */
+class WorkerPool
+{
+    public:
+        explicit WorkerPool(const u32 workers);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void submit(std::function<void()> task);
+        void wait();
+
+    private:
+        std::vector<std::thread> _workers;
+        std::queue<std::function<void()>> _tasks;
+
+        std::mutex _mutex;
+        std::condition_variable _task_available;
+        std::condition_variable _tasks_done;
+
+        u64 _pending = 0;
+        bool _stop = false;
+
+        void _loop();
+};
+
+}// namespace cplus
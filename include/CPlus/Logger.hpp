@@ -19,6 +19,13 @@ constexpr const char *CPLUS_BOLD = "\033[1m";
 constexpr const char *CPLUS_RED = "\033[31m";
 constexpr const char *CPLUS_CYAN = "\033[36m";
 
+/**
+ * @brief logger::sink
+ * @details per-thread output stream used by info/debug, worker threads point it to a per-file buffer
+ * so that logs of parallel compilations are flushed in input order
+ */
+inline thread_local std::ostream *sink = &std::cout;
+
 /**
  * @brief logger::error
  * @details takes an exception::Error and display clearly what is the Error, where was it raised and why
@@ -40,7 +47,7 @@ static constexpr inline void debug([[maybe_unused]] Args &&...args)
 #ifdef CPLUS_DEBUG
     std::ostringstream oss;
     const i32 __attribute__((unused)) _[] = {0, (oss << args, 0)...};
-    std::cout << CPLUS_MAGENTA << "[DEBUG] " << CPLUS_RESET << CPLUS_ITALIC << oss.str() << CPLUS_RESET << std::endl;
+    *sink << CPLUS_MAGENTA << "[DEBUG] " << CPLUS_RESET << CPLUS_ITALIC << oss.str() << CPLUS_RESET << std::endl;
 #endif
 }
 
@@ -49,7 +56,7 @@ static constexpr inline void info(Args &&...args)
 {
     std::ostringstream oss;
     const i32 __attribute__((unused)) _[] = {0, (oss << args, 0)...};
-    std::cout << CPLUS_YELLOW << "[INFO] " << CPLUS_RESET << oss.str() << std::endl;
+    *sink << CPLUS_YELLOW << "[INFO] " << CPLUS_RESET << oss.str() << std::endl;
 }
 
 }// namespace logger
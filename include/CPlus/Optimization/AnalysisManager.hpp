@@ -0,0 +1,79 @@
+#pragma once
+
+#include <CPlus/Analysis/CallGraph.hpp>
+#include <CPlus/Analysis/Liveness.hpp>
+#include <CPlus/Analysis/Loops.hpp>
+
+#include <memory>
+
+namespace cplus::opt {
+
+/**
+ * @brief analyses
+ * @details bits of the analyses a transformation leaves valid, see PassResult::preserved
+ */
+enum Analyses : u32 {
+    ANALYSIS_NONE = 0,
+    ANALYSIS_CFG = 1 << 0,
+    ANALYSIS_DOMINATORS = 1 << 1,
+    ANALYSIS_DOMINANCE_FRONTIER = 1 << 2,
+    ANALYSIS_LOOPS = 1 << 3,
+    ANALYSIS_LIVENESS = 1 << 4,
+    ANALYSIS_CALL_GRAPH = 1 << 5,
+    ANALYSIS_CONTROL_FLOW = ANALYSIS_CFG | ANALYSIS_DOMINATORS | ANALYSIS_DOMINANCE_FRONTIER | ANALYSIS_LOOPS,
+    ANALYSIS_ALL = (1 << 6) - 1,
+};
+
+/**
+ * @brief AnalysisManager
+ * @details computes the analyses of a module on first request and keeps them until a pass invalidates them
+ *
+ * function analyses are cached per function, the call graph for the whole module. an analysis built on another one
+ * is dropped with it: a CFG change invalidates the dominators, the dominance frontier, the loops and the liveness
+ * of the function whatever the pass claims to preserve. references stay valid until the analysis is invalidated.
+ */
+class AnalysisManager
+{
+    public:
+        explicit AnalysisManager(const ir::Module &module);
+        ~AnalysisManager() = default;
+
+        const ir::ControlFlowGraph &cfg(const ir::FunctionId function);
+        const ir::DominatorTree &dominators(const ir::FunctionId function);
+        const ir::DominanceFrontier &dominance_frontier(const ir::FunctionId function);
+        const ir::LoopInfo &loops(const ir::FunctionId function);
+        const ir::Liveness &liveness(const ir::FunctionId function);
+        const ir::CallGraph &call_graph();
+
+        /** @brief after a change to one function, `preserved` is a mask of Analyses */
+        void invalidate(const ir::FunctionId function, u32 preserved);
+
+        /** @brief after a change to the whole module, functions added to it start with an empty cache */
+        void invalidate(const u32 preserved);
+
+        /** @brief number of analyses built so far, a cache hit builds nothing */
+        inline u64 computed() const
+        {
+            return _computed;
+        }
+
+    private:
+        // clang-format off
+        struct FunctionAnalyses {
+            std::unique_ptr<ir::ControlFlowGraph> cfg;
+            std::unique_ptr<ir::DominatorTree> dominators;
+            std::unique_ptr<ir::DominanceFrontier> dominance_frontier;
+            std::unique_ptr<ir::LoopInfo> loops;
+            std::unique_ptr<ir::Liveness> liveness;
+        };
+        // clang-format on
+
+        const ir::Module &_module;
+        std::vector<FunctionAnalyses> _functions;
+        std::unique_ptr<ir::CallGraph> _call_graph;
+        u64 _computed = 0;
+
+        FunctionAnalyses &_get(const ir::FunctionId function);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+namespace cplus::opt {
+
+/**
+ * @brief ConstantEvaluation
+ * @details interprets at compile time the calls to pure functions whose arguments are all immediates, and replaces
+ * their result by the value returned, so `fibonacci(10)` costs nothing at runtime
+ *
+ * the interpreter runs the IR of the callee with the 32-bit semantics of the backend, nested calls included.
+ * a call site is given up, and kept as a call, when its evaluation exceeds MAX_DEPTH nested calls or reaches a
+ * division that would trap: the program then behaves at runtime exactly as it would have. all the call sites of a run
+ * share MAX_STEPS interpreted instructions, so the compile time stays bounded whatever the module. a callee running
+ * out of them is given up for good: its other call sites, in this run and in the runs sharing the same set, are
+ * left as calls without being interpreted again.
+ * only calls returning an int or a bool are folded, and the evaluation is given up as soon as it reads a string or a
+ * global address: those are not numbers before the link.
+ *
+ * the memoization tables are read and written in a memory of its own, zeroed for every call site: a memoized function
+ * returns the same value whatever its table holds, so evaluating it from empty tables is enough.
+ */
+class ConstantEvaluation : public ModulePass
+{
+    public:
+        /** @brief `given_up` names the callees that ran out of steps, the runs of one module may share it */
+        explicit ConstantEvaluation(std::shared_ptr<std::unordered_set<std::string>> given_up = nullptr);
+        ~ConstantEvaluation() override = default;
+
+        /** @brief changes are the folded call sites, the control flow is untouched */
+        PassResult run(ir::Module &module, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "constant-evaluation";
+        }
+
+    private:
+        static constexpr u64 MAX_STEPS = 1 << 20;//<< per run, instructions interpreted before giving up
+        static constexpr u32 MAX_DEPTH = 256;//<< nested calls, the interpreter recurses with them
+
+        const ir::Module *_module = nullptr;
+        std::vector<bool> _pure;//<< per function, copied from the call graph which dies with the first invalidation
+        std::map<std::pair<u32, i32>, i32> _memory;//<< global, index -> dword, absent is zero
+        std::shared_ptr<std::unordered_set<std::string>> _given_up;
+        u64 _steps = 0;
+
+        u64 _fold(ir::Function &function);
+        std::optional<i32> _call(const ir::FunctionId function, const std::vector<i32> &arguments, const u32 depth);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+#include <unordered_set>
+
+namespace cplus::opt {
+
+/**
+ * @brief ConstantPropagation
+ * @details sparse conditional constant propagation (Wegman & Zadeck) over the SSA form
+ *
+ * every value starts unknown and only moves down the lattice unknown -> constant -> overdefined. a block is evaluated
+ * once one of its incoming edges is executable, and a `br` or `switch` on a constant only marks the edge it takes:
+ * the code guarded by a constant condition is never evaluated and cannot pollute the phis it flows into.
+ *
+ * the solution is then applied: constants replace their values, branches taking a single edge become jumps, blocks
+ * that were never reached are deleted, phis drop the edges that were not taken and fold when one value is left, and a
+ * block only entered by a jump from the block laid out before it is merged into it.
+ * arithmetic folds with the 32-bit wrapping semantics of the backend, a division that would trap is left to the runtime.
+ */
+class ConstantPropagation : public FunctionPass
+{
+    public:
+        ConstantPropagation() = default;
+        ~ConstantPropagation() override = default;
+
+        /** @brief changes are the folded instructions and phis, the resolved branches and the merged blocks */
+        PassResult run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "constant-propagation";
+        }
+
+    private:
+        // clang-format off
+        struct Lattice {
+            enum State : u8 { UNKNOWN, CONSTANT, OVERDEFINED };
+
+            State state = UNKNOWN;
+            i64 value = 0;
+
+            constexpr bool operator==(const Lattice &other) const = default;
+        };
+
+        struct Use {
+            ir::BlockId block;
+            u32 index;
+        };
+        // clang-format on
+
+        ir::Function *_function = nullptr;
+        std::vector<Lattice> _values;//<< per value
+        std::vector<std::vector<Use>> _uses;//<< per value, instructions reading it
+        std::vector<bool> _executable;//<< per block
+        std::unordered_set<u64> _edges;//<< executable edges, from << 32 | to
+        std::vector<ir::BlockId> _block_worklist;
+        std::vector<ir::ValueId> _value_worklist;
+        bool _cfg_changed = false;//<< a branch was resolved or a block removed
+
+        u64 _propagate(ir::Function &function);
+
+        void _solve();
+        void _visit(const ir::BlockId block, const ir::Instruction &instruction);
+        void _visit_phi(const ir::BlockId block, const ir::Instruction &instruction);
+        void _visit_terminator(const ir::BlockId block, const ir::Instruction &instruction);
+        void _mark_edge(const ir::BlockId from, const ir::BlockId to);
+        void _update(const ir::ValueId value, const Lattice lattice);
+        Lattice _lattice(const ir::Operand &operand) const;
+        bool _is_executable(const ir::BlockId from, const ir::BlockId to) const;
+
+        u64 _rewrite();
+        u64 _simplify_phis();
+        u64 _merge_blocks();
+        void _remove_blocks(const std::vector<bool> &live);
+
+        static Lattice _evaluate(const ir::Opcode opcode, const Lattice left, const Lattice right);
+};
+
+}// namespace cplus::opt
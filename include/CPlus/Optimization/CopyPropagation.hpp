@@ -0,0 +1,33 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+namespace cplus::opt {
+
+/**
+ * @brief CopyPropagation
+ * @details removes the `mov` temps the IR generator emits for every declaration and assignment
+ *
+ * in SSA a copy and its source hold the same value for the whole life of the copy, so they never interfere and can
+ * always share one location: the copy is coalesced into its source by renaming every use of the destination, chains
+ * of copies resolving to their first source, and the `mov` is deleted. only values and immediates are propagated,
+ * string operands stay in their `mov` since the backend materializes them with a dedicated load.
+ */
+class CopyPropagation : public FunctionPass
+{
+    public:
+        CopyPropagation() = default;
+        ~CopyPropagation() override = default;
+
+        /** @brief changes are the removed copies, the control flow and the calls are untouched */
+        PassResult run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "copy-propagation";
+        }
+
+    private:
+        static u64 _propagate(ir::Function &function);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+namespace cplus::opt {
+
+/**
+ * @brief DeadFunctionElimination
+ * @details removes the functions of a program that cannot be called: only `main`, the @export functions and what the
+ * call graph reaches from them are kept. the strings and globals only the removed functions referred to go with them.
+ *
+ * a module without `main` is a library, any of its functions may be called from another object: nothing is removed,
+ * the linker drops the sections of the functions that end up unused. blocks unreachable from the entry of a function
+ * are already deleted by SCCP.
+ */
+class DeadFunctionElimination : public ModulePass
+{
+    public:
+        DeadFunctionElimination() = default;
+        ~DeadFunctionElimination() override = default;
+
+        /** @brief changes are the removed functions, FunctionIds are renumbered */
+        PassResult run(ir::Module &module, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "dead-functions";
+        }
+
+    private:
+        static std::vector<bool> _find_live(const ir::Module &module, const ir::CallGraph &graph);
+        static void _remove(ir::Module &module, const std::vector<bool> &live);
+};
+
+}// namespace cplus::opt
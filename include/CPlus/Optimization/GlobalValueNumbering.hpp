@@ -0,0 +1,57 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+#include <map>
+
+namespace cplus::opt {
+
+/**
+ * @brief GlobalValueNumbering
+ * @details dominator-based value numbering over the SSA form: removes the instructions computing a value already
+ * computed by an instruction that dominates them
+ *
+ * blocks are visited in dominator tree preorder. every candidate instruction is reduced to an expression: its opcode
+ * and its operands, themselves replaced by the value they were numbered to. an expression already computed in a
+ * dominating block, or earlier in the same block, is redundant: its result becomes the earlier one and the instruction
+ * is deleted. operands of commutative operations are sorted and `sgt`/`sge` are read as swapped `slt`/`sle`, so
+ * `a * b` and `b * a`, or `a > b` and `b < a`, get the same number.
+ *
+ * candidates are the arithmetic, the compares, phis with the same incoming values in the same block, and calls to the
+ * functions the call graph proves pure. a trapping `sdiv` only repeats a trap that already happened.
+ */
+class GlobalValueNumbering : public FunctionPass
+{
+    public:
+        GlobalValueNumbering() = default;
+        ~GlobalValueNumbering() override = default;
+
+        /** @brief changes are the removed instructions, the control flow is untouched */
+        PassResult run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "gvn";
+        }
+
+    private:
+        // clang-format off
+        struct Leader {
+            ir::ValueId value;
+            ir::BlockId block;
+        };
+        // clang-format on
+
+        using Expression = std::vector<i64>;//<< opcode, callee (or block of a phi), then kind and data of each operand
+
+        std::map<Expression, std::vector<Leader>> _leaders;
+        std::vector<ir::ValueId> _numbers;//<< per value, the value it is replaced by, itself when it is a leader
+
+        bool _is_candidate(const ir::Instruction &instruction, const ir::CallGraph &graph) const;
+        Expression _get_expression(const ir::Instruction &instruction, const ir::BlockId block) const;
+        ir::Operand _get_number(const ir::Operand &operand) const;
+
+        u64 _number(const ir::Function &function, const ir::DominatorTree &dominators, const ir::CallGraph &graph);
+        void _replace(ir::Function &function) const;
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <CPlus/Arguments.hpp>
+#include <CPlus/Optimization/PassManager.hpp>
+
+namespace cplus::opt {
+
+/**
+ * @brief Inliner
+ * @details replaces calls to small non-recursive functions by a copy of their body
+ *
+ * functions are visited bottom-up (callees before their callers) so that a callee is inlined with its own calls
+ * already expanded. the caller block is split at the call: the callee blocks are renamed and laid out right after it,
+ * arguments are substituted for the callee's `arg` values, and each `ret` becomes a jump to the continuation block,
+ * the call result being a `mov` of the returned value or, with several returns, a phi of them.
+ *
+ * cost model: a call site is inlined when the callee's size, minus the call sequence it removes, fits the threshold.
+ * the threshold grows with the loop depth of the call site (its estimated frequency) and when the call site is the only
+ * one of its callee. @inline(always) skips the cost model, @inline(never) disables inlining of the function.
+ * -O3 doubles the threshold, -Os drops it to 0 with no bonus: only calls costing more than the callee body are inlined.
+ */
+class Inliner : public ModulePass
+{
+    public:
+        explicit Inliner(const OptLevel level = OPT_O2);
+        ~Inliner() override = default;
+
+        /** @brief changes are the inlined call sites, only the callers that received a body are invalidated */
+        PassResult run(ir::Module &module, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "inline";
+        }
+
+    private:
+        static constexpr u32 INLINE_THRESHOLD = 24;//<< instructions a call site may add to its caller
+        static constexpr u32 AGGRESSIVE_INLINE_THRESHOLD = 48;//<< -O3
+        static constexpr u32 SINGLE_CALL_SITE_BONUS = 48;
+        static constexpr u32 MAX_LOOP_DEPTH = 3;//<< deeper call sites are not assumed any hotter
+        static constexpr u32 MAX_CALLER_SIZE = 4096;
+
+        u32 _threshold = INLINE_THRESHOLD;
+        u32 _single_call_site_bonus = SINGLE_CALL_SITE_BONUS;
+
+        ir::Module *_module = nullptr;
+        AnalysisManager *_analyses = nullptr;
+        std::vector<bool> _recursive;//<< per function, part of a call cycle
+        std::vector<u32> _call_sites;//<< per function, static number of calls to it
+        std::vector<u32> _sizes;//<< per function, instruction count
+        std::vector<ir::FunctionId> _order;//<< callees first
+
+        void _analyze();
+
+        u64 _inline_calls(const ir::FunctionId caller);
+        bool _can_inline(const ir::FunctionId caller, const ir::FunctionId callee) const;
+        bool _should_inline(const ir::FunctionId caller, const ir::Instruction &call, const u32 loop_depth) const;
+        void _inline(const ir::FunctionId caller, const ir::BlockId block, const u64 index);
+
+        std::vector<u32> _loop_depths(const ir::FunctionId function);
+
+        static u32 _size(const ir::Function &function);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+namespace cplus::opt {
+
+/**
+ * @brief Memoization
+ * @details caches the results of pure functions in a table indexed by their arguments, so that a tree recursion
+ * such as `fibonacci(n - 1) + fibonacci(n - 2)` computes each subproblem once
+ *
+ * a memoized function gets two zeroed tables in .bss, `memo.<name>.valid` and `memo.<name>.value`, one dword per
+ * combination of arguments in [0, range): range^parameters entries, plus a spare one. its new entry block computes the
+ * index of its arguments, the spare entry when one is out of range, and returns the cached value if the entry is
+ * valid. every `ret` of the body stores its value and marks the entry valid unless it is the spare one.
+ *
+ * @memoize asks for a function, -fauto-memoize also picks every pure function calling itself at least twice.
+ * only pure functions returning a value, with 1 to MAX_PARAMETERS parameters, can be memoized: reusing a result is
+ * then indistinguishable from computing it again.
+ */
+class Memoization : public ModulePass
+{
+    public:
+        explicit Memoization(const bool automatic = false);
+        ~Memoization() override = default;
+
+        /** @brief changes are the memoized functions, the calls are untouched */
+        PassResult run(ir::Module &module, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "memoize";
+        }
+
+    private:
+        static constexpr u32 MAX_PARAMETERS = 3;
+        static constexpr u32 TABLE_ENTRIES = 4096;//<< per table, the range of each argument is its parameters-th root
+        static constexpr u32 MIN_SELF_CALLS = 2;//<< -fauto-memoize: a single self call recurses linearly, nothing to reuse
+
+        bool _automatic;
+        ir::Module *_module = nullptr;
+
+        bool _should_memoize(const ir::FunctionId function, const ir::CallGraph &graph) const;
+        void _memoize(const ir::FunctionId function);
+
+        static u32 _range(const u32 parameters);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <CPlus/Arguments.hpp>
+#include <CPlus/Compiler/Interface.hpp>
+#include <CPlus/Optimization/PassManager.hpp>
+
+namespace cplus::opt {
+
+/**
+ * @brief Optimizer
+ * @details Runs the IR transformations between the IR generation and the code generation
+ *
+ * the pipeline depends on the optimization level, see _build. analyses are shared by all its passes
+ * through one AnalysisManager per module. the pipeline forwards the module it got from the IR generation, so it
+ * resolves to the rvalue overload and the IR is never copied
+ * @input ir::Module
+ * @output ir::Module (optimized in place, a module given by const reference is copied first)
+ */
+class Optimizer : public CompilerPass<ir::Module, ir::Module>
+{
+    public:
+        explicit Optimizer(const OptLevel level = OPT_O2);
+        ~Optimizer() override = default;
+
+        ir::Module run(const ir::Module &module) override;
+        ir::Module run(ir::Module &&module);
+        cstr name() const override
+        {
+            return "optimizer";
+        }
+
+    private:
+        PassManager _passes;
+
+        void _build(const OptLevel level);
+};
+
+}// namespace cplus::opt
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <CPlus/Optimization/AnalysisManager.hpp>
+
+namespace cplus::opt {
+
+// clang-format off
+struct PassResult {
+    u64 changes = 0;//<< rewritten instructions, blocks or call sites, what is counted is up to the pass
+    u32 preserved = ANALYSIS_ALL;//<< mask of Analyses still valid after the pass
+};
+// clang-format on
+
+/**
+ * @brief ModulePass
+ * @details a transformation of the whole module, it may invalidate single functions itself through the
+ * AnalysisManager and returns what it preserved of the others
+ */
+class ModulePass
+{
+    public:
+        virtual ~ModulePass() = default;
+        virtual PassResult run(ir::Module &module, AnalysisManager &analyses) = 0;
+
+        /** @brief display name, used in the optimizer logs */
+        virtual cstr name() const = 0;
+};
+
+/**
+ * @brief FunctionPass
+ * @details a transformation of one function at a time, run over every function of the module:
+ * what it preserves is invalidated for that function only
+ */
+class FunctionPass
+{
+    public:
+        virtual ~FunctionPass() = default;
+        virtual PassResult run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses) = 0;
+
+        /** @brief display name, used in the optimizer logs */
+        virtual cstr name() const = 0;
+};
+
+/**
+ * @brief PassManager
+ * @details runs registered passes in order over a module, invalidating after each one the analyses it did not
+ * preserve, so an analysis is only recomputed once something it depends on changed
+ */
+class PassManager
+{
+    public:
+        PassManager() = default;
+        ~PassManager() = default;
+
+        void add(std::unique_ptr<ModulePass> pass);
+        void add(std::unique_ptr<FunctionPass> pass);
+
+        inline bool empty() const
+        {
+            return _passes.empty();
+        }
+
+        /** @return the number of changes of every pass */
+        u64 run(ir::Module &module, AnalysisManager &analyses);
+
+    private:
+        /**
+        * @brief FunctionPassAdaptor
+        * @details lifts a FunctionPass to the module, invalidating each function as soon as it is transformed
+        */
+        class FunctionPassAdaptor : public ModulePass
+        {
+            public:
+                explicit FunctionPassAdaptor(std::unique_ptr<FunctionPass> pass);
+                ~FunctionPassAdaptor() override = default;
+
+                PassResult run(ir::Module &module, AnalysisManager &analyses) override;
+                cstr name() const override
+                {
+                    return _pass->name();
+                }
+
+            private:
+                std::unique_ptr<FunctionPass> _pass;
+        };
+
+        std::vector<std::unique_ptr<ModulePass>> _passes;
+};
+
+}// namespace cplus::opt
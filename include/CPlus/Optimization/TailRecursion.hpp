@@ -0,0 +1,51 @@
+#pragma once
+
+#include <CPlus/Optimization/PassManager.hpp>
+
+#include <optional>
+
+namespace cplus::opt {
+
+/**
+ * @brief TailRecursion
+ * @details turns the calls of a function to itself in tail position into a loop over its own body
+ *
+ * a tail site is a block ending in `%r = call @self(args...); ret %r`. the `arg` values move to a new entry block that
+ * jumps to the old one, now the loop header, where a phi per parameter takes the `arg` from the entry and the call
+ * arguments from each tail site, which jumps back instead of calling.
+ *
+ * a site may also end in `%r = call @self(args...); %x = op %r, v; ret %x` with op an associative and commutative
+ * `add`, `mul`, `and` or `or` (`return n * f(n - 1)`): an accumulator phi starting at the identity of op collects
+ * `op acc, v` on every iteration, and every other `ret %y` of the function returns `op acc, %y` instead.
+ * all accumulating sites of a function must share their op, the others are left as calls.
+ * calls in tail position to other functions are left to the backend, which emits them as jumps.
+ */
+class TailRecursion : public FunctionPass
+{
+    public:
+        TailRecursion() = default;
+        ~TailRecursion() override = default;
+
+        /** @brief changes are the removed self calls, the function gets a new entry block and loses a call edge */
+        PassResult run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses) override;
+        cstr name() const override
+        {
+            return "tail-recursion";
+        }
+
+    private:
+        // clang-format off
+        struct TailSite {
+            ir::BlockId block;
+            u64 call;//<< index of the call in the block
+            bool accumulates;//<< the call result goes through the accumulator op before the ret
+            ir::Operand operand;//<< v of `op %r, v` when accumulating
+        };
+        // clang-format on
+
+        static std::vector<TailSite> _find_sites(const ir::Function &function, const ir::FunctionId id,
+            std::optional<ir::Opcode> &accumulator);
+        static void _eliminate(ir::Function &function, const std::vector<TailSite> &sites, const std::optional<ir::Opcode> accumulator);
+};
+
+}// namespace cplus::opt
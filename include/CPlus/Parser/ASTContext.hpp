@@ -0,0 +1,73 @@
+#pragma once
+
+#include <CPlus/Types.hpp>
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace cplus {
+
+namespace ast {
+
+/**
+ * @brief ArenaDeleter
+ * @details nodes are released all at once with their ASTContext, so a pointer to a node never frees it
+ */
+struct ArenaDeleter {
+        template<typename T>
+        constexpr void operator()(T *) const noexcept
+        {
+            /* __arena__ */
+        }
+};
+
+/** @brief edge of the tree, the pointee lives in the ASTContext of its Module */
+template<typename T>
+using Ptr = std::unique_ptr<T, ArenaDeleter>;
+
+/** @brief list of children, its storage lives in the ASTContext of its Module */
+template<typename T>
+using List = std::pmr::vector<T>;
+
+/**
+ * @brief ASTContext
+ * @details bump arena owning every node, type and child list of a Module
+ *
+ * nodes are laid out contiguously in the order they are parsed, and their destructors never run:
+ * everything they hold is either trivially destructible or stored in the same arena (List),
+ * so dropping the module returns a handful of blocks to the heap whatever the size of the tree.
+ */
+class ASTContext
+{
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+
+        ASTContext();
+        ~ASTContext() = default;
+
+        ASTContext(const ASTContext &) = delete;
+        ASTContext &operator=(const ASTContext &) = delete;
+
+        /**
+        * @brief make
+        * @details allocates and constructs a T in the arena, a T holding a List takes the arena allocator as its last
+        * constructor argument (uses-allocator construction)
+        */
+        template<typename T, typename... Args>
+        Ptr<T> make(Args &&...args)
+        {
+            return Ptr<T>(allocator().new_object<T>(std::forward<Args>(args)...));
+        }
+
+        allocator_type allocator();
+
+    private:
+        static constexpr u64 INITIAL_BLOCK_SIZE = 16 * 1024;
+
+        std::pmr::monotonic_buffer_resource _arena;
+};
+
+}// namespace ast
+
+}// namespace cplus
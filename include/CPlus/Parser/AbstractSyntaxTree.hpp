@@ -15,9 +15,14 @@ class AbstractSyntaxTree : public CompilerPass<std::vector<lx::Token>, std::uniq
         constexpr ~AbstractSyntaxTree() = default;
 
         std::unique_ptr<Module> run(const std::vector<lx::Token> &tokens) override;
+        cstr name() const override
+        {
+            return "parser";
+        }
 
     private:
         std::vector<lx::Token> _tokens;
+        ASTContext *_context = nullptr;//<< arena of the module being parsed
         cstr _module;
         u64 _current = 0;
 
@@ -39,14 +44,17 @@ class AbstractSyntaxTree : public CompilerPass<std::vector<lx::Token>, std::uniq
 
         /** @brief statements */
         StatementPtr _parse_declaration();
-        StatementPtr _parse_function_declaration();
+        StatementPtr _parse_function_declaration(List<Attribute> attributes);
+        List<Attribute> _parse_attributes();
         StatementPtr _parse_variable_declaration(bool is_const, bool semi_colon);
         StatementPtr _parse_statement();
         StatementPtr _parse_block_statement();
         StatementPtr _parse_if_statement();
         StatementPtr _parse_for_statement();
+        StatementPtr _parse_while_statement();
         StatementPtr _parse_foreach_statement();
         StatementPtr _parse_case_statement();
+        bool _is_case_label();
         StatementPtr _parse_return_statement();
         StatementPtr _parse_expression_statement();
 
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <CPlus/Parser/Token.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace cplus {
+
+namespace lx {
+
+// clang-format off
+struct Keyword {
+    std::string_view lexeme;
+    TokenKind kind;
+};
+
+static constexpr Keyword KEYWORDS[] = {
+    {"def", TokenKind::TOKEN_DEF},
+    {"const", TokenKind::TOKEN_CONST},
+    {"return", TokenKind::TOKEN_RETURN},
+    {"struct", TokenKind::TOKEN_STRUCT},
+
+    {"if", TokenKind::TOKEN_IF},
+    {"elsif", TokenKind::TOKEN_ELSIF},
+    {"else", TokenKind::TOKEN_ELSE},
+
+    {"for", TokenKind::TOKEN_FOR},
+    {"foreach", TokenKind::TOKEN_FOREACH},
+    {"while", TokenKind::TOKEN_WHILE},
+    {"in", TokenKind::TOKEN_IN},
+
+    {"case", TokenKind::TOKEN_CASE},
+    {"when", TokenKind::TOKEN_WHEN},
+    {"default", TokenKind::TOKEN_DEFAULT},
+};
+// clang-format on
+
+namespace detail {
+
+static constexpr u32 KEYWORD_BITS = 5;
+static constexpr u32 KEYWORD_SLOTS = 1u << KEYWORD_BITS;
+
+/**
+ * @brief keyword key
+ * @info (length, first character, last character) is distinct for every keyword, only these three bytes are hashed
+ */
+static constexpr u32 keyword_key(const std::string_view lexeme)
+{
+    return static_cast<u32>(static_cast<u8>(lexeme.front())) << 16 | static_cast<u32>(static_cast<u8>(lexeme.back())) << 8
+        | static_cast<u32>(lexeme.size());
+}
+
+static constexpr u32 keyword_slot(const u32 key, const u32 seed)
+{
+    return (key * seed) >> (32 - KEYWORD_BITS);
+}
+
+/**
+ * @brief keyword seed
+ * @details smallest odd multiplier sending every keyword to its own slot, searched at compile time
+ */
+static consteval u32 keyword_seed()
+{
+    for (u32 seed = 1; seed < (1u << 24); seed += 2) {
+        std::array<bool, KEYWORD_SLOTS> used{};
+        bool perfect = true;
+
+        for (const auto &keyword : KEYWORDS) {
+            const u32 slot = keyword_slot(keyword_key(keyword.lexeme), seed);
+
+            if (used[slot]) {
+                perfect = false;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (perfect) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+static constexpr u32 KEYWORD_SEED = keyword_seed();
+static_assert(KEYWORD_SEED != 0, "no perfect hash for the keyword table, grow KEYWORD_BITS");
+
+static consteval std::array<Keyword, KEYWORD_SLOTS> keyword_table()
+{
+    std::array<Keyword, KEYWORD_SLOTS> table{};
+
+    table.fill({"", TokenKind::TOKEN_IDENTIFIER});
+    for (const auto &keyword : KEYWORDS) {
+        table[keyword_slot(keyword_key(keyword.lexeme), KEYWORD_SEED)] = keyword;
+    }
+    return table;
+}
+
+static constexpr std::array<Keyword, KEYWORD_SLOTS> KEYWORD_TABLE = keyword_table();
+
+static consteval u64 keyword_length(const bool longest)
+{
+    u64 length = longest ? 0 : ~0ull;
+
+    for (const auto &keyword : KEYWORDS) {
+        length = longest ? std::max<u64>(length, keyword.lexeme.size()) : std::min<u64>(length, keyword.lexeme.size());
+    }
+    return length;
+}
+
+static constexpr u64 KEYWORD_MIN_LENGTH = keyword_length(false);
+static constexpr u64 KEYWORD_MAX_LENGTH = keyword_length(true);
+
+}// namespace detail
+
+/**
+ * @brief keyword
+ * @details perfect hash lookup: one multiply picks the only candidate slot, one comparison confirms it
+ * @return the keyword's TokenKind, TOKEN_IDENTIFIER for anything else
+ */
+static constexpr TokenKind keyword(const std::string_view lexeme)
+{
+    if (lexeme.size() < detail::KEYWORD_MIN_LENGTH || lexeme.size() > detail::KEYWORD_MAX_LENGTH) {
+        return TokenKind::TOKEN_IDENTIFIER;
+    }
+
+    const Keyword &candidate = detail::KEYWORD_TABLE[detail::keyword_slot(detail::keyword_key(lexeme), detail::KEYWORD_SEED)];
+
+    return candidate.lexeme == lexeme ? candidate.kind : TokenKind::TOKEN_IDENTIFIER;
+}
+
+static_assert(keyword("foreach") == TokenKind::TOKEN_FOREACH && keyword("for") == TokenKind::TOKEN_FOR);
+static_assert(keyword("format") == TokenKind::TOKEN_IDENTIFIER && keyword("x") == TokenKind::TOKEN_IDENTIFIER);
+
+}// namespace lx
+
+}// namespace cplus
@@ -25,6 +25,10 @@ class LexicalAnalyzer : public CompilerPass<FileContent, std::vector<Token>>
         constexpr ~LexicalAnalyzer() = default;
 
         std::vector<Token> run(const FileContent &source) override;
+        cstr name() const override
+        {
+            return "lexer";
+        }
 
     private:
         std::string _source;
@@ -32,6 +32,7 @@ class ASTLogger : public ASTVisitor
         void visit(ReturnStatement &node) override;
         void visit(IfStatement &node) override;
         void visit(ForStatement &node) override;
+        void visit(WhileStatement &node) override;
         void visit(ForeachStatement &node) override;
         void visit(CaseStatement &node) override;
         void visit(FunctionDeclaration &node) override;
@@ -47,6 +47,7 @@ enum class TokenKind {
     TOKEN_COLON,
     TOKEN_SEMICOLON,
     TOKEN_ARROW,
+    TOKEN_AT,
 
     TOKEN_EQ,
     TOKEN_NEQ,
@@ -156,6 +157,8 @@ static inline constexpr cplus::cstr to_string(const TokenKind kind)
             return "SEMICOLON";
         case TokenKind::TOKEN_ARROW:
             return "ARROW";
+        case TokenKind::TOKEN_AT:
+            return "AT";
 
         case TokenKind::TOKEN_EQ:
             return "EQ";
@@ -1,10 +1,10 @@
 #pragma once
 
+#include <CPlus/Parser/ASTContext.hpp>
 #include <CPlus/Types.hpp>
 
-#include <memory>
+#include <string>
 #include <variant>
-#include <vector>
 
 namespace cplus {
 
@@ -15,10 +15,10 @@ class Expression;
 class Statement;
 struct Type;
 
-using ASTNodePtr = std::unique_ptr<ASTNode>;
-using ExpressionPtr = std::unique_ptr<Expression>;
-using StatementPtr = std::unique_ptr<Statement>;
-using TypePtr = std::unique_ptr<Type>;
+using ASTNodePtr = Ptr<ASTNode>;
+using ExpressionPtr = Ptr<Expression>;
+using StatementPtr = Ptr<Statement>;
+using TypePtr = Ptr<Type>;
 
 class ASTNode
 {
@@ -172,10 +172,12 @@ class UnaryExpression : public Expression
 class CallExpression : public Expression
 {
     public:
+        using allocator_type = ASTContext::allocator_type;
+
         std::string_view function_name;
-        std::vector<ExpressionPtr> arguments;
+        List<ExpressionPtr> arguments;
 
-        inline CallExpression(const std::string_view &name) : function_name(name)
+        inline CallExpression(const std::string_view &name, const allocator_type &allocator) : function_name(name), arguments(allocator)
         {
             /* __ctor__ */
         }
@@ -213,7 +215,14 @@ class ExpressionStatement : public Statement
 class BlockStatement : public Statement
 {
     public:
-        std::vector<StatementPtr> statements;
+        using allocator_type = ASTContext::allocator_type;
+
+        List<StatementPtr> statements;
+
+        inline BlockStatement(const allocator_type &allocator) : statements(allocator)
+        {
+            /* __ctor__ */
+        }
 
         void accept(ASTVisitor &visitor) override;
 };
@@ -225,6 +234,7 @@ class VariableDeclaration : public Statement
         TypePtr declared_type;    //<< nullptr for auto-deduced
         ExpressionPtr initializer;//<< nullptr if no initializer
         bool is_const = false;
+        bool is_assignment = false;//<< set by the symbol table when the name is already a variable in scope
 
         inline VariableDeclaration(const std::string_view &n, bool is_const_ = false) : name(n), is_const(is_const_)
         {
@@ -273,6 +283,20 @@ class ForStatement : public Statement
         void accept(ASTVisitor &visitor) override;
 };
 
+class WhileStatement : public Statement
+{
+    public:
+        ExpressionPtr condition;
+        StatementPtr body;
+
+        inline WhileStatement(ExpressionPtr cond, StatementPtr b) : condition(std::move(cond)), body(std::move(b))
+        {
+            /* __ctor__ */
+        }
+
+        void accept(ASTVisitor &visitor) override;
+};
+
 class ForeachStatement : public Statement
 {
     public:
@@ -292,15 +316,30 @@ class ForeachStatement : public Statement
 class CaseStatement : public Statement
 {
     public:
+        using allocator_type = ASTContext::allocator_type;
+
         struct CaseClause {
-                ExpressionPtr value;//<< default case is nullptr
-                std::vector<StatementPtr> statements;
+                using allocator_type = ASTContext::allocator_type;
+
+                List<ExpressionPtr> values;//<< empty for the default case
+                List<StatementPtr> statements;
+
+                inline CaseClause(const allocator_type &allocator) : values(allocator), statements(allocator)
+                {
+                    /* __ctor__ */
+                }
+
+                inline CaseClause(CaseClause &&other, const allocator_type &allocator)
+                    : values(std::move(other.values), allocator), statements(std::move(other.statements), allocator)
+                {
+                    /* __ctor__ */
+                }
         };
 
         ExpressionPtr expression;
-        std::vector<CaseClause> clauses;
+        List<CaseClause> clauses;
 
-        inline CaseStatement(ExpressionPtr expr) : expression(std::move(expr))
+        inline CaseStatement(ExpressionPtr expr, const allocator_type &allocator) : expression(std::move(expr)), clauses(allocator)
         {
             /* __ctor__ */
         }
@@ -320,26 +359,49 @@ class Parameter
         }
 };
 
+// clang-format off
+struct Attribute {
+    std::string_view name;
+    std::string_view argument;//<< empty when the attribute takes none
+    u64 line = 0;
+    u64 column = 0;
+};
+// clang-format on
+
 class FunctionDeclaration : public Statement
 {
     public:
+        using allocator_type = ASTContext::allocator_type;
+
         std::string_view name;
-        std::vector<Parameter> parameters;
+        List<Attribute> attributes;//<< @name or @name(argument) lines preceding `def`
+        List<Parameter> parameters;
         TypePtr return_type;
         StatementPtr body;
 
-        inline FunctionDeclaration(const std::string_view &n) : name(n)
+        inline FunctionDeclaration(const std::string_view &n, const allocator_type &allocator)
+            : name(n), attributes(allocator), parameters(allocator)
         {
             /* __ctor__ */
         }
         void accept(ASTVisitor &visitor) override;
 };
 
+/**
+ * @brief Module
+ * @details root of the tree and owner of its ASTContext, every node below it is freed along with the arena
+ */
 class Module : public ASTNode
 {
     public:
+        ASTContext context;//<< declared first, outlives the lists below
         std::string name;
-        std::vector<StatementPtr> declarations;
+        List<StatementPtr> declarations;
+
+        inline Module() : declarations(context.allocator())
+        {
+            /* __ctor__ */
+        }
 
         void accept(ASTVisitor &visitor) override;
 };
@@ -364,18 +426,13 @@ class ASTVisitor
         virtual void visit(ReturnStatement &node) = 0;
         virtual void visit(IfStatement &node) = 0;
         virtual void visit(ForStatement &node) = 0;
+        virtual void visit(WhileStatement &node) = 0;
         virtual void visit(ForeachStatement &node) = 0;
         virtual void visit(CaseStatement &node) = 0;
         virtual void visit(FunctionDeclaration &node) = 0;
         virtual void visit(Module &node) = 0;
 };
 
-template<typename T, typename... Args>
-static inline std::unique_ptr<T> make(Args &&...args)
-{
-    return std::make_unique<T>(std::forward<Args>(args)...);
-}
-
 }// namespace ast
 
 }// namespace cplus
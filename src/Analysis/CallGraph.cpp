@@ -0,0 +1,176 @@
+#include <CPlus/Analysis/CallGraph.hpp>
+
+#include <algorithm>
+
+/**
+ * public
+ */
+
+cplus::ir::CallGraph::CallGraph(const Module &module)
+{
+    const u64 count = module.functions.size();
+    std::vector<FunctionId> last_caller(count, INVALID_ID);
+    std::vector<FunctionId> last_callee(count, INVALID_ID);
+
+    _callees.resize(count);
+    _callers.resize(count);
+    _call_sites.assign(count, 0);
+    _recursive.assign(count, false);
+
+    for (FunctionId f = 0; f < count; ++f) {
+        for (const auto &block : module.functions[f].blocks) {
+            for (const auto &instruction : block.instructions) {
+                if (instruction.opcode != Opcode::CALL) {
+                    continue;
+                }
+
+                const FunctionId callee = instruction.callee;
+
+                ++_call_sites[callee];
+                _recursive[f] = _recursive[f] || callee == f;
+
+                /** @brief callers are visited in order, so the last caller recorded is enough to keep the lists distinct */
+                if (last_caller[callee] != f) {
+                    last_caller[callee] = f;
+                    _callers[callee].push_back(f);
+                }
+                if (std::find(_callees[f].begin(), _callees[f].end(), callee) == _callees[f].end()) {
+                    _callees[f].push_back(callee);
+                }
+            }
+        }
+    }
+
+    _find_components();
+    _find_effects(module);
+}
+
+std::string cplus::ir::describe_effects(const u8 effects)
+{
+    constexpr std::pair<Effects, cstr> names[] = {{EFFECT_READS_MEMORY, "reads"}, {EFFECT_WRITES_MEMORY, "writes"},
+        {EFFECT_IO, "io"}, {EFFECT_MAY_RECURSE, "recurse"}};
+    std::string text = "effects(";
+    cstr separator = "";
+
+    for (const auto &[effect, name] : names) {
+        if (effects & effect) {
+            text += separator;
+            text += name;
+            separator = ", ";
+        }
+    }
+    return text + (effects == EFFECT_NONE ? "none)" : ")");
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief find components
+ * @details iterative Tarjan: a function whose low link is its own index is the root of a component,
+ * which is everything above it on the stack. components are completed callees first
+ */
+void cplus::ir::CallGraph::_find_components()
+{
+    // clang-format off
+    struct Frame {
+        FunctionId function;
+        u64 next;
+    };
+    // clang-format on
+
+    const u32 count = size();
+    std::vector<u32> index(count, INVALID_ID);
+    std::vector<u32> low(count, 0);
+    std::vector<bool> on_stack(count, false);
+    std::vector<FunctionId> stack;
+    std::vector<Frame> dfs;
+    u32 counter = 0;
+
+    _component.assign(count, INVALID_ID);
+    _order.reserve(count);
+
+    for (FunctionId root = 0; root < count; ++root) {
+        if (index[root] != INVALID_ID) {
+            continue;
+        }
+
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        dfs.push_back({.function = root, .next = 0});
+
+        while (!dfs.empty()) {
+            const FunctionId f = dfs.back().function;
+
+            if (dfs.back().next < _callees[f].size()) {
+                const FunctionId callee = _callees[f][dfs.back().next++];
+
+                if (index[callee] == INVALID_ID) {
+                    index[callee] = low[callee] = counter++;
+                    stack.push_back(callee);
+                    on_stack[callee] = true;
+                    dfs.push_back({.function = callee, .next = 0});
+                } else if (on_stack[callee]) {
+                    low[f] = std::min(low[f], index[callee]);
+                }
+                continue;
+            }
+
+            dfs.pop_back();
+            if (!dfs.empty()) {
+                low[dfs.back().function] = std::min(low[dfs.back().function], low[f]);
+            }
+            if (low[f] != index[f]) {
+                continue;
+            }
+
+            const u64 start = static_cast<u64>(std::find(stack.begin(), stack.end(), f) - stack.begin());
+            const u32 component = static_cast<u32>(_components.size());
+            auto &members = _components.emplace_back(stack.begin() + static_cast<i64>(start), stack.end());
+
+            for (const FunctionId member : members) {
+                on_stack[member] = false;
+                _component[member] = component;
+                _recursive[member] = _recursive[member] || members.size() > 1;
+                _order.push_back(member);
+            }
+            stack.resize(start);
+        }
+    }
+}
+
+/**
+ * @brief find effects
+ * @details components are complete callees first: the summary of a component joins the instructions of its functions
+ * and the summaries of the callees outside of it, already known
+ */
+void cplus::ir::CallGraph::_find_effects(const Module &module)
+{
+    _effects.assign(size(), EFFECT_NONE);
+
+    for (u32 c = 0; c < _components.size(); ++c) {
+        u8 effects = _recursive[_components[c][0]] ? EFFECT_MAY_RECURSE : EFFECT_NONE;
+
+        for (const FunctionId member : _components[c]) {
+            for (const auto &block : module.functions[member].blocks) {
+                for (const auto &instruction : block.instructions) {
+                    const bool memory = instruction.opcode == Opcode::LOAD || instruction.opcode == Opcode::STORE;
+
+                    if (memory && !module.globals[instruction.operands[0].id()].cache) {
+                        effects |= instruction.opcode == Opcode::LOAD ? EFFECT_READS_MEMORY : EFFECT_WRITES_MEMORY;
+                    }
+                }
+            }
+            for (const FunctionId callee : _callees[member]) {
+                if (_component[callee] != c) {
+                    effects |= _effects[callee];
+                }
+            }
+        }
+        for (const FunctionId member : _components[c]) {
+            _effects[member] = effects;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include <CPlus/Analysis/ControlFlowGraph.hpp>
+
+#include <algorithm>
+
+/**
+ * public
+ */
+
+cplus::ir::ControlFlowGraph::ControlFlowGraph(const Function &function)
+{
+    // clang-format off
+    struct Frame {
+        BlockId block;
+        u64 next;
+    };
+    // clang-format on
+
+    const u64 count = function.blocks.size();
+    std::vector<bool> visited(count, false);
+    std::vector<Frame> dfs;
+
+    _successors.resize(count);
+    _predecessors.resize(count);
+    _order_index.assign(count, INVALID_ID);
+
+    for (BlockId b = 0; b < count; ++b) {
+        _successors[b] = ir::successors(function.blocks[b]);
+        for (const BlockId successor : _successors[b]) {
+            _predecessors[successor].push_back(b);
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    /** @brief iterative depth-first search, a block is ordered once all its successors are */
+    visited[0] = true;
+    dfs.push_back({.block = 0, .next = 0});
+    while (!dfs.empty()) {
+        Frame &frame = dfs.back();
+
+        if (frame.next < _successors[frame.block].size()) {
+            const BlockId successor = _successors[frame.block][frame.next++];
+
+            if (!visited[successor]) {
+                visited[successor] = true;
+                dfs.push_back({.block = successor, .next = 0});
+            }
+            continue;
+        }
+        _order.push_back(frame.block);
+        dfs.pop_back();
+    }
+
+    std::reverse(_order.begin(), _order.end());
+    for (u32 i = 0; i < _order.size(); ++i) {
+        _order_index[_order[i]] = i;
+    }
+}
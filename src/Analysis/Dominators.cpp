@@ -0,0 +1,162 @@
+#include <CPlus/Analysis/Dominators.hpp>
+
+#include <algorithm>
+
+/**
+ * public
+ */
+
+/**
+ * @brief DominatorTree
+ * @details vertices are numbered from 1 in depth-first pre-order, 0 standing for "none" in the forest links
+ */
+cplus::ir::DominatorTree::DominatorTree(const ControlFlowGraph &cfg)
+{
+    // clang-format off
+    struct Frame {
+        BlockId block;
+        u64 next;
+    };
+    // clang-format on
+
+    const u32 count = cfg.size();
+    std::vector<u32> number(count, 0);
+    std::vector<BlockId> vertex{INVALID_ID};
+    std::vector<u32> parent{0};
+    std::vector<Frame> dfs;
+
+    _idom.assign(count, INVALID_ID);
+    _children.assign(count, {});
+    if (count == 0) {
+        return;
+    }
+
+    number[0] = 1;
+    vertex.push_back(0);
+    parent.push_back(0);
+    dfs.push_back({.block = 0, .next = 0});
+    while (!dfs.empty()) {
+        Frame &frame = dfs.back();
+
+        if (frame.next == cfg.successors(frame.block).size()) {
+            dfs.pop_back();
+            continue;
+        }
+
+        const BlockId successor = cfg.successors(frame.block)[frame.next++];
+
+        if (number[successor] == 0) {
+            number[successor] = static_cast<u32>(vertex.size());
+            vertex.push_back(successor);
+            parent.push_back(number[frame.block]);
+            dfs.push_back({.block = successor, .next = 0});
+        }
+    }
+
+    const u32 n = static_cast<u32>(vertex.size()) - 1;
+    std::vector<u32> semi(n + 1);
+    std::vector<u32> label(n + 1);
+    std::vector<u32> ancestor(n + 1, 0);
+    std::vector<u32> idom(parent);
+    std::vector<u32> path;
+
+    for (u32 i = 0; i <= n; ++i) {
+        semi[i] = label[i] = i;
+    }
+
+    /** @brief eval: the vertex of minimal semidominator on the forest path to v, compressing that path */
+    const auto eval = [&](const u32 v) {
+        if (ancestor[v] == 0) {
+            return v;
+        }
+        path.clear();
+        for (u32 u = v; ancestor[ancestor[u]] != 0; u = ancestor[u]) {
+            path.push_back(u);
+        }
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            const u32 a = ancestor[*it];
+
+            if (semi[label[a]] < semi[label[*it]]) {
+                label[*it] = label[a];
+            }
+            ancestor[*it] = ancestor[a];
+        }
+        return label[v];
+    };
+
+    for (u32 i = n; i >= 2; --i) {
+        for (const BlockId predecessor : cfg.predecessors(vertex[i])) {
+            if (number[predecessor] != 0) {
+                semi[i] = std::min(semi[i], semi[eval(number[predecessor])]);
+            }
+        }
+        ancestor[i] = parent[i];
+    }
+
+    for (u32 i = 2; i <= n; ++i) {
+        u32 j = idom[i];
+
+        while (j > semi[i]) {
+            j = idom[j];
+        }
+        idom[i] = j;
+        _idom[vertex[i]] = vertex[j];
+        _children[vertex[j]].push_back(vertex[i]);
+    }
+
+    _number();
+}
+
+cplus::ir::DominanceFrontier::DominanceFrontier(const ControlFlowGraph &cfg, const DominatorTree &dominators)
+{
+    _frontiers.assign(cfg.size(), {});
+
+    /** @brief the entry is also entered from outside the function */
+    for (const BlockId block : cfg.reverse_post_order()) {
+        if (cfg.predecessors(block).size() < (block == 0 ? 1 : 2)) {
+            continue;
+        }
+        for (const BlockId predecessor : cfg.predecessors(block)) {
+            if (!cfg.is_reachable(predecessor)) {
+                continue;
+            }
+            for (BlockId runner = predecessor; runner != dominators.idom(block); runner = dominators.idom(runner)) {
+                if (_frontiers[runner].empty() || _frontiers[runner].back() != block) {
+                    _frontiers[runner].push_back(block);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * private
+ */
+
+/** @brief entry and exit numbers of an iterative walk of the tree: a dominates b when b's interval nests in a's */
+void cplus::ir::DominatorTree::_number()
+{
+    std::vector<std::pair<BlockId, u64>> stack{{0, 0}};
+    u32 clock = 0;
+
+    _enter.assign(_idom.size(), INVALID_ID);
+    _exit.assign(_idom.size(), INVALID_ID);
+    _enter[0] = clock++;
+    _pre_order.push_back(0);
+
+    while (!stack.empty()) {
+        auto &[block, next] = stack.back();
+
+        if (next == _children[block].size()) {
+            _exit[block] = clock++;
+            stack.pop_back();
+            continue;
+        }
+
+        const BlockId child = _children[block][next++];
+
+        _enter[child] = clock++;
+        _pre_order.push_back(child);
+        stack.emplace_back(child, 0);
+    }
+}
@@ -0,0 +1,64 @@
+#include <CPlus/Analysis/Liveness.hpp>
+
+/**
+ * public
+ */
+
+cplus::ir::Liveness::Liveness(const Function &function)
+{
+    const u64 count = function.blocks.size();
+    std::vector<ValueSet> gen(count, ValueSet(function.values));
+    std::vector<ValueSet> kill(count, ValueSet(function.values));
+    std::vector<ValueSet> phi_uses(count, ValueSet(function.values));
+    std::vector<std::vector<BlockId>> succs(count);
+
+    _live_in.assign(count, ValueSet(function.values));
+    _live_out.assign(count, ValueSet(function.values));
+
+    /** @brief local sets, phi operands are uses at the end of their incoming block */
+    for (u64 b = 0; b < count; ++b) {
+        succs[b] = successors(function.blocks[b]);
+
+        for (const auto &instruction : function.blocks[b].instructions) {
+            if (instruction.opcode == Opcode::PHI) {
+                for (u64 i = 0; i + 1 < instruction.operands.size(); i += 2) {
+                    if (instruction.operands[i].is_value()) {
+                        phi_uses[instruction.operands[i + 1].id()].insert(instruction.operands[i].id());
+                    }
+                }
+            } else {
+                for (const auto &operand : instruction.operands) {
+                    if (operand.is_value() && !kill[b].contains(operand.id())) {
+                        gen[b].insert(operand.id());
+                    }
+                }
+            }
+            if (instruction.result != INVALID_ID) {
+                kill[b].insert(instruction.result);
+            }
+        }
+    }
+
+    /** @brief iterate to a fixpoint, reverse layout order converges quickly on forward code */
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (u64 b = count; b-- > 0;) {
+            ValueSet out = phi_uses[b];
+
+            for (const BlockId succ : succs[b]) {
+                out.merge(_live_in[succ]);
+            }
+
+            ValueSet in = gen[b];
+            out.for_each([&](const ValueId value) {
+                if (!kill[b].contains(value)) {
+                    in.insert(value);
+                }
+            });
+
+            changed |= _live_out[b].merge(out);
+            changed |= _live_in[b].merge(in);
+        }
+    }
+}
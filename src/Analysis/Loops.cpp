@@ -0,0 +1,86 @@
+#include <CPlus/Analysis/Loops.hpp>
+
+/**
+ * public
+ */
+
+cplus::ir::LoopInfo::LoopInfo(const ControlFlowGraph &cfg, const DominatorTree &dominators)
+{
+    const auto &order = dominators.pre_order();
+    std::vector<BlockId> worklist;
+
+    _innermost.assign(cfg.size(), INVALID_ID);
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const BlockId header = *it;
+        std::vector<BlockId> latches;
+
+        for (const BlockId predecessor : cfg.predecessors(header)) {
+            if (dominators.dominates(header, predecessor)) {
+                latches.push_back(predecessor);
+            }
+        }
+        if (latches.empty()) {
+            continue;
+        }
+
+        const u32 loop = static_cast<u32>(_loops.size());
+
+        _loops.push_back(Loop{.header = header, .latches = latches, .blocks = {}});
+        _innermost[header] = loop;
+        worklist = std::move(latches);
+
+        /** @brief backward walk from the latches, stopped by the header which dominates the whole loop */
+        while (!worklist.empty()) {
+            const BlockId block = worklist.back();
+
+            worklist.pop_back();
+            if (!cfg.is_reachable(block)) {
+                continue;
+            }
+            if (_innermost[block] == INVALID_ID) {
+                _innermost[block] = loop;
+                worklist.insert(worklist.end(), cfg.predecessors(block).begin(), cfg.predecessors(block).end());
+                continue;
+            }
+
+            const u32 inner = _outermost(_innermost[block]);
+
+            if (inner != loop) {
+                _loops[inner].parent = loop;
+                worklist.insert(worklist.end(), cfg.predecessors(_loops[inner].header).begin(),
+                    cfg.predecessors(_loops[inner].header).end());
+            }
+        }
+    }
+
+    /** @brief parents were found after their children: walk outer loops first for the depths */
+    for (u32 loop = static_cast<u32>(_loops.size()); loop-- > 0;) {
+        if (_loops[loop].parent != INVALID_ID) {
+            _loops[loop].depth = _loops[_loops[loop].parent].depth + 1;
+        }
+    }
+
+    for (const BlockId block : order) {
+        for (u32 loop = _innermost[block]; loop != INVALID_ID; loop = _loops[loop].parent) {
+            if (_loops[loop].header != block) {
+                _loops[loop].blocks.push_back(block);
+            }
+        }
+    }
+    for (auto &loop : _loops) {
+        loop.blocks.insert(loop.blocks.begin(), loop.header);
+    }
+}
+
+/**
+ * private
+ */
+
+cplus::u32 cplus::ir::LoopInfo::_outermost(u32 loop) const
+{
+    while (_loops[loop].parent != INVALID_ID) {
+        loop = _loops[loop].parent;
+    }
+    return loop;
+}
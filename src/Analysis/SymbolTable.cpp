@@ -2,6 +2,8 @@
 #include <CPlus/Arguments.hpp>
 #include <CPlus/Logger.hpp>
 
+#include <algorithm>
+#include <array>
 #include <variant>
 
 /**
@@ -11,6 +13,7 @@
 std::unique_ptr<cplus::ast::Module> cplus::st::SymbolTable::run(const std::unique_ptr<ast::Module> &module)
 {
     _module = module->name.c_str();
+    _context = &module->context;
     logger::info("Building symbol table for module: ", _module, "...");
 
     _enter_scope();
@@ -46,14 +49,53 @@ static constexpr inline std::string_view _to_string(cplus::ast::Type::Kind k)
     }
 }
 
-static cplus::ast::TypePtr _make_type(const cplus::ast::Type::Kind k)
+/**
+ * private
+ */
+
+cplus::ast::TypePtr cplus::st::SymbolTable::_make_type(const ast::Type::Kind k)
 {
-    return cplus::ast::make<cplus::ast::Type>(k, _to_string(k));
+    return _context->make<ast::Type>(k, _to_string(k));
 }
 
 /**
- * private
+ * @brief check attributes
+ * @details every attribute must be known and given one of its accepted arguments, at most once per function
  */
+void cplus::st::SymbolTable::_check_attributes(const ast::FunctionDeclaration &node) const
+{
+    // clang-format off
+    struct Known {
+        std::string_view name;
+        std::array<std::string_view, 2> arguments;//<< all empty when the attribute takes none
+    };
+    static constexpr Known known[] = {
+        {"inline", {"always", "never"}},
+        {"memoize", {}},
+        {"export", {}},
+    };
+    // clang-format on
+
+    for (u64 i = 0; i < node.attributes.size(); ++i) {
+        const auto &attribute = node.attributes[i];
+        const auto it = std::find_if(std::begin(known), std::end(known), [&attribute](const Known &k) { return k.name == attribute.name; });
+
+        if (it == std::end(known)) {
+            throw exception::Error("SymbolTable::_check_attributes", "Unknown attribute '@", attribute.name, "' on function '", node.name,
+                "' in module: ", _module, " at ", attribute.line, ":", attribute.column);
+        }
+        if (std::find(it->arguments.begin(), it->arguments.end(), attribute.argument) == it->arguments.end()) {
+            throw exception::Error("SymbolTable::_check_attributes", "Invalid argument '", attribute.argument, "' for attribute '@",
+                attribute.name, "' in module: ", _module, " at ", attribute.line, ":", attribute.column);
+        }
+        for (u64 j = 0; j < i; ++j) {
+            if (node.attributes[j].name == attribute.name) {
+                throw exception::Error("SymbolTable::_check_attributes", "Duplicate attribute '@", attribute.name, "' in module: ", _module,
+                    " at ", attribute.line, ":", attribute.column);
+            }
+        }
+    }
+}
 
 inline void cplus::st::SymbolTable::_enter_scope()
 {
@@ -100,8 +142,10 @@ inline void cplus::st::SymbolTable::visit(ast::Module &node)
 
 inline void cplus::st::SymbolTable::visit(ast::FunctionDeclaration &node)
 {
+    _check_attributes(node);
+
     ast::TypePtr return_type =
-        node.return_type ? ast::make<ast::Type>(node.return_type->kind, node.return_type->name) : ast::make<ast::Type>(ast::Type::VOID);
+        node.return_type ? _context->make<ast::Type>(node.return_type->kind, node.return_type->name) : _context->make<ast::Type>(ast::Type::VOID);
 
     if (!_declare(std::string(node.name), st::Symbol::FUNCTION, std::move(return_type), false, node.line, node.column)) {
         throw exception::Error("SymbolTable::visit", "Function \"", node.name, "\" already declared in module: ", _module, " at ",
@@ -111,21 +155,21 @@ inline void cplus::st::SymbolTable::visit(ast::FunctionDeclaration &node)
     st::Symbol *func_sym = _lookup(std::string(node.name));
 
     if (!func_sym) {
-        _return_type_stack.emplace_back(ast::make<ast::Type>(ast::Type::VOID));
+        _return_type_stack.emplace_back(_context->make<ast::Type>(ast::Type::VOID));
     } else {
         for (const auto &param : node.parameters) {
             ast::TypePtr param_type =
-                param.type ? ast::make<ast::Type>(param.type->kind, param.type->name) : ast::make<ast::Type>(ast::Type::AUTO);
+                param.type ? _context->make<ast::Type>(param.type->kind, param.type->name) : _context->make<ast::Type>(ast::Type::AUTO);
             func_sym->param_types.push_back(std::move(param_type));
         }
-        _return_type_stack.emplace_back(ast::make<ast::Type>(func_sym->type->kind, func_sym->type->name));
+        _return_type_stack.emplace_back(_context->make<ast::Type>(func_sym->type->kind, func_sym->type->name));
     }
 
     _enter_scope();
 
     for (const auto &param : node.parameters) {
         ast::TypePtr param_type =
-            param.type ? ast::make<ast::Type>(param.type->kind, param.type->name) : ast::make<ast::Type>(ast::Type::AUTO);
+            param.type ? _context->make<ast::Type>(param.type->kind, param.type->name) : _context->make<ast::Type>(ast::Type::AUTO);
 
         if (!_declare(std::string(param.name), st::Symbol::PARAMETER, std::move(param_type), false)) {
             throw exception::Error("SymbolTable::visit", "Parameter '", param.name, "' already declared in function '", node.name,
@@ -147,12 +191,36 @@ inline void cplus::st::SymbolTable::visit(ast::FunctionDeclaration &node)
     _return_type_stack.pop_back();
 }
 
+/**
+ * @brief variable declaration
+ * @details `name = value;` on a local variable already in scope assigns it instead of shadowing it,
+ * so that branches and loop bodies can update the variables of their enclosing blocks
+ */
 inline void cplus::st::SymbolTable::visit(ast::VariableDeclaration &node)
 {
     ast::TypePtr var_type;
 
+    if (!node.declared_type && !node.is_const && node.initializer) {
+        const st::Symbol *symbol = _lookup(std::string(node.name));
+
+        if (symbol && symbol->kind != st::Symbol::FUNCTION && _scope_stack.front()->lookup_local(std::string(node.name)) != symbol) {
+            node.initializer->accept(*this);
+
+            if (symbol->is_const) {
+                throw exception::Error("SymbolTable::visit", "Assign to constant '", node.name, "' in module: ", _module, " at ", node.line,
+                    ":", node.column);
+            }
+            if (!_is_compatible(symbol->type.get(), node.initializer->type.get())) {
+                throw exception::Error("SymbolTable::visit", "Type mismatch in assignment to variable '", node.name, "' in module: ",
+                    _module, " at ", node.line, ":", node.column);
+            }
+            node.is_assignment = true;
+            return;
+        }
+    }
+
     if (node.declared_type) {
-        var_type = ast::make<ast::Type>(node.declared_type->kind, node.declared_type->name);
+        var_type = _context->make<ast::Type>(node.declared_type->kind, node.declared_type->name);
     } else if (node.initializer) {
         node.initializer->accept(*this);
         var_type = _infer_type(*node.initializer);
@@ -188,7 +256,7 @@ inline void cplus::st::SymbolTable::visit(ast::IdentifierExpression &node)
             node.column);
     }
 
-    node.type = ast::make<ast::Type>(symbol->type->kind, symbol->type->name);
+    node.type = _context->make<ast::Type>(symbol->type->kind, symbol->type->name);
 }
 
 inline void cplus::st::SymbolTable::visit(ast::BlockStatement &node)
@@ -226,7 +294,7 @@ inline void cplus::st::SymbolTable::visit(ast::BinaryExpression &node)
             node.column);
     }
 
-    node.type = ast::make<ast::Type>(left_type->kind, left_type->name);
+    node.type = _context->make<ast::Type>(left_type->kind, left_type->name);
 }
 
 inline void cplus::st::SymbolTable::visit(ast::UnaryExpression &node)
@@ -267,9 +335,9 @@ inline void cplus::st::SymbolTable::visit(ast::CallExpression &node)
     }
 
     if (sym->type) {
-        node.type = ast::make<ast::Type>(sym->type->kind, sym->type->name);
+        node.type = _context->make<ast::Type>(sym->type->kind, sym->type->name);
     } else {
-        node.type = ast::make<ast::Type>(ast::Type::AUTO);
+        node.type = _context->make<ast::Type>(ast::Type::AUTO);
     }
 }
 
@@ -291,7 +359,7 @@ inline void cplus::st::SymbolTable::visit(ast::AssignmentExpression &node)
             "' in module: ", _module, " at ", node.line, ":", node.column);
     }
 
-    node.type = ast::make<ast::Type>(dest->kind, dest->name);
+    node.type = _context->make<ast::Type>(dest->kind, dest->name);
 }
 
 inline void cplus::st::SymbolTable::visit(ast::ExpressionStatement &node)
@@ -358,6 +426,14 @@ inline void cplus::st::SymbolTable::visit(ast::ForStatement &node)
     _exit_scope();
 }
 
+inline void cplus::st::SymbolTable::visit(ast::WhileStatement &node)
+{
+    node.condition->accept(*this);
+    if (node.body) {
+        node.body->accept(*this);
+    }
+}
+
 inline void cplus::st::SymbolTable::visit(ast::ForeachStatement &node)
 {
     _enter_scope();
@@ -386,19 +462,21 @@ inline void cplus::st::SymbolTable::visit(ast::CaseStatement &node)
 {
     node.expression->accept(*this);
     for (const auto &clause : node.clauses) {
-        if (clause.value) {
-            clause.value->accept(*this);
+        for (const auto &value : clause.values) {
+            value->accept(*this);
         }
+        _enter_scope();
         for (const auto &stmt : clause.statements) {
             stmt->accept(*this);
         }
+        _exit_scope();
     }
 }
 
 cplus::ast::TypePtr cplus::st::SymbolTable::_infer_type(ast::Expression &expr)
 {
     if (expr.type) {
-        return ast::make<ast::Type>(expr.type->kind, expr.type->name);
+        return _context->make<ast::Type>(expr.type->kind, expr.type->name);
     }
 
     //TODO: find a better way
@@ -414,25 +492,25 @@ cplus::ast::TypePtr cplus::st::SymbolTable::_infer_type(ast::Expression &expr)
 
     if (const auto bin = dynamic_cast<ast::BinaryExpression *>(&expr)) {
         if (bin->left && bin->left->type) {
-            return ast::make<ast::Type>(bin->left->type->kind, bin->left->type->name);
+            return _context->make<ast::Type>(bin->left->type->kind, bin->left->type->name);
         }
     }
 
     if (const auto call = dynamic_cast<ast::CallExpression *>(&expr)) {
         const st::Symbol *sym = _lookup(std::string(call->function_name));
         if (sym && sym->kind == st::Symbol::FUNCTION && sym->type) {
-            return ast::make<ast::Type>(sym->type->kind, sym->type->name);
+            return _context->make<ast::Type>(sym->type->kind, sym->type->name);
         }
     }
 
     if (const auto ident = dynamic_cast<ast::IdentifierExpression *>(&expr)) {
         const st::Symbol *sym = _lookup(std::string(ident->name));
         if (sym && sym->type) {
-            return ast::make<ast::Type>(sym->type->kind, sym->type->name);
+            return _context->make<ast::Type>(sym->type->kind, sym->type->name);
         }
     }
 
-    return ast::make<ast::Type>(ast::Type::AUTO);
+    return _context->make<ast::Type>(ast::Type::AUTO);
 }
 
 inline bool cplus::st::SymbolTable::_is_compatible(const ast::Type *left, const ast::Type *right)
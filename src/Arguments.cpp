@@ -4,11 +4,20 @@
 #include <CPlus/Macros.hpp>
 #include <CPlus/Types.hpp>
 
+#include <algorithm>
+#include <charconv>
 #include <sys/stat.h>
+#include <thread>
 
 int cplus::cplus_flags = 0;
+cplus::OptLevel cplus::cplus_opt_level = cplus::OPT_O2;
 std::vector<cplus::cstr> cplus::cplus_input_files;
+std::vector<cplus::cstr> cplus::cplus_link_objects;
 cplus::cstr cplus::cplus_output_file = "out.bin";
+cplus::u32 cplus::cplus_jobs = 1;
+cplus::cstr cplus::cplus_cache_dir = nullptr;
+cplus::u64 cplus::cplus_cache_size = 256ull << 20;
+cplus::cstr cplus::cplus_time_report = nullptr;
 
 static constexpr auto bold = cplus::logger::CPLUS_BOLD;
 static constexpr auto reset = cplus::logger::CPLUS_RESET;
@@ -22,9 +31,9 @@ constexpr auto print_option = [](const std::string &flags, const std::string &de
     std::cout << "  " << yellow << flags << reset << gray << "   " << description << reset << std::endl;
 };
 
-static constexpr inline void usage()
+static inline void usage()
 {
-    std::cout << bold << "USAGE: " << reset << green << "cplus " << reset << yellow << "[options] " << reset << blue << "<input.cp>"
+    std::cout << bold << "USAGE: " << reset << green << "cplus " << reset << yellow << "[options] " << reset << blue << "<input.cp> [runtime.o]"
               << reset << std::endl
               << std::endl
               << bold << "OPTIONS:" << reset << std::endl;
@@ -32,15 +41,26 @@ static constexpr inline void usage()
     print_option("-v,  --version", "    Show version information");
     print_option("-help, --help", "     Show this help message");
     print_option("-o,  --output", "     Output file");
+    print_option("-j,  --jobs", "       Number of files compiled in parallel (0 = all cores)");
     print_option("-t,  --show-tokens", "Show Tokens");
     print_option("-a,  --show-ast", "   Show AST");
     print_option("-i,  --show-ir", "    Show IR");
+    print_option("-S,  --emit-asm", "   Also write the generated assembly to <input>.s");
+    print_option("-c,  --emit-obj", "   Also write the object file to <input>.o");
+    print_option("-O<0|1|2|3|s>", "     Optimization level: none, basic, speed, aggressive speed or size (default: -O2)");
+    print_option("-fauto-memoize", "    Cache the results of pure recursive functions, as if marked @memoize");
+    print_option("--no-cache", "        Always recompile, bypassing the compilation cache");
+    print_option("--cache-dir", "       Cache directory (default: $CPLUS_CACHE_DIR or ~/.cache/cplus)");
+    print_option("--cache-size", "      Cache size limit in MiB (default: 256)");
+    print_option("--cache-stats", "     Show cache hit/miss statistics");
+    print_option("--time-passes", "     Show the wall and CPU time of every pass, per file and in total");
+    print_option("--time-passes-json", "Also write the pass timings as JSON to <file>");
 
     std::cout << std::endl;
     std::exit(CPLUS_SUCCESS);
 }
 
-static constexpr inline void version()
+static inline void version()
 {
     std::cout << bold << "CPlus " << reset << "v." << CPLUS_VERSION << std::endl
               << "Not C, not C++, just " << red_bold << "C+" << reset << std::endl
@@ -48,7 +68,7 @@ static constexpr inline void version()
     std::exit(CPLUS_SUCCESS);
 }
 
-static constexpr inline void output(cplus::cstr filename)
+static inline void output(cplus::cstr filename)
 {
     static bool output_set = false;
 
@@ -60,7 +80,44 @@ static constexpr inline void output(cplus::cstr filename)
     output_set = true;
 }
 
-static constexpr inline void input(cplus::cstr filename)
+/**
+ * @brief jobs
+ * @details parses the worker count of -j, 0 means one worker per hardware thread
+ */
+static inline void jobs(const std::string_view value)
+{
+    cplus::u32 count = 0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+
+    if (ec != std::errc() || end != value.data() + value.size()) {
+        throw cplus::exception::Error("cplus::Arguments", "Invalid job count: ", value);
+    }
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    cplus::cplus_jobs = count;
+}
+
+/**
+ * @brief cache size
+ * @details parses the cache limit of --cache-size, in MiB
+ */
+static inline void cache_size(const std::string_view value)
+{
+    cplus::u64 size = 0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), size);
+
+    if (ec != std::errc() || end != value.data() + value.size() || size > (~0ull >> 20)) {
+        throw cplus::exception::Error("cplus::Arguments", "Invalid cache size: ", value);
+    }
+    cplus::cplus_cache_size = size << 20;
+}
+
+/**
+ * @brief input
+ * @details `.o` files are prebuilt objects handed to the linker, everything else is compiled
+ */
+static inline void input(cplus::cstr filename)
 {
     struct stat st;
 
@@ -70,7 +127,11 @@ static constexpr inline void input(cplus::cstr filename)
     if (!S_ISREG(st.st_mode)) {
         throw cplus::exception::Error("cplus::Arguments", "Input file is not a regular file: ", filename);
     }
-    cplus::cplus_input_files.push_back(filename);
+    if (std::string_view(filename).ends_with(".o")) {
+        cplus::cplus_link_objects.push_back(filename);
+    } else {
+        cplus::cplus_input_files.push_back(filename);
+    }
 }
 
 // clang-format off
@@ -91,7 +152,20 @@ static constexpr FlagEntry _flag_entries[] = {
     {"-a", []() { cplus::cplus_flags |= cplus::Flags::FLAG_SHOW_AST; }},
     {"--show-ast", []() { cplus::cplus_flags |= cplus::Flags::FLAG_SHOW_AST; }},
     {"-i", []() { cplus::cplus_flags |= cplus::Flags::FLAG_SHOW_IR; }},
-    {"--show-ir", []() { cplus::cplus_flags |= cplus::Flags::FLAG_SHOW_IR; }}
+    {"--show-ir", []() { cplus::cplus_flags |= cplus::Flags::FLAG_SHOW_IR; }},
+    {"-S", []() { cplus::cplus_flags |= cplus::Flags::FLAG_EMIT_ASM; }},
+    {"--emit-asm", []() { cplus::cplus_flags |= cplus::Flags::FLAG_EMIT_ASM; }},
+    {"-c", []() { cplus::cplus_flags |= cplus::Flags::FLAG_EMIT_OBJ; }},
+    {"--emit-obj", []() { cplus::cplus_flags |= cplus::Flags::FLAG_EMIT_OBJ; }},
+    {"--no-cache", []() { cplus::cplus_flags |= cplus::Flags::FLAG_NO_CACHE; }},
+    {"--cache-stats", []() { cplus::cplus_flags |= cplus::Flags::FLAG_CACHE_STATS; }},
+    {"--time-passes", []() { cplus::cplus_flags |= cplus::Flags::FLAG_TIME_PASSES; }},
+    {"-O0", []() { cplus::cplus_opt_level = cplus::OPT_O0; }},
+    {"-O1", []() { cplus::cplus_opt_level = cplus::OPT_O1; }},
+    {"-O2", []() { cplus::cplus_opt_level = cplus::OPT_O2; }},
+    {"-O3", []() { cplus::cplus_opt_level = cplus::OPT_O3; }},
+    {"-Os", []() { cplus::cplus_opt_level = cplus::OPT_OS; }},
+    {"-fauto-memoize", []() { cplus::cplus_flags |= cplus::Flags::FLAG_AUTO_MEMOIZE; }}
 };
 // clang-format on
 
@@ -115,6 +189,42 @@ void cplus::arguments(const i32 argc, const char **argv)
 
                 output(argv[++i]);
 
+            } else if (arg == "-j" || arg == "--jobs") {
+
+                if (i + 1 >= argc) {
+                    throw cplus::exception::Error("cplus::Arguments", "Missing job count after ", arg);
+                }
+
+                jobs(argv[++i]);
+
+            } else if (arg == "--cache-dir") {
+
+                if (i + 1 >= argc) {
+                    throw cplus::exception::Error("cplus::Arguments", "Missing directory after ", arg);
+                }
+
+                cplus_cache_dir = argv[++i];
+
+            } else if (arg == "--cache-size") {
+
+                if (i + 1 >= argc) {
+                    throw cplus::exception::Error("cplus::Arguments", "Missing size after ", arg);
+                }
+
+                cache_size(argv[++i]);
+
+            } else if (arg == "--time-passes-json") {
+
+                if (i + 1 >= argc) {
+                    throw cplus::exception::Error("cplus::Arguments", "Missing file after ", arg);
+                }
+
+                cplus_time_report = argv[++i];
+                cplus_flags |= FLAG_TIME_PASSES;
+
+            } else if (arg.starts_with("-j")) {
+                jobs(std::string_view(arg).substr(2));
+
             } else {
                 throw cplus::exception::Error("cplus::Arguments", "Unknown argument: ", arg);
             }
@@ -124,7 +234,7 @@ void cplus::arguments(const i32 argc, const char **argv)
         }
     }
 
-    if (cplus_input_files.empty()) {
+    if (cplus_input_files.empty() && cplus_link_objects.empty()) {
         throw cplus::exception::Error("cplus::Arguments", "No input files provided");
     }
 }
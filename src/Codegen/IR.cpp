@@ -0,0 +1,253 @@
+#include <CPlus/Codegen/IR.hpp>
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * public
+ */
+
+cplus::cstr cplus::ir::to_string(const Opcode opcode)
+{
+    switch (opcode) {
+        case Opcode::ARG:
+            return "arg";
+        case Opcode::MOV:
+            return "mov";
+        case Opcode::UNDEF:
+            return "undef";
+        case Opcode::ADD:
+            return "add";
+        case Opcode::SUB:
+            return "sub";
+        case Opcode::MUL:
+            return "mul";
+        case Opcode::SDIV:
+            return "sdiv";
+        case Opcode::SREM:
+            return "srem";
+        case Opcode::AND:
+            return "and";
+        case Opcode::OR:
+            return "or";
+        case Opcode::NEG:
+            return "neg";
+        case Opcode::ICMP_EQ:
+            return "icmp.eq";
+        case Opcode::ICMP_NE:
+            return "icmp.ne";
+        case Opcode::ICMP_SLT:
+            return "icmp.slt";
+        case Opcode::ICMP_SLE:
+            return "icmp.sle";
+        case Opcode::ICMP_SGT:
+            return "icmp.sgt";
+        case Opcode::ICMP_SGE:
+            return "icmp.sge";
+        case Opcode::LOAD:
+            return "load";
+        case Opcode::STORE:
+            return "store";
+        case Opcode::CALL:
+            return "call";
+        case Opcode::PHI:
+            return "phi";
+        case Opcode::BR:
+        case Opcode::JMP:
+            return "br";
+        case Opcode::SWITCH:
+            return "switch";
+        case Opcode::RET:
+            return "ret";
+        default:
+            return "op_unknown";
+    }
+}
+
+std::optional<cplus::i32> cplus::ir::fold(const Opcode opcode, const i32 a, const i32 b)
+{
+    const u32 ua = static_cast<u32>(a);
+    const u32 ub = static_cast<u32>(b);
+
+    switch (opcode) {
+        case Opcode::ADD:
+            return static_cast<i32>(ua + ub);
+        case Opcode::SUB:
+            return static_cast<i32>(ua - ub);
+        case Opcode::MUL:
+            return static_cast<i32>(ua * ub);
+        case Opcode::SDIV:
+        case Opcode::SREM:
+            if (b == 0 || (a == std::numeric_limits<i32>::min() && b == -1)) {
+                return std::nullopt;
+            }
+            return opcode == Opcode::SDIV ? a / b : a % b;
+        case Opcode::AND:
+            return a & b;
+        case Opcode::OR:
+            return a | b;
+        case Opcode::NEG:
+            return static_cast<i32>(0u - ua);
+        case Opcode::ICMP_EQ:
+            return a == b;
+        case Opcode::ICMP_NE:
+            return a != b;
+        case Opcode::ICMP_SLT:
+            return a < b;
+        case Opcode::ICMP_SLE:
+            return a <= b;
+        case Opcode::ICMP_SGT:
+            return a > b;
+        case Opcode::ICMP_SGE:
+            return a >= b;
+        default:
+            return std::nullopt;
+    }
+}
+
+std::vector<cplus::ir::BlockId> cplus::ir::successors(const BasicBlock &block)
+{
+    std::vector<BlockId> result;
+
+    if (block.instructions.empty() || !is_terminator(block.instructions.back().opcode)) {
+        return result;
+    }
+
+    for (const auto &operand : block.instructions.back().operands) {
+        if (operand.kind == Operand::BLOCK && std::find(result.begin(), result.end(), operand.id()) == result.end()) {
+            result.push_back(operand.id());
+        }
+    }
+    return result;
+}
+
+/**
+ * helpers
+ */
+
+static void _dump_label(const cplus::ir::Function &function, const cplus::ir::BlockId id, std::ostream &out)
+{
+    const auto &block = function.blocks[id];
+
+    out << "%" << block.name << block.label;
+}
+
+static void _dump_operand(const cplus::ir::Module &module, const cplus::ir::Function &function, const cplus::ir::Operand &operand,
+    std::ostream &out)
+{
+    switch (operand.kind) {
+        case cplus::ir::Operand::VALUE:
+            out << "%" << operand.data;
+            break;
+        case cplus::ir::Operand::IMMEDIATE:
+            out << operand.data;
+            break;
+        case cplus::ir::Operand::STRING:
+            out << "const.str \"" << module.strings[operand.id()] << "\"";
+            break;
+        case cplus::ir::Operand::BLOCK:
+            _dump_label(function, operand.id(), out);
+            break;
+        case cplus::ir::Operand::GLOBAL:
+            out << "@" << module.globals[operand.id()].name;
+            break;
+        case cplus::ir::Operand::NONE:
+        default:
+            out << "none";
+            break;
+    }
+}
+
+static void _dump_instruction(const cplus::ir::Module &module, const cplus::ir::Function &function,
+    const cplus::ir::Instruction &instruction, std::ostream &out)
+{
+    const auto &operands = instruction.operands;
+
+    out << "  ";
+    if (instruction.result != cplus::ir::INVALID_ID) {
+        out << "%" << instruction.result << " = ";
+    }
+    out << cplus::ir::to_string(instruction.opcode);
+
+    switch (instruction.opcode) {
+        case cplus::ir::Opcode::CALL:
+            out << " @" << module.functions[instruction.callee].name << "(";
+            for (cplus::u64 i = 0; i < operands.size(); ++i) {
+                out << (i ? ", " : "");
+                _dump_operand(module, function, operands[i], out);
+            }
+            out << ")";
+            break;
+
+        case cplus::ir::Opcode::PHI:
+            for (cplus::u64 i = 0; i + 1 < operands.size(); i += 2) {
+                out << (i ? ", [" : " [");
+                _dump_operand(module, function, operands[i], out);
+                out << ", ";
+                _dump_operand(module, function, operands[i + 1], out);
+                out << "]";
+            }
+            break;
+
+        case cplus::ir::Opcode::SWITCH:
+            out << " ";
+            _dump_operand(module, function, operands[0], out);
+            out << ", ";
+            _dump_operand(module, function, operands[1], out);
+            for (cplus::u64 i = 2; i + 1 < operands.size(); i += 2) {
+                out << (i == 2 ? " [" : ", [") << operands[i].data << ", ";
+                _dump_operand(module, function, operands[i + 1], out);
+                out << "]";
+            }
+            break;
+
+        default:
+            for (cplus::u64 i = 0; i < operands.size(); ++i) {
+                out << (i ? ", " : " ");
+                _dump_operand(module, function, operands[i], out);
+            }
+            break;
+    }
+    out << std::endl;
+}
+
+void cplus::ir::dump(const Module &module, std::ostream &out, const std::vector<std::string> &annotations)
+{
+    out << "; C+ generated IR for module " << module.name << std::endl;
+
+    for (const auto &global : module.globals) {
+        out << "global @" << global.name << " [" << global.size << "]" << std::endl;
+    }
+
+    for (FunctionId f = 0; f < module.functions.size(); ++f) {
+        const Function &function = module.functions[f];
+
+        out << "func @" << function.name << "(" << function.parameters << ") -> " << ast::to_string(function.return_type);
+        if (function.inline_hint != Function::Inline::DEFAULT) {
+            out << (function.inline_hint == Function::Inline::ALWAYS ? " inline(always)" : " inline(never)");
+        }
+        if (function.memoize) {
+            out << " memoize";
+        }
+        if (function.exported) {
+            out << " export";
+        }
+        if (f < annotations.size()) {
+            out << " " << annotations[f];
+        }
+        out << std::endl << "{" << std::endl;
+
+        for (u64 i = 0; i < function.blocks.size(); ++i) {
+            if (i) {
+                out << "label ";
+                _dump_label(function, static_cast<BlockId>(i), out);
+                out << ":" << std::endl;
+            }
+            for (const auto &instruction : function.blocks[i].instructions) {
+                _dump_instruction(module, function, instruction, out);
+            }
+        }
+
+        out << "}" << std::endl;
+    }
+}
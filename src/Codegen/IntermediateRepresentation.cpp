@@ -2,25 +2,26 @@
 #include <CPlus/Codegen/IntermediateRepresentation.hpp>
 #include <CPlus/Logger.hpp>
 
+#include <algorithm>
+#include <bit>
 #include <unordered_set>
 
 /**
  * public
  */
 
-const std::string cplus::ir::IntermediateRepresentation::run(const std::unique_ptr<ast::Module> &module)
+cplus::ir::Module cplus::ir::IntermediateRepresentation::run(const std::unique_ptr<ast::Module> &module)
 {
-    _temp_counter = 0;
-    _label_counter = 0;
-    _output.clear();
-    _last_value.clear();
-    _current_function.clear();
+    _module = Module{};
+    _module.name = module->name;
+    _function = nullptr;
+    _last_value = {};
     _value_map_stack.clear();
+    _function_ids.clear();
 
     logger::info("Generating IR for module " + module->name);
 
     _push();
-    _emit("; C+ generated IR for module " + module->name);
     module->accept(*this);
     _pop();
 
@@ -28,62 +29,48 @@ const std::string cplus::ir::IntermediateRepresentation::run(const std::unique_p
         throw exception::Error("IntermediateRepresentation::run", "value map stack not empty after processing module");
     }
 
-    return _output;
+    if (cplus_flags & FLAG_SHOW_IR) {
+        dump(_module, *logger::sink);
+    }
+
+    return std::move(_module);
 }
 
 /**
  * helpers
  */
 
-static inline constexpr cplus::cstr binary_op_to_string(const cplus::ast::BinaryExpression::Operator op)
+static inline constexpr cplus::ir::Opcode binary_op_to_opcode(const cplus::ast::BinaryExpression::Operator op)
 {
     switch (op) {
         case cplus::ast::BinaryExpression::ADD:
-            return "add";
+            return cplus::ir::Opcode::ADD;
         case cplus::ast::BinaryExpression::SUB:
-            return "sub";
+            return cplus::ir::Opcode::SUB;
         case cplus::ast::BinaryExpression::MUL:
-            return "mul";
+            return cplus::ir::Opcode::MUL;
         case cplus::ast::BinaryExpression::DIV:
-            return "sdiv";
+            return cplus::ir::Opcode::SDIV;
         case cplus::ast::BinaryExpression::MOD:
-            return "srem";
+            return cplus::ir::Opcode::SREM;
         case cplus::ast::BinaryExpression::EQ:
-            return "icmp.eq";
+            return cplus::ir::Opcode::ICMP_EQ;
         case cplus::ast::BinaryExpression::NEQ:
-            return "icmp.ne";
+            return cplus::ir::Opcode::ICMP_NE;
         case cplus::ast::BinaryExpression::LT:
-            return "icmp.slt";
+            return cplus::ir::Opcode::ICMP_SLT;
         case cplus::ast::BinaryExpression::LTE:
-            return "icmp.sle";
+            return cplus::ir::Opcode::ICMP_SLE;
         case cplus::ast::BinaryExpression::GT:
-            return "icmp.sgt";
+            return cplus::ir::Opcode::ICMP_SGT;
         case cplus::ast::BinaryExpression::GTE:
-            return "icmp.sge";
+            return cplus::ir::Opcode::ICMP_SGE;
         case cplus::ast::BinaryExpression::AND:
-            return "and";
+            return cplus::ir::Opcode::AND;
         case cplus::ast::BinaryExpression::OR:
-            return "or";
+            return cplus::ir::Opcode::OR;
         default:
-            return "op_unknown";
-    }
-}
-
-static inline constexpr cplus::cstr unary_op_to_string(const cplus::ast::UnaryExpression::Operator op)
-{
-    switch (op) {
-        case cplus::ast::UnaryExpression::NOT:
-            return "not";
-        case cplus::ast::UnaryExpression::NEGATE:
-            return "neg";
-        case cplus::ast::UnaryExpression::PLUS:
-            return "plus";
-        case cplus::ast::UnaryExpression::INC:
-            return "inc";
-        case cplus::ast::UnaryExpression::DEC:
-            return "dec";
-        default:
-            return "unary_unknown";
+            throw cplus::exception::Error("IntermediateRepresentation", "unknown binary operator");
     }
 }
 
@@ -91,47 +78,90 @@ static inline constexpr cplus::cstr unary_op_to_string(const cplus::ast::UnaryEx
 * private
 */
 
-void cplus::ir::IntermediateRepresentation::_emit(const std::string &s)
+cplus::ir::ValueId cplus::ir::IntermediateRepresentation::_emit(const Opcode opcode, std::vector<Operand> operands, const bool has_result)
 {
-    if (cplus_flags & FLAG_SHOW_IR) {
-        std::cout << s << std::endl;
+    const ValueId result = has_result ? _function->new_value() : INVALID_ID;
+
+    _emit(Instruction{.opcode = opcode, .result = result, .operands = std::move(operands)});
+    return result;
+}
+
+/**
+ * @brief emit
+ * @note code following a terminator (e.g. statements after a return) is moved to a fresh unreachable block
+ */
+void cplus::ir::IntermediateRepresentation::_emit(Instruction instruction)
+{
+    if (_is_terminated()) {
+        _set_block(_new_block("dead"));
     }
+    _function->blocks[_block].instructions.push_back(std::move(instruction));
+}
+
+bool cplus::ir::IntermediateRepresentation::_is_terminated() const
+{
+    const auto &instructions = _function->blocks[_block].instructions;
 
-    _output += s;
-    _output += '\n';
+    return !instructions.empty() && is_terminator(instructions.back().opcode);
 }
 
-std::string cplus::ir::IntermediateRepresentation::_new_temp(const std::string &hint)
+cplus::ir::BlockId cplus::ir::IntermediateRepresentation::_new_block(cstr name)
 {
-    return "%" + hint + std::to_string(_temp_counter++);
+    const BlockId id = static_cast<BlockId>(_function->blocks.size());
+
+    _function->blocks.push_back(BasicBlock{.name = name, .label = _module.labels++, .instructions = {}});
+    return id;
 }
 
-std::string cplus::ir::IntermediateRepresentation::_new_label(const std::string &hint)
+void cplus::ir::IntermediateRepresentation::_set_block(const BlockId block)
 {
-    return hint + std::to_string(_label_counter++);
+    _block = block;
+    _block_order.push_back(block);
 }
 
 /**
- * scopes
+ * @brief layout blocks
+ * @details blocks are created before their content is known (branch targets), this reorders them
+ * in the order they were filled so that fallthroughs match the source order
  */
-
-inline std::unordered_map<std::string, std::string> &cplus::ir::IntermediateRepresentation::_current_map()
+void cplus::ir::IntermediateRepresentation::_layout_blocks()
 {
-    if (_value_map_stack.empty()) {
-        _value_map_stack.emplace_back();
+    const u64 count = _function->blocks.size();
+    std::vector<BlockId> remap(count, INVALID_ID);
+    std::vector<BasicBlock> blocks;
+    blocks.reserve(count);
+
+    for (const BlockId id : _block_order) {
+        if (remap[id] == INVALID_ID) {
+            remap[id] = static_cast<BlockId>(blocks.size());
+            blocks.push_back(std::move(_function->blocks[id]));
+        }
+    }
+    for (u64 id = 0; id < count; ++id) {
+        if (remap[id] == INVALID_ID) {
+            remap[id] = static_cast<BlockId>(blocks.size());
+            blocks.push_back(std::move(_function->blocks[id]));
+        }
     }
-    return _value_map_stack.back();
-}
 
-inline void cplus::ir::IntermediateRepresentation::_push_copy()
-{
-    if (_value_map_stack.empty()) {
-        _value_map_stack.emplace_back();
-    } else {
-        _value_map_stack.push_back(_current_map());
+    for (auto &block : blocks) {
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.kind == Operand::BLOCK) {
+                    operand.data = remap[operand.id()];
+                }
+            }
+        }
     }
+
+    _function->blocks = std::move(blocks);
+    _block_order.clear();
 }
 
+/**
+ * scopes
+ */
+
 inline void cplus::ir::IntermediateRepresentation::_push()
 {
     _value_map_stack.emplace_back();
@@ -144,24 +174,205 @@ inline void cplus::ir::IntermediateRepresentation::_pop()
     }
 }
 
-std::string cplus::ir::IntermediateRepresentation::_lookup(const std::string &name) const
+cplus::ir::Operand cplus::ir::IntermediateRepresentation::_lookup(const std::string_view &name) const
 {
     for (auto it = _value_map_stack.rbegin(); it != _value_map_stack.rend(); ++it) {
-        const auto &m = *it;
-        const auto found = m.find(name);
+        const auto found = it->find(name);
 
-        if (found != m.end()) {
+        if (found != it->end()) {
             return found->second;
         }
     }
 
     /** @brief should never happen bc of semantic analysis (../Analysis/SymbolTable.cpp) */
-    return name;
+    throw exception::Error("IntermediateRepresentation::_lookup", "unknown identifier ", name, " in module ", _module.name);
+}
+
+inline void cplus::ir::IntermediateRepresentation::_declare(const std::string_view &name, const Operand &value)
+{
+    _value_map_stack.back()[name] = value;
 }
 
-inline void cplus::ir::IntermediateRepresentation::_set_name(const std::string &name, const std::string &ssa)
+/**
+ * @brief assign
+ * @note rebinds the variable in the scope that declared it, so that assignments inside nested blocks stay visible
+ */
+void cplus::ir::IntermediateRepresentation::_assign(const std::string_view &name, const Operand &value)
 {
-    _current_map()[name] = ssa;
+    for (auto it = _value_map_stack.rbegin(); it != _value_map_stack.rend(); ++it) {
+        const auto found = it->find(name);
+
+        if (found != it->end()) {
+            found->second = value;
+            return;
+        }
+    }
+    _declare(name, value);
+}
+
+/**
+ * @brief loop
+ * @details lowers a loop to its rotated, bottom-tested form: the condition is tested once before entering the loop
+ * and then at the bottom of each iteration, so that an iteration runs a single conditional branch
+ *
+ * guard:       br cond, loop.header, loop.exit
+ * loop.header: %v = phi [entry value, guard], [latch value, loop.latch] (one per loop-carried variable)
+ * loop.body:   ...
+ * loop.latch:  increment, br cond, loop.header, loop.exit
+ * loop.exit:   %v = phi [entry value, guard], [latch value, loop.latch] (one per variable the loop changed)
+ *
+ * every visible variable gets a header phi before the body is lowered (the body may assign any of them),
+ * the phis of the variables the loop leaves unchanged are then folded back into their entry value
+ */
+void cplus::ir::IntermediateRepresentation::_loop(ast::Expression *condition, ast::Statement *body, ast::Expression *increment)
+{
+    // clang-format off
+    struct Carried {
+        u64 depth;
+        std::string_view name;
+        Operand entry;
+        Operand latch;
+        ValueId phi;
+    };
+    // clang-format on
+
+    const BlockId header = _new_block("loop.header");
+    const BlockId body_block = _new_block("loop.body");
+    const BlockId exit = _new_block("loop.exit");
+    std::vector<Carried> carried;
+    std::unordered_map<ValueId, Operand> trivial;
+    bool always_taken = true;//<< no condition or a constant true one, only the latch reaches the exit
+
+    /** @brief the condition is emitted twice, in the guard and in the latch */
+    const auto test = [&]() {
+        if (condition) {
+            condition->accept(*this);
+            const Operand cond = _last_value;
+            _last_value = {};
+
+            if (!cond.is_immediate() || cond.data == 0) {
+                _emit(Opcode::BR, {cond, Operand::block(header), Operand::block(exit)}, false);
+                always_taken = false;
+                return;
+            }
+        }
+        _emit(Opcode::JMP, {Operand::block(header)}, false);
+    };
+    const auto resolve = [&trivial](Operand operand) {
+        while (operand.is_value()) {
+            const auto it = trivial.find(operand.id());
+
+            if (it == trivial.end()) {
+                break;
+            }
+            operand = it->second;
+        }
+        return operand;
+    };
+
+    test();
+    const BlockId guard = _block;
+    const std::vector<ValueMap> entry_maps = _value_map_stack;
+
+    /** @brief module constants are immediates and can not be reassigned, every local variable is a value */
+    _set_block(header);
+    for (u64 depth = 0; depth < entry_maps.size(); ++depth) {
+        for (const auto &[name, value] : entry_maps[depth]) {
+            if (value.is_value()) {
+                const ValueId phi = _emit(Opcode::PHI, {value, Operand::block(guard)});
+
+                carried.push_back({.depth = depth, .name = name, .entry = value, .latch = value, .phi = phi});
+                _value_map_stack[depth][name] = Operand::value(phi);
+            }
+        }
+    }
+    _emit(Opcode::JMP, {Operand::block(body_block)}, false);
+
+    _set_block(body_block);
+    if (body) {
+        body->accept(*this);
+    }
+
+    /** @brief the latch is only lowered when the body can fall through to it */
+    const bool has_latch = !_is_terminated();
+
+    if (has_latch) {
+        const BlockId latch = _new_block("loop.latch");
+
+        _emit(Opcode::JMP, {Operand::block(latch)}, false);
+        _set_block(latch);
+        if (increment) {
+            increment->accept(*this);
+            _last_value = {};
+        }
+        test();
+
+        for (auto &variable : carried) {
+            variable.latch = _value_map_stack[variable.depth].at(variable.name);
+        }
+    }
+    const BlockId latch_end = _block;
+
+    /** @brief a phi is trivial when the loop gives it back itself or its entry value */
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const auto &variable : carried) {
+            if (trivial.contains(variable.phi)) {
+                continue;
+            }
+
+            const Operand latch_value = resolve(variable.latch);
+
+            if (latch_value == Operand::value(variable.phi) || latch_value == variable.entry) {
+                trivial[variable.phi] = variable.entry;
+                changed = true;
+            }
+        }
+    }
+
+    /** @brief only blocks created by the loop can use its phis */
+    if (!trivial.empty()) {
+        for (BlockId b = header; b < _function->blocks.size(); ++b) {
+            for (auto &instruction : _function->blocks[b].instructions) {
+                for (auto &operand : instruction.operands) {
+                    operand = resolve(operand);
+                }
+            }
+        }
+        std::erase_if(_function->blocks[header].instructions,
+            [&trivial](const Instruction &instruction) { return instruction.opcode == Opcode::PHI && trivial.contains(instruction.result); });
+    }
+    for (auto &instruction : _function->blocks[header].instructions) {
+        if (instruction.opcode != Opcode::PHI) {
+            continue;
+        }
+        for (const auto &variable : carried) {
+            if (variable.phi == instruction.result) {
+                instruction.operands.push_back(resolve(variable.latch));
+                instruction.operands.push_back(Operand::block(latch_end));
+                break;
+            }
+        }
+    }
+
+    /** @brief the exit is reached from the guard with the entry values, and from the latch with the latch values */
+    _value_map_stack = entry_maps;
+    _set_block(exit);
+    for (const auto &variable : carried) {
+        if (trivial.contains(variable.phi)) {
+            continue;
+        }
+
+        const Operand latch_value = resolve(variable.latch);
+
+        if (always_taken) {
+            _value_map_stack[variable.depth][variable.name] = latch_value;
+        } else {
+            const ValueId phi = _emit(Opcode::PHI, {variable.entry, Operand::block(guard), latch_value, Operand::block(latch_end)});
+
+            _value_map_stack[variable.depth][variable.name] = Operand::value(phi);
+        }
+    }
 }
 
 /**
@@ -175,17 +386,21 @@ inline void cplus::ir::IntermediateRepresentation::_set_name(const std::string &
 void cplus::ir::IntermediateRepresentation::visit(ast::LiteralExpression &node)
 {
     if (std::holds_alternative<i32>(node.value)) {
-        const auto v = std::get<i32>(node.value);
-        _last_value = "imm.i32 " + std::to_string(v);
+        _last_value = Operand::immediate(std::get<i32>(node.value));
 
     } else if (std::holds_alternative<f32>(node.value)) {
-        _last_value = "imm.f32 " + std::to_string(std::get<f32>(node.value));
+        /** @brief the backend is integer only, floats are carried as their bit pattern */
+        _last_value = Operand::immediate(std::bit_cast<i32>(std::get<f32>(node.value)));
 
     } else if (std::holds_alternative<std::string_view>(node.value)) {
-        _last_value = "const.str \"" + std::string(std::get<std::string_view>(node.value)) + "\"";
+        const std::string_view lexeme = std::get<std::string_view>(node.value);
+
+        /** @brief strip the surrounding quotes, escapes are kept as written */
+        _module.strings.emplace_back(lexeme.substr(1, lexeme.size() - 2));
+        _last_value = Operand::string(static_cast<u32>(_module.strings.size() - 1));
 
     } else if (std::holds_alternative<bool>(node.value)) {
-        _last_value = (std::get<bool>(node.value) ? "imm.bool 1" : "imm.bool 0");
+        _last_value = Operand::immediate(std::get<bool>(node.value) ? 1 : 0);
     }
 }
 
@@ -195,25 +410,26 @@ void cplus::ir::IntermediateRepresentation::visit(ast::LiteralExpression &node)
  */
 void cplus::ir::IntermediateRepresentation::visit(ast::IdentifierExpression &node)
 {
-    const std::string name(node.name);
-    const std::string found = _lookup(name);
-
-    _last_value = found;
+    _last_value = _lookup(node.name);
 }
 
 void cplus::ir::IntermediateRepresentation::visit(ast::BinaryExpression &node)
 {
     node.left->accept(*this);
-    const std::string left = _last_value;
+    const Operand left = _last_value;
 
     node.right->accept(*this);
-    const std::string right = _last_value;
-
-    const std::string op = binary_op_to_string(node.op);
-    const std::string tmp = _new_temp("t");
-
-    _emit("  " + tmp + " = " + op + " " + left + ", " + right);
-    _last_value = tmp;
+    const Operand right = _last_value;
+    const Opcode opcode = binary_op_to_opcode(node.op);
+
+    /** @brief constant operands fold here so that `(0 - 1)` or `K + 1` stay usable as case values */
+    if (left.is_immediate() && right.is_immediate()) {
+        if (const auto value = fold(opcode, static_cast<i32>(left.data), static_cast<i32>(right.data))) {
+            _last_value = Operand::immediate(*value);
+            return;
+        }
+    }
+    _last_value = Operand::value(_emit(opcode, {left, right}));
 }
 
 /**
@@ -222,45 +438,41 @@ void cplus::ir::IntermediateRepresentation::visit(ast::BinaryExpression &node)
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::UnaryExpression &node)
 {
-    const bool operand_is_ident = dynamic_cast<ast::IdentifierExpression *>(node.operand.get()) != nullptr;
-    std::string ident_name;
-
-    if (operand_is_ident) {
-        const auto *ident = dynamic_cast<ast::IdentifierExpression *>(node.operand.get());
-
-        if (ident) {
-            ident_name = std::string(ident->name);
-        }
-    }
+    const auto *ident = dynamic_cast<ast::IdentifierExpression *>(node.operand.get());
 
     node.operand->accept(*this);
-    const std::string src = _last_value;
-    const std::string tmp = _new_temp("u");
+    const Operand src = _last_value;
+    ValueId tmp = INVALID_ID;
 
     switch (node.op) {
         case ast::UnaryExpression::NOT:
-            _emit("  " + tmp + " = icmp.eq " + src + ", const." + ast::to_string(node.type->kind) + "0");
+            tmp = _emit(Opcode::ICMP_EQ, {src, Operand::immediate(0)});
             break;
         case ast::UnaryExpression::NEGATE:
-            _emit("  " + tmp + " = neg " + src);
+            if (const auto value = src.is_immediate() ? fold(Opcode::NEG, static_cast<i32>(src.data), 0) : std::nullopt) {
+                _last_value = Operand::immediate(*value);
+                return;
+            }
+            tmp = _emit(Opcode::NEG, {src});
             break;
         case ast::UnaryExpression::INC:
-            _emit("  " + tmp + " = add " + src + ", const." + ast::to_string(node.type->kind) + "1");
+            tmp = _emit(Opcode::ADD, {src, Operand::immediate(1)});
             break;
         case ast::UnaryExpression::DEC:
-            _emit("  " + tmp + " = sub " + src + ", const." + ast::to_string(node.type->kind) + "1");
+            tmp = _emit(Opcode::SUB, {src, Operand::immediate(1)});
             break;
+        case ast::UnaryExpression::PLUS:
         default:
-            _emit("  " + tmp + " = " + unary_op_to_string(node.op) + " " + src);
+            tmp = _emit(Opcode::MOV, {src});
             break;
     }
 
     /** @brief update current mapping to the new SSA for the identifier only if modifying */
-    if (operand_is_ident && !ident_name.empty() && (node.op == ast::UnaryExpression::INC || node.op == ast::UnaryExpression::DEC)) {
-        _set_name(ident_name, tmp);
+    if (ident && (node.op == ast::UnaryExpression::INC || node.op == ast::UnaryExpression::DEC)) {
+        _assign(ident->name, Operand::value(tmp));
     }
 
-    _last_value = tmp;
+    _last_value = Operand::value(tmp);
 }
 
 /**
@@ -269,26 +481,24 @@ void cplus::ir::IntermediateRepresentation::visit(ast::UnaryExpression &node)
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::CallExpression &node)
 {
-    std::vector<std::string> args;
+    const auto callee = _function_ids.find(node.function_name);
+    std::vector<Operand> args;
     args.reserve(node.arguments.size());
 
+    if (callee == _function_ids.end()) {
+        throw exception::Error("IntermediateRepresentation::visit", "call to unknown function ", node.function_name, " in module ",
+            _module.name);
+    }
+
     for (const auto &arg : node.arguments) {
         arg->accept(*this);
         args.push_back(_last_value);
     }
 
-    const std::string tmp = _new_temp("call");
-    std::string arglist;
-
-    for (u64 i = 0; i < args.size(); ++i) {
-        if (i) {
-            arglist += ", ";
-        }
-        arglist += args[i];
-    }
+    const ValueId tmp = _function->new_value();
 
-    _emit("  " + tmp + " = call @" + std::string(node.function_name) + "(" + arglist + ")");
-    _last_value = tmp;
+    _emit(Instruction{.opcode = Opcode::CALL, .result = tmp, .callee = callee->second, .operands = std::move(args)});
+    _last_value = Operand::value(tmp);
 }
 
 /**
@@ -299,12 +509,9 @@ void cplus::ir::IntermediateRepresentation::visit(ast::AssignmentExpression &nod
 {
     node.value->accept(*this);
 
-    const std::string value = _last_value;
-    const std::string vname(node.variable_name);
-    const std::string ssa = _new_temp(vname);
+    const Operand ssa = Operand::value(_emit(Opcode::MOV, {_last_value}));
 
-    _emit("  " + ssa + " = mov " + value);
-    _set_name(vname, ssa);
+    _assign(node.variable_name, ssa);
     _last_value = ssa;
 }
 
@@ -316,7 +523,7 @@ void cplus::ir::IntermediateRepresentation::visit(ast::ExpressionStatement &node
     if (node.expression) {
         node.expression->accept(*this);
     }
-    _last_value.clear();
+    _last_value = {};
 }
 
 /**
@@ -325,7 +532,7 @@ void cplus::ir::IntermediateRepresentation::visit(ast::ExpressionStatement &node
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::BlockStatement &node)
 {
-    _push_copy();
+    _push();
     for (const auto &stmt : node.statements) {
         stmt->accept(*this);
     }
@@ -334,21 +541,25 @@ void cplus::ir::IntermediateRepresentation::visit(ast::BlockStatement &node)
 
 /**
 * @brief variable declaration
-* @note initializer is optional
+* @note initializer is optional, a declaration resolved as an assignment by the symbol table rebinds the variable
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::VariableDeclaration &node)
 {
-    const std::string name(node.name);
-    const std::string ssa = _new_temp(name);
+    ValueId ssa = INVALID_ID;
 
     if (node.initializer) {
         node.initializer->accept(*this);
-        _emit("  " + ssa + " = mov " + _last_value);
-        _last_value.clear();
+        ssa = _emit(Opcode::MOV, {_last_value});
+        _last_value = {};
     } else {
-        _emit("  " + ssa + " = undef");
+        ssa = _emit(Opcode::UNDEF);
+    }
+
+    if (node.is_assignment) {
+        _assign(node.name, Operand::value(ssa));
+    } else {
+        _declare(node.name, Operand::value(ssa));
     }
-    _set_name(name, ssa);
 }
 
 /**
@@ -359,118 +570,99 @@ void cplus::ir::IntermediateRepresentation::visit(ast::ReturnStatement &node)
 {
     if (node.value) {
         node.value->accept(*this);
-        _emit("  ret " + _last_value);
+        _emit(Opcode::RET, {_last_value}, false);
 
     } else {
-        _emit("  ret");
+        _emit(Opcode::RET, {}, false);
     }
 
-    _last_value.clear();
+    _last_value = {};
 }
 
 /**
  * @brief if-else statement handling with SSA phi nodes & dead code elimination
- * @note cond is evaluated first, but branch labels are not emitted here to keep IR structured
+ * @note phi incoming blocks are the blocks that actually jump to if.end, not the first block of each branch
  */
 void cplus::ir::IntermediateRepresentation::visit(ast::IfStatement &node)
 {
     /** @brief evaluate condition first */
     node.condition->accept(*this);
-    const std::string cond = _last_value;
-    _last_value.clear();
+    const Operand cond = _last_value;
+    _last_value = {};
 
-    const std::string then_label = _new_label("if.then");
-    const std::string end_label = _new_label("if.end");
+    const BlockId then_block = _new_block("if.then");
+    const BlockId end_block = _new_block("if.end");
 
     /** @brief check if else branch is empty to optimize branching */
     const bool has_else = node.else_statement != nullptr;
-    const std::string else_label = has_else ? _new_label("if.else") : end_label;
+    const BlockId else_block = has_else ? _new_block("if.else") : end_block;
 
-    _emit("  br " + cond + ", %" + then_label + ", %" + else_label);
+    _emit(Opcode::BR, {cond, Operand::block(then_block), Operand::block(else_block)}, false);
+    const BlockId cond_block = _block;
 
-    /** @brief snapshot parent map */
-    const std::unordered_map<std::string, std::string> parent_map = _current_map();
+    /** @brief snapshot every visible binding */
+    const std::vector<ValueMap> parent_maps = _value_map_stack;
 
     /** @brief then branch */
-    _emit("label %" + then_label + ":");
-    _push_copy();
-    bool then_has_return = false;
-
+    _set_block(then_block);
     if (node.then_statement) {
-        const auto output_size_before = _output.size();
         node.then_statement->accept(*this);
-
-        /** @brief check if then branch ends with return */
-        const auto output_since = _output.substr(output_size_before);
-        then_has_return = output_since.find("  ret") != std::string::npos;
     }
 
-    const std::unordered_map<std::string, std::string> then_map = _current_map();
-    _pop();
+    const bool then_has_return = _is_terminated();
+    const BlockId then_end = _block;
+    const std::vector<ValueMap> then_maps = _value_map_stack;
 
     /** @brief only emit branch if then block doesn't end with return */
     if (!then_has_return) {
-        _emit("  br %" + end_label);
+        _emit(Opcode::JMP, {Operand::block(end_block)}, false);
     }
 
     /** @brief else branch (if any) */
-    std::unordered_map<std::string, std::string> else_map;
+    _value_map_stack = parent_maps;
+    std::vector<ValueMap> else_maps = parent_maps;
+    BlockId else_end = cond_block;
     bool else_has_return = false;
 
     if (has_else) {
-        _emit("label %" + else_label + ":");
-        _push_copy();
-        const auto output_size_before = _output.size();
+        _set_block(else_block);
         node.else_statement->accept(*this);
 
-        /** @brief check if else branch ends with return */
-        const auto output_since = _output.substr(output_size_before);
-        else_has_return = output_since.find("  ret") != std::string::npos;
-        else_map = _current_map();
-        _pop();
+        else_has_return = _is_terminated();
+        else_end = _block;
+        else_maps = _value_map_stack;
 
         /** @brief only emit branch if else block doesn't end with return */
         if (!else_has_return) {
-            _emit("  br %" + end_label);
+            _emit(Opcode::JMP, {Operand::block(end_block)}, false);
         }
-
-    } else {
-        else_map = parent_map;
+        _value_map_stack = parent_maps;
     }
 
-    /** @brief only emit end label if at least one branch doesn't return */
-    if (!then_has_return || !else_has_return) {
-        _emit("label %" + end_label + ":");
+    _set_block(end_block);
 
-        /** @brief collect all variable names from parent, then, and else maps */
-        std::unordered_set<std::string> varset;
-        for (const auto &kv : parent_map) {
-            varset.insert(kv.first);
-        }
-        for (const auto &kv : then_map) {
-            varset.insert(kv.first);
-        }
-        for (const auto &kv : else_map) {
-            varset.insert(kv.first);
-        }
+    /** @brief if.end is unreachable when both branches return */
+    if (then_has_return && else_has_return) {
+        return;
+    }
 
-        /** @brief foreach variable with differing results, emit a phi & update current mapping */
-        for (const auto &var : varset) {
-            const std::string parent_ssa = parent_map.count(var) ? parent_map.at(var) : "undef";
-            const std::string then_ssa = then_map.count(var) ? then_map.at(var) : parent_ssa;
-            const std::string else_ssa = else_map.count(var) ? else_map.at(var) : parent_ssa;
+    /** @brief foreach variable visible before the if with differing results, emit a phi & update the mapping */
+    for (u64 depth = 0; depth < parent_maps.size(); ++depth) {
+        for (const auto &[name, parent_ssa] : parent_maps[depth]) {
+            const Operand then_ssa = then_maps[depth].at(name);
+            const Operand else_ssa = else_maps[depth].at(name);
 
             /** @brief handle cases where one branch returns */
-            if (then_has_return && !else_has_return) {
-                _set_name(var, else_ssa);
-            } else if (else_has_return && !then_has_return) {
-                _set_name(var, then_ssa);
+            if (then_has_return) {
+                _value_map_stack[depth][name] = else_ssa;
+            } else if (else_has_return) {
+                _value_map_stack[depth][name] = then_ssa;
             } else if (then_ssa == else_ssa) {
-                _set_name(var, then_ssa);
+                _value_map_stack[depth][name] = then_ssa;
             } else {
-                const std::string phi_ssa = _new_temp(var + "_phi");
-                _emit("  " + phi_ssa + " = phi [" + then_ssa + ", %" + then_label + "], [" + else_ssa + ", %" + else_label + "]");
-                _set_name(var, phi_ssa);
+                const ValueId phi = _emit(Opcode::PHI,
+                    {then_ssa, Operand::block(then_end), else_ssa, Operand::block(else_end)});
+                _value_map_stack[depth][name] = Operand::value(phi);
             }
         }
     }
@@ -478,11 +670,21 @@ void cplus::ir::IntermediateRepresentation::visit(ast::IfStatement &node)
 
 /**
  * @brief for loop
- * @note TODO
+ * @note the initializer lives in its own scope, the rest is a while loop with an increment in its latch
  */
-void cplus::ir::IntermediateRepresentation::visit(ast::ForStatement __attribute__((unused)) & node)
+void cplus::ir::IntermediateRepresentation::visit(ast::ForStatement &node)
 {
-    //TODO
+    _push();
+    if (node.initializer) {
+        node.initializer->accept(*this);
+    }
+    _loop(node.condition.get(), node.body.get(), node.increment.get());
+    _pop();
+}
+
+void cplus::ir::IntermediateRepresentation::visit(ast::WhileStatement &node)
+{
+    _loop(node.condition.get(), node.body.get(), nullptr);
 }
 
 /**
@@ -496,11 +698,103 @@ void cplus::ir::IntermediateRepresentation::visit(ast::ForeachStatement __attrib
 
 /**
  * @brief case statement
- * @note TODO
+ * @details a single `switch` dispatches to one block per clause, clauses do not fall through,
+ * the code generator picks the dispatch strategy (jump table, bit tests, compare tree) from the case values
+ * @note variables are merged in case.end like in an if, with one phi operand per clause reaching it
  */
-void cplus::ir::IntermediateRepresentation::visit(ast::CaseStatement __attribute__((unused)) & node)
+void cplus::ir::IntermediateRepresentation::visit(ast::CaseStatement &node)
 {
-    //TODO
+    // clang-format off
+    struct Incoming {
+        BlockId block;
+        std::vector<ValueMap> maps;
+    };
+    // clang-format on
+
+    node.expression->accept(*this);
+
+    const BlockId end_block = _new_block("case.end");
+    std::vector<Operand> operands{_last_value, Operand::block(end_block)};
+    std::vector<BlockId> clause_blocks;
+    std::vector<Incoming> incoming;
+    std::unordered_set<i64> values;
+
+    /** @brief case values must fold to distinct integer constants: literals or module constants */
+    for (const auto &clause : node.clauses) {
+        const BlockId block = _new_block(clause.values.empty() ? "case.default" : "case.when");
+
+        clause_blocks.push_back(block);
+        if (clause.values.empty()) {
+            operands[1] = Operand::block(block);
+        }
+
+        for (const auto &value : clause.values) {
+            value->accept(*this);
+            if (!_last_value.is_immediate() || !values.insert(_last_value.data).second) {
+                throw exception::Error("IntermediateRepresentation::visit", "case value must be a distinct integer constant in module ",
+                    _module.name, " at ", value->line, ":", value->column);
+            }
+            operands.push_back(_last_value);
+            operands.push_back(Operand::block(block));
+        }
+    }
+    _last_value = {};
+
+    const bool has_default = operands[1].id() != end_block;
+    _emit(Instruction{.opcode = Opcode::SWITCH, .operands = std::move(operands)});
+
+    const BlockId switch_block = _block;
+    const std::vector<ValueMap> parent_maps = _value_map_stack;
+
+    if (!has_default) {
+        incoming.push_back({.block = switch_block, .maps = parent_maps});
+    }
+
+    for (u64 i = 0; i < node.clauses.size(); ++i) {
+        _value_map_stack = parent_maps;
+        _set_block(clause_blocks[i]);
+
+        _push();
+        for (const auto &stmt : node.clauses[i].statements) {
+            stmt->accept(*this);
+        }
+        _pop();
+
+        if (!_is_terminated()) {
+            incoming.push_back({.block = _block, .maps = _value_map_stack});
+            _emit(Opcode::JMP, {Operand::block(end_block)}, false);
+        }
+    }
+
+    _value_map_stack = parent_maps;
+    _set_block(end_block);
+
+    /** @brief case.end is unreachable when every clause returns */
+    if (incoming.empty()) {
+        return;
+    }
+
+    for (u64 depth = 0; depth < parent_maps.size(); ++depth) {
+        for (const auto &[name, parent_ssa] : parent_maps[depth]) {
+            const Operand first = incoming.front().maps[depth].at(name);
+            const bool same = std::all_of(incoming.begin(), incoming.end(),
+                [&](const Incoming &in) { return in.maps[depth].at(name) == first; });
+
+            if (same) {
+                _value_map_stack[depth][name] = first;
+                continue;
+            }
+
+            std::vector<Operand> phi;
+
+            phi.reserve(incoming.size() * 2);
+            for (const auto &in : incoming) {
+                phi.push_back(in.maps[depth].at(name));
+                phi.push_back(Operand::block(in.block));
+            }
+            _value_map_stack[depth][name] = Operand::value(_emit(Opcode::PHI, std::move(phi)));
+        }
+    }
 }
 
 /**
@@ -509,19 +803,26 @@ void cplus::ir::IntermediateRepresentation::visit(ast::CaseStatement __attribute
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::FunctionDeclaration &node)
 {
-    _current_function = std::string(node.name);
-    _emit("func @" + _current_function + "() -> " + ast::to_string(node.return_type->kind));
-    _emit("{");
+    _function = &_module.functions[_function_ids.at(node.name)];
+    _function->parameters = static_cast<u32>(node.parameters.size());
+    _function->return_type = node.return_type ? node.return_type->kind : ast::Type::VOID;
+    for (const auto &attribute : node.attributes) {
+        if (attribute.name == "inline") {
+            _function->inline_hint = attribute.argument == "always" ? Function::Inline::ALWAYS : Function::Inline::NEVER;
+        } else if (attribute.name == "memoize") {
+            _function->memoize = true;
+        } else if (attribute.name == "export") {
+            _function->exported = true;
+        }
+    }
+    _set_block(_new_block("entry"));
 
     _push();
 
     for (u64 i = 0; i < node.parameters.size(); ++i) {
-        const auto &p = node.parameters[i];
-        const std::string name(p.name);
-        const std::string ssa = _new_temp(name);
+        const ValueId ssa = _emit(Opcode::ARG, {Operand::immediate(static_cast<i64>(i))});
 
-        _emit("  " + ssa + " = arg " + std::to_string(i));
-        _set_name(name, ssa);
+        _declare(node.parameters[i].name, Operand::value(ssa));
     }
 
     if (node.body) {
@@ -529,21 +830,41 @@ void cplus::ir::IntermediateRepresentation::visit(ast::FunctionDeclaration &node
     }
 
     /** @brief only emit implicit return if last statement wasn’t a return to avoid multiple ret */
-    if (_output.rfind("  ret", _output.size() - 5) == std::string::npos) {
-        _emit("  ret");
+    if (!_is_terminated()) {
+        _emit(Opcode::RET, {}, false);
     }
 
-    _emit("}");
     _pop();
+    _layout_blocks();
+    _function = nullptr;
 }
 
 /**
 * @brief module
-* @note ast visitor entry point
+* @note ast visitor entry point, functions are registered first so that calls can reference functions declared later
 */
 void cplus::ir::IntermediateRepresentation::visit(ast::Module &node)
 {
     for (const auto &decl : node.declarations) {
-        decl->accept(*this);
+        if (const auto *function = dynamic_cast<ast::FunctionDeclaration *>(decl.get())) {
+            _function_ids[function->name] = static_cast<FunctionId>(_module.functions.size());
+            _module.functions.emplace_back().name = std::string(function->name);
+        }
+    }
+
+    for (const auto &decl : node.declarations) {
+        if (dynamic_cast<ast::FunctionDeclaration *>(decl.get())) {
+            decl->accept(*this);
+
+        } else if (const auto *var = dynamic_cast<ast::VariableDeclaration *>(decl.get());
+            var && dynamic_cast<ast::LiteralExpression *>(var->initializer.get())) {
+            /** @brief module-level constants are folded into their uses */
+            var->initializer->accept(*this);
+            _declare(var->name, _last_value);
+
+        } else {
+            throw exception::Error("IntermediateRepresentation::visit", "only functions and literal constants are allowed at module level in ",
+                _module.name, " at ", decl->line, ":", decl->column);
+        }
     }
 }
@@ -0,0 +1,352 @@
+#include <CPlus/Codegen/ObjectFile.hpp>
+#include <CPlus/Error.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+
+/**
+ * helpers
+ */
+
+namespace {
+
+/**
+ * @brief StringTable
+ * @details ELF string table, offset 0 is the empty string
+ */
+class StringTable
+{
+    public:
+        StringTable() : _data(1, '\0')
+        {
+            /* __ctor__ */
+        }
+
+        cplus::u32 add(const std::string &string)
+        {
+            if (string.empty()) {
+                return 0;
+            }
+
+            const cplus::u32 offset = static_cast<cplus::u32>(_data.size());
+
+            _data += string;
+            _data += '\0';
+            return offset;
+        }
+
+        const std::string &data() const
+        {
+            return _data;
+        }
+
+    private:
+        std::string _data;
+};
+
+template<typename T>
+void _append(std::string &image, const T &value)
+{
+    image.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void _align(std::string &image, const cplus::u64 alignment)
+{
+    image.resize((image.size() + alignment - 1) & ~(alignment - 1), '\0');
+}
+
+/**
+ * @brief place
+ * @info appends a section content to the image and returns its header
+ */
+Elf64_Shdr _place(std::string &image, StringTable &names, const std::string &name, const cplus::u32 type, const void *data,
+    const cplus::u64 size, const cplus::u64 alignment)
+{
+    Elf64_Shdr header{};
+
+    _align(image, alignment);
+    header.sh_name = names.add(name);
+    header.sh_type = type;
+    header.sh_offset = image.size();
+    header.sh_size = size;
+    header.sh_addralign = alignment;
+    if (type != SHT_NOBITS && size) {
+        image.append(static_cast<const char *>(data), size);
+    }
+    return header;
+}
+
+/**
+ * @brief at
+ * @info bounds-checked view of a structure inside a file image
+ */
+template<typename T>
+const T &_at(const std::string &image, const std::string &name, const cplus::u64 offset)
+{
+    if (offset > image.size() || image.size() - offset < sizeof(T)) {
+        throw cplus::exception::Error("elf::read_relocatable", "truncated object file ", name);
+    }
+    return *reinterpret_cast<const T *>(image.data() + offset);
+}
+
+cplus::elf::Section::Kind _section_kind(const Elf64_Shdr &header)
+{
+    if (header.sh_flags & SHF_EXECINSTR) {
+        return cplus::elf::Section::TEXT;
+    }
+    if (header.sh_flags & SHF_WRITE) {
+        return header.sh_type == SHT_NOBITS ? cplus::elf::Section::BSS : cplus::elf::Section::DATA;
+    }
+    return cplus::elf::Section::RODATA;
+}
+
+}// namespace
+
+/**
+ * public
+ */
+
+/**
+ * @brief write relocatable
+ * @details layout: ELF header, section contents, section header table;
+ * object section i is written at index i + 1, local symbols come before the globals as required by .symtab's sh_info
+ */
+std::string cplus::elf::write_relocatable(const ObjectFile &object)
+{
+    StringTable strtab;
+    StringTable shstrtab;
+    std::vector<Elf64_Sym> symbols;
+    std::vector<u32> remap(object.symbols.size(), 0);
+
+    symbols.push_back(Elf64_Sym{});
+
+    Elf64_Sym file{};
+    file.st_name = strtab.add(object.name);
+    file.st_info = ELF64_ST_INFO(STB_LOCAL, STT_FILE);
+    file.st_shndx = SHN_ABS;
+    symbols.push_back(file);
+
+    u32 first_global = 0;
+
+    for (const bool global : {false, true}) {
+        if (global) {
+            first_global = static_cast<u32>(symbols.size());
+        }
+        for (u64 i = 0; i < object.symbols.size(); ++i) {
+            const Symbol &symbol = object.symbols[i];
+
+            if ((symbol.binding != Symbol::LOCAL) != global) {
+                continue;
+            }
+
+            constexpr u8 types[] = {STT_NOTYPE, STT_FUNC, STT_OBJECT, STT_SECTION};
+            constexpr u8 bindings[] = {STB_LOCAL, STB_GLOBAL, STB_WEAK};
+            Elf64_Sym sym{};
+
+            sym.st_name = symbol.kind == Symbol::SECTION ? 0 : strtab.add(symbol.name);
+            sym.st_info = static_cast<u8>(ELF64_ST_INFO(bindings[symbol.binding], types[symbol.kind]));
+            sym.st_shndx = static_cast<u16>(symbol.section == NO_SECTION ? SHN_UNDEF : symbol.section + 1);
+            sym.st_value = symbol.value;
+            sym.st_size = symbol.size;
+
+            remap[i] = static_cast<u32>(symbols.size());
+            symbols.push_back(sym);
+        }
+    }
+
+    std::string image(sizeof(Elf64_Ehdr), '\0');
+    std::vector<Elf64_Shdr> headers(1, Elf64_Shdr{});
+    const auto relocated = std::count_if(object.sections.begin(), object.sections.end(),
+        [](const Section &section) { return !section.relocations.empty(); });
+    const u32 symtab_index = static_cast<u32>(1 + object.sections.size() + static_cast<u64>(relocated));
+
+    /** @brief section contents */
+    for (const auto &section : object.sections) {
+        const bool bss = section.kind == Section::BSS;
+        Elf64_Shdr &header = headers.emplace_back(
+            _place(image, shstrtab, section.name, bss ? SHT_NOBITS : SHT_PROGBITS, section.data.data(), section.data.size(), section.alignment));
+
+        header.sh_flags = SHF_ALLOC;
+        if (section.kind == Section::TEXT) {
+            header.sh_flags |= SHF_EXECINSTR;
+        } else if (section.kind == Section::DATA || bss) {
+            header.sh_flags |= SHF_WRITE;
+        }
+    }
+
+    for (u64 i = 0; i < object.sections.size(); ++i) {
+        const auto &section = object.sections[i];
+
+        if (section.relocations.empty()) {
+            continue;
+        }
+
+        std::vector<Elf64_Rela> relocations;
+        relocations.reserve(section.relocations.size());
+        for (const auto &relocation : section.relocations) {
+            Elf64_Rela rela{};
+
+            rela.r_offset = relocation.offset;
+            rela.r_info = ELF64_R_INFO(remap[relocation.symbol], relocation.type);
+            rela.r_addend = relocation.addend;
+            relocations.push_back(rela);
+        }
+
+        Elf64_Shdr &header = headers.emplace_back(_place(image, shstrtab, ".rela" + section.name, SHT_RELA, relocations.data(),
+            relocations.size() * sizeof(Elf64_Rela), 8));
+
+        header.sh_flags = SHF_INFO_LINK;
+        header.sh_link = symtab_index;
+        header.sh_info = static_cast<u32>(i + 1);
+        header.sh_entsize = sizeof(Elf64_Rela);
+    }
+
+    Elf64_Shdr &symtab = headers.emplace_back(
+        _place(image, shstrtab, ".symtab", SHT_SYMTAB, symbols.data(), symbols.size() * sizeof(Elf64_Sym), 8));
+    symtab.sh_link = symtab_index + 1;
+    symtab.sh_info = first_global;
+    symtab.sh_entsize = sizeof(Elf64_Sym);
+
+    headers.push_back(_place(image, shstrtab, ".strtab", SHT_STRTAB, strtab.data().data(), strtab.data().size(), 1));
+    headers.push_back(_place(image, shstrtab, ".note.GNU-stack", SHT_PROGBITS, nullptr, 0, 1));
+
+    /** @brief .shstrtab goes last so it holds every section name, its own included */
+    const u32 shstrtab_name = shstrtab.add(".shstrtab");
+    Elf64_Shdr &names = headers.emplace_back(_place(image, shstrtab, "", SHT_STRTAB, shstrtab.data().data(), shstrtab.data().size(), 1));
+    names.sh_name = shstrtab_name;
+
+    /** @brief section header table */
+    _align(image, 8);
+
+    Elf64_Ehdr header{};
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = image.size();
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = static_cast<u16>(headers.size());
+    header.e_shstrndx = static_cast<u16>(headers.size() - 1);
+
+    for (const auto &section : headers) {
+        _append(image, section);
+    }
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    return image;
+}
+
+/**
+ * @brief read relocatable
+ * @details common symbols get a BSS section of their own, so the linker only deals with defined and undefined symbols
+ */
+cplus::elf::ObjectFile cplus::elf::read_relocatable(const std::string &image, const std::string &name)
+{
+    const auto &header = _at<Elf64_Ehdr>(image, name, 0);
+
+    if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 || header.e_ident[EI_CLASS] != ELFCLASS64 || header.e_ident[EI_DATA] != ELFDATA2LSB
+        || header.e_type != ET_REL || header.e_machine != EM_X86_64) {
+        throw exception::Error("elf::read_relocatable", name, " is not an x86-64 relocatable object");
+    }
+
+    std::vector<Elf64_Shdr> headers;
+    for (u64 i = 0; i < header.e_shnum; ++i) {
+        headers.push_back(_at<Elf64_Shdr>(image, name, header.e_shoff + i * sizeof(Elf64_Shdr)));
+    }
+
+    const auto string_at = [&](const Elf64_Shdr &table, const u32 offset) -> std::string {
+        if (table.sh_offset + offset >= image.size()) {
+            throw exception::Error("elf::read_relocatable", "truncated string table in ", name);
+        }
+        return std::string(image.c_str() + table.sh_offset + offset);
+    };
+
+    ObjectFile object;
+    std::vector<u32> section_map(headers.size(), NO_SECTION);
+    const Elf64_Shdr *symtab = nullptr;
+
+    object.name = name;
+
+    for (u64 i = 0; i < headers.size(); ++i) {
+        const Elf64_Shdr &section = headers[i];
+
+        if (section.sh_type == SHT_SYMTAB) {
+            symtab = &section;
+        }
+        if (!(section.sh_flags & SHF_ALLOC) || section.sh_type == SHT_GROUP) {
+            continue;
+        }
+        if (section.sh_type == SHT_NOBITS || section.sh_offset + section.sh_size <= image.size()) {
+            Section &loaded = object.sections.emplace_back();
+
+            loaded.name = string_at(headers[header.e_shstrndx], section.sh_name);
+            loaded.kind = _section_kind(section);
+            loaded.alignment = std::max<u64>(section.sh_addralign, 1);
+            if (section.sh_type == SHT_NOBITS) {
+                loaded.data.assign(section.sh_size, 0);
+            } else {
+                loaded.data.assign(image.begin() + static_cast<i64>(section.sh_offset),
+                    image.begin() + static_cast<i64>(section.sh_offset + section.sh_size));
+            }
+            section_map[i] = static_cast<u32>(object.sections.size() - 1);
+        } else {
+            throw exception::Error("elf::read_relocatable", "truncated section in ", name);
+        }
+    }
+
+    if (!symtab) {
+        return object;
+    }
+
+    for (u64 offset = 0; offset + sizeof(Elf64_Sym) <= symtab->sh_size; offset += sizeof(Elf64_Sym)) {
+        const auto &sym = _at<Elf64_Sym>(image, name, symtab->sh_offset + offset);
+        const u8 bind = ELF64_ST_BIND(sym.st_info);
+        const u8 type = ELF64_ST_TYPE(sym.st_info);
+        Symbol &symbol = object.symbols.emplace_back();
+
+        symbol.name = string_at(headers[symtab->sh_link], sym.st_name);
+        symbol.binding = bind == STB_GLOBAL ? Symbol::GLOBAL : (bind == STB_WEAK ? Symbol::WEAK : Symbol::LOCAL);
+        symbol.kind = type == STT_FUNC ? Symbol::FUNCTION : (type == STT_OBJECT ? Symbol::OBJECT : (type == STT_SECTION ? Symbol::SECTION : Symbol::NOTYPE));
+        symbol.value = sym.st_value;
+        symbol.size = sym.st_size;
+
+        if (sym.st_shndx == SHN_COMMON) {
+            object.sections.push_back({.name = ".bss." + symbol.name, .kind = Section::BSS, .alignment = std::max<u64>(sym.st_value, 1),
+                .data = std::vector<u8>(sym.st_size, 0), .relocations = {}});
+            symbol.section = static_cast<u32>(object.sections.size() - 1);
+            symbol.value = 0;
+        } else if (sym.st_shndx == SHN_ABS) {
+            if (type != STT_FILE && bind != STB_LOCAL) {
+                throw exception::Error("elf::read_relocatable", "absolute symbol ", symbol.name, " in ", name, " is not supported");
+            }
+        } else if (sym.st_shndx != SHN_UNDEF && sym.st_shndx < section_map.size()) {
+            symbol.section = section_map[sym.st_shndx];
+        }
+    }
+
+    for (const auto &section : headers) {
+        if (section.sh_type == SHT_REL) {
+            throw exception::Error("elf::read_relocatable", "REL relocations are not supported in ", name);
+        }
+        if (section.sh_type != SHT_RELA || section.sh_info >= section_map.size() || section_map[section.sh_info] == NO_SECTION) {
+            continue;
+        }
+
+        auto &relocations = object.sections[section_map[section.sh_info]].relocations;
+
+        for (u64 offset = 0; offset + sizeof(Elf64_Rela) <= section.sh_size; offset += sizeof(Elf64_Rela)) {
+            const auto &rela = _at<Elf64_Rela>(image, name, section.sh_offset + offset);
+
+            relocations.push_back({.offset = rela.r_offset, .symbol = static_cast<u32>(ELF64_R_SYM(rela.r_info)),
+                .type = static_cast<u32>(ELF64_R_TYPE(rela.r_info)), .addend = rela.r_addend});
+        }
+    }
+
+    return object;
+}
@@ -0,0 +1,362 @@
+#include <CPlus/Codegen/RegisterAllocator.hpp>
+
+#include <algorithm>
+
+/**
+ * public
+ */
+
+cplus::x86_64::RegisterAllocator::RegisterAllocator(const ir::Function &function, const bool allocate)
+{
+    if (!allocate) {
+        for (ir::ValueId value = 0; value < function.values; ++value) {
+            _locations.push_back({.reg = NO_REGISTER, .slot = value});
+        }
+        _spill_slots = function.values;
+        return;
+    }
+
+    const ir::Liveness liveness(function);
+
+    _locations.assign(function.values, Location{});
+    _coalesce(function, liveness);
+
+    auto intervals = _build_intervals(function, liveness);
+    _linear_scan(intervals);
+
+    for (ir::ValueId value = 0; value < function.values; ++value) {
+        _locations[value] = _locations[_find(value)];
+    }
+}
+
+/**
+ * helpers
+ */
+
+/** @brief argument registers last, and in reverse: the first ones are the most often set by a call */
+static constexpr cplus::x86_64::Register CALLER_SAVED_POOL[] = {cplus::x86_64::R10, cplus::x86_64::R11, cplus::x86_64::R9,
+    cplus::x86_64::R8, cplus::x86_64::RSI, cplus::x86_64::RDI};
+
+static inline bool _is_pooled(const cplus::x86_64::Register reg)
+{
+    return std::find(std::begin(CALLER_SAVED_POOL), std::end(CALLER_SAVED_POOL), reg) != std::end(CALLER_SAVED_POOL);
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief coalesce
+ * @details merges each phi with its operands unless two values of the merged classes interfere: in strict SSA,
+ * two values interfere exactly when one is live right after the definition of the other.
+ * phi operands are used at the end of their incoming block and the phis of a block are all defined on its entry
+ */
+void cplus::x86_64::RegisterAllocator::_coalesce(const ir::Function &function, const ir::Liveness &liveness)
+{
+    // clang-format off
+    struct Site {
+        ir::BlockId block = ir::INVALID_ID;
+        u32 index = 0;
+        bool phi = false;
+    };
+    // clang-format on
+
+    std::vector<Site> definitions(function.values);
+    std::vector<std::vector<Site>> uses(function.values);
+    std::vector<std::vector<ir::ValueId>> members(function.values);
+
+    _classes.resize(function.values);
+    for (ir::ValueId value = 0; value < function.values; ++value) {
+        _classes[value] = value;
+        members[value].push_back(value);
+    }
+
+    for (ir::BlockId b = 0; b < function.blocks.size(); ++b) {
+        for (u32 i = 0; i < function.blocks[b].instructions.size(); ++i) {
+            const auto &instruction = function.blocks[b].instructions[i];
+            const bool phi = instruction.opcode == ir::Opcode::PHI;
+
+            if (instruction.result != ir::INVALID_ID) {
+                definitions[instruction.result] = {.block = b, .index = i, .phi = phi};
+            }
+            for (const auto &operand : instruction.operands) {
+                if (operand.is_value() && !phi) {
+                    uses[operand.id()].push_back({.block = b, .index = i, .phi = false});
+                }
+            }
+        }
+    }
+
+    /** @brief is `value` live right after `other` is defined */
+    const auto live_after = [&](const ir::ValueId value, const ir::ValueId other) {
+        const Site &def = definitions[value];
+        const Site &at = definitions[other];
+
+        if (def.block == ir::INVALID_ID || at.block == ir::INVALID_ID) {
+            return false;
+        }
+
+        const bool defined =
+            def.block == at.block ? def.index < at.index || (def.phi && at.phi) : liveness.live_in(at.block).contains(value);
+
+        if (!defined) {
+            return false;
+        }
+        if (liveness.live_out(at.block).contains(value)) {
+            return true;
+        }
+        return std::any_of(uses[value].begin(), uses[value].end(),
+            [&](const Site &use) { return use.block == at.block && use.index > at.index; });
+    };
+
+    const auto interfere = [&](const ir::ValueId a, const ir::ValueId b) {
+        if (members[a].size() * members[b].size() > COALESCE_MAX_PAIRS) {
+            return true;
+        }
+        for (const ir::ValueId x : members[a]) {
+            for (const ir::ValueId y : members[b]) {
+                if (live_after(x, y) || live_after(y, x)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            if (instruction.opcode != ir::Opcode::PHI) {
+                break;
+            }
+            for (u64 i = 0; i < instruction.operands.size(); i += 2) {
+                if (!instruction.operands[i].is_value()) {
+                    continue;
+                }
+
+                ir::ValueId a = _find(instruction.result);
+                ir::ValueId b = _find(instruction.operands[i].id());
+
+                if (a == b || interfere(a, b)) {
+                    continue;
+                }
+                if (members[a].size() < members[b].size()) {
+                    std::swap(a, b);
+                }
+                _classes[b] = a;
+                members[a].insert(members[a].end(), members[b].begin(), members[b].end());
+                members[b] = {};
+            }
+        }
+    }
+}
+
+cplus::ir::ValueId cplus::x86_64::RegisterAllocator::_find(const ir::ValueId value)
+{
+    ir::ValueId root = value;
+
+    while (_classes[root] != root) {
+        root = _classes[root];
+    }
+    for (ir::ValueId v = value; _classes[v] != root;) {
+        const ir::ValueId next = _classes[v];
+
+        _classes[v] = root;
+        v = next;
+    }
+    return root;
+}
+
+/**
+ * @brief build intervals
+ * @details numbers instructions in layout order, then every class gets the single range
+ * [first definition, last use], stretched over the blocks where one of its values is live-in or live-out
+ * and over the end of the incoming blocks of its phis. a class is hinted the register one of its values is received
+ * in by its ARG, else the one it is first passed in to a call
+ */
+std::vector<cplus::x86_64::RegisterAllocator::Interval> cplus::x86_64::RegisterAllocator::_build_intervals(const ir::Function &function,
+    const ir::Liveness &liveness)
+{
+    constexpr u32 unset = ir::INVALID_ID;
+    std::vector<u32> start(function.values, unset);
+    std::vector<u32> end(function.values, 0);
+    std::vector<u32> block_ends(function.blocks.size(), 0);
+    std::vector<Register> hints(function.values, NO_REGISTER);
+    std::vector<u32> calls;
+    u32 position = 0;
+
+    const auto extend = [&](const ir::ValueId value, const u32 from, const u32 to) {
+        start[value] = std::min(start[value], from);
+        end[value] = std::max(end[value], to);
+    };
+
+    for (u64 b = 0; b < function.blocks.size(); ++b) {
+        position += static_cast<u32>(function.blocks[b].instructions.size());
+        block_ends[b] = position;
+    }
+    position = 0;
+
+    for (u64 b = 0; b < function.blocks.size(); ++b) {
+        const auto &block = function.blocks[b];
+        const u32 block_start = position;
+        const u32 block_end = block_ends[b];
+
+        liveness.live_in(static_cast<ir::BlockId>(b)).for_each([&](const ir::ValueId value) { extend(value, block_start, block_start); });
+        liveness.live_out(static_cast<ir::BlockId>(b)).for_each([&](const ir::ValueId value) { extend(value, block_end, block_end); });
+
+        for (const auto &instruction : block.instructions) {
+            if (instruction.opcode == ir::Opcode::PHI) {
+                for (u64 i = 1; i < instruction.operands.size(); i += 2) {
+                    const u32 copy = block_ends[instruction.operands[i].id()];
+
+                    extend(instruction.result, copy, copy);
+                }
+            } else {
+                for (const auto &operand : instruction.operands) {
+                    if (operand.is_value()) {
+                        extend(operand.id(), position, position);
+                    }
+                }
+            }
+            if (instruction.result != ir::INVALID_ID) {
+                extend(instruction.result, position, position);
+            }
+            if (instruction.opcode == ir::Opcode::ARG && instruction.operands[0].data < 6) {
+                const Register reg = ARGUMENT_REGISTERS[instruction.operands[0].data];
+                const auto it = std::find_if(_arguments.begin(), _arguments.end(), [&](const auto &argument) { return argument.second == reg; });
+
+                hints[instruction.result] = reg;
+                if (it != _arguments.end()) {
+                    it->first = std::max(it->first, position);
+                } else if (_is_pooled(reg)) {//<< edx and ecx stay scratch registers, never handed out
+                    _arguments.emplace_back(position, reg);
+                }
+            }
+            if (instruction.opcode == ir::Opcode::CALL) {
+                calls.push_back(position);
+                for (u64 i = 0; i < instruction.operands.size() && i < 6; ++i) {
+                    const ir::Operand &operand = instruction.operands[i];
+
+                    if (operand.is_value() && hints[operand.id()] == NO_REGISTER) {
+                        hints[operand.id()] = ARGUMENT_REGISTERS[i];
+                    }
+                }
+            }
+            ++position;
+        }
+    }
+
+    /** @brief a class lives as long as any of its values */
+    for (ir::ValueId value = 0; value < function.values; ++value) {
+        const ir::ValueId root = _find(value);
+
+        if (root != value && start[value] != unset) {
+            extend(root, start[value], end[value]);
+        }
+        if (hints[root] == NO_REGISTER) {
+            hints[root] = hints[value];
+        }
+    }
+
+    std::vector<Interval> intervals;
+    intervals.reserve(function.values);
+
+    for (ir::ValueId value = 0; value < function.values; ++value) {
+        if (start[value] == unset || _classes[value] != value) {
+            continue;
+        }
+        const auto call = std::upper_bound(calls.begin(), calls.end(), start[value]);
+        const bool crosses_call = call != calls.end() && *call < end[value];
+
+        intervals.push_back(
+            Interval{.value = value, .start = start[value], .end = end[value], .crosses_call = crosses_call, .hint = hints[value]});
+    }
+
+    std::sort(intervals.begin(), intervals.end(), [](const Interval &a, const Interval &b) { return a.start < b.start; });
+    return intervals;
+}
+
+/**
+ * @brief linear scan
+ * @details an interval can reuse the register of one ending at its definition because the code generator
+ * reads every operand before writing the result; when no register fits, the active interval ending last is spilled.
+ * an incoming argument register joins the pool at its ARG, whose result may take it
+ */
+void cplus::x86_64::RegisterAllocator::_linear_scan(std::vector<Interval> &intervals)
+{
+    std::vector<const Interval *> active;
+    std::vector<Register> free_caller;
+    std::vector<Register> free_callee(std::begin(CALLEE_SAVED_REGISTERS), std::end(CALLEE_SAVED_REGISTERS));
+
+    for (const Register reg : CALLER_SAVED_POOL) {
+        if (std::none_of(_arguments.begin(), _arguments.end(), [&](const auto &argument) { return argument.second == reg; })) {
+            free_caller.push_back(reg);
+        }
+    }
+
+    const auto release = [&](const Register reg) {
+        auto &pool = is_callee_saved(reg) ? free_callee : free_caller;
+        pool.insert(pool.begin(), reg);
+    };
+
+    const auto take = [&](std::vector<Register> &pool, const Register hint) {
+        const auto it = std::find(pool.begin(), pool.end(), hint);
+        const Register reg = it != pool.end() ? *it : pool.front();
+
+        pool.erase(it != pool.end() ? it : pool.begin());
+        if (is_callee_saved(reg) && std::find(_callee_saved.begin(), _callee_saved.end(), reg) == _callee_saved.end()) {
+            _callee_saved.push_back(reg);
+        }
+        return reg;
+    };
+
+    for (const auto &current : intervals) {
+        /** @brief expire intervals that ended */
+        std::erase_if(active, [&](const Interval *interval) {
+            if (interval->end > current.start) {
+                return false;
+            }
+            release(_locations[interval->value].reg);
+            return true;
+        });
+        std::erase_if(_arguments, [&](const std::pair<u32, Register> &argument) {
+            if (argument.first > current.start) {
+                return false;
+            }
+            free_caller.push_back(argument.second);
+            return true;
+        });
+
+        if (!current.crosses_call && !free_caller.empty()) {
+            _locations[current.value].reg = take(free_caller, current.hint);
+        } else if (!free_callee.empty()) {
+            _locations[current.value].reg = take(free_callee, NO_REGISTER);
+        } else {
+            /** @brief steal from the active interval ending last if its register is usable here */
+            const auto victim = std::max_element(active.begin(), active.end(), [&](const Interval *a, const Interval *b) {
+                const bool a_usable = !current.crosses_call || is_callee_saved(_locations[a->value].reg);
+                const bool b_usable = !current.crosses_call || is_callee_saved(_locations[b->value].reg);
+
+                return a_usable != b_usable ? !a_usable : a->end < b->end;
+            });
+            const bool usable = victim != active.end() && (!current.crosses_call || is_callee_saved(_locations[(*victim)->value].reg));
+
+            if (usable && (*victim)->end > current.end) {
+                _locations[current.value].reg = _locations[(*victim)->value].reg;
+                _spill((*victim)->value);
+                active.erase(victim);
+            } else {
+                _spill(current.value);
+                continue;
+            }
+        }
+
+        active.push_back(&current);
+    }
+}
+
+void cplus::x86_64::RegisterAllocator::_spill(const ir::ValueId value)
+{
+    _locations[value].reg = NO_REGISTER;
+    _locations[value].slot = _spill_slots++;
+}
@@ -0,0 +1,601 @@
+#include <CPlus/Codegen/x86-64Assembler.hpp>
+#include <CPlus/Error.hpp>
+
+#include <algorithm>
+#include <elf.h>
+
+/** @brief sections of the objects built by the assembler, followed by the sections of each function */
+static constexpr cplus::u32 RODATA = 0;
+static constexpr cplus::u32 BSS = 1;//<< only when the module has globals
+static constexpr cplus::u32 NO_TABLES = ~0u;
+
+/**
+ * public
+ */
+
+cplus::elf::ObjectFile cplus::x86_64::Assembler::run(const MachineModule &module)
+{
+    _module = &module;
+    _object = elf::ObjectFile{};
+    _object.name = module.name;
+    _object.sections.push_back({.name = ".rodata", .kind = elf::Section::RODATA, .alignment = 1, .data = {}, .relocations = {}});
+
+    _emit_rodata();
+    _emit_bss();
+    _declare_symbols();
+
+    for (u32 i = 0; i < module.functions.size(); ++i) {
+        _emit_tables(i);
+        _text = static_cast<u32>(_object.sections.size());
+        _object.sections.push_back({.name = ".text." + module.functions[i].name, .kind = elf::Section::TEXT,
+            .alignment = std::max<u64>(module.function_alignment, 1), .data = {}, .relocations = {}});
+
+        _encode_function(module.functions[i]);
+        _relocate_tables(i);
+        _object.symbols[i].section = _text;
+        _object.symbols[i].size = _object.sections[_text].data.size();
+    }
+
+    _module = nullptr;
+    return std::move(_object);
+}
+
+/**
+ * helpers
+ */
+
+static constexpr bool _fits_i8(const cplus::i64 value)
+{
+    return value >= -128 && value <= 127;
+}
+
+/**
+ * @brief unescape
+ * @info strings are kept as written in the source, decode the escapes the way `.string` would
+ */
+static void _unescape(const std::string &string, std::vector<cplus::u8> &out)
+{
+    for (cplus::u64 i = 0; i < string.size(); ++i) {
+        char c = string[i];
+
+        if (c == '\\' && i + 1 < string.size()) {
+            switch (string[++i]) {
+                case 'n':
+                    c = '\n';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                case '0':
+                    c = '\0';
+                    break;
+                default:
+                    c = string[i];
+                    break;
+            }
+        }
+        out.push_back(static_cast<cplus::u8>(c));
+    }
+    out.push_back(0);
+}
+
+/**
+ * private
+ */
+
+/** @brief emit rodata, the strings of the module */
+void cplus::x86_64::Assembler::_emit_rodata()
+{
+    auto &rodata = _object.sections[RODATA];
+
+    _string_offsets.clear();
+    for (const auto &string : _module->strings) {
+        _string_offsets.push_back(rodata.data.size());
+        _unescape(string, rodata.data);
+    }
+    _table_offsets.assign(_module->jump_tables.size(), 0);
+    _table_symbols.assign(_module->jump_tables.size(), 0);
+}
+
+/**
+ * @brief emit bss
+ * @details globals are laid out one after the other, dword aligned
+ */
+void cplus::x86_64::Assembler::_emit_bss()
+{
+    _global_offsets.clear();
+    if (_module->globals.empty()) {
+        return;
+    }
+
+    auto &bss = _object.sections.emplace_back(
+        elf::Section{.name = ".bss", .kind = elf::Section::BSS, .alignment = 4, .data = {}, .relocations = {}});
+
+    for (const auto &global : _module->globals) {
+        _global_offsets.push_back(bss.data.size());
+        bss.data.resize((bss.data.size() + global.size + 3) & ~static_cast<u64>(3));
+    }
+}
+
+/**
+ * @brief emit tables
+ * @details the 8-byte aligned jump tables of a function go to its own `.rodata.<function>` section, so they are
+ * collected with it. their entries are filled by relocations once the function is encoded
+ */
+void cplus::x86_64::Assembler::_emit_tables(const u32 function)
+{
+    u32 section = NO_TABLES;
+
+    for (u64 t = 0; t < _module->jump_tables.size(); ++t) {
+        const JumpTable &table = _module->jump_tables[t];
+
+        if (table.function != function) {
+            continue;
+        }
+        if (section == NO_TABLES) {
+            section = static_cast<u32>(_object.sections.size());
+            _object.sections.push_back({.name = ".rodata." + _module->functions[function].name, .kind = elf::Section::RODATA,
+                .alignment = 8, .data = {}, .relocations = {}});
+            _object.symbols.push_back(
+                {.name = "", .section = section, .kind = elf::Symbol::SECTION, .binding = elf::Symbol::LOCAL, .value = 0, .size = 0});
+        }
+
+        auto &rodata = _object.sections[section].data;
+
+        _table_offsets[t] = rodata.size();
+        _table_symbols[t] = static_cast<u32>(_object.symbols.size() - 1);
+        rodata.resize(rodata.size() + table.labels.size() * 8);
+    }
+}
+
+/**
+ * @brief relocate tables
+ * @info each entry is the absolute address of a label: the function symbol plus the label offset in the function
+ */
+void cplus::x86_64::Assembler::_relocate_tables(const u32 function)
+{
+    for (u64 t = 0; t < _module->jump_tables.size(); ++t) {
+        const JumpTable &table = _module->jump_tables[t];
+
+        if (table.function != function) {
+            continue;
+        }
+
+        auto &rodata = _object.sections[_object.symbols[_table_symbols[t]].section];
+
+        for (u64 i = 0; i < table.labels.size(); ++i) {
+            rodata.relocations.push_back({.offset = _table_offsets[t] + i * 8, .symbol = function, .type = R_X86_64_64,
+                .addend = static_cast<i64>(_labels[table.labels[i]])});
+        }
+    }
+}
+
+/**
+ * @brief declare symbols
+ * @details functions come first so their index matches MachineModule::functions,
+ * then the .rodata and .bss section symbols strings and globals are relocated against, then undefined call targets
+ */
+void cplus::x86_64::Assembler::_declare_symbols()
+{
+    auto &symbols = _object.symbols;
+
+    for (const auto &function : _module->functions) {
+        symbols.push_back({.name = function.name, .section = elf::NO_SECTION, .kind = elf::Symbol::FUNCTION,
+            .binding = elf::Symbol::GLOBAL, .value = 0, .size = 0});
+    }
+
+    _rodata_symbol = static_cast<u32>(symbols.size());
+    symbols.push_back({.name = "", .section = RODATA, .kind = elf::Symbol::SECTION, .binding = elf::Symbol::LOCAL, .value = 0, .size = 0});
+
+    _bss_symbol = static_cast<u32>(symbols.size());
+    if (!_module->globals.empty()) {
+        symbols.push_back({.name = "", .section = BSS, .kind = elf::Symbol::SECTION, .binding = elf::Symbol::LOCAL, .value = 0, .size = 0});
+    }
+
+    _symbol_index.clear();
+    for (const auto &name : _module->symbols) {
+        u32 index = 0;
+
+        while (index < _module->functions.size() && _module->functions[index].name != name) {
+            ++index;
+        }
+        if (index == _module->functions.size()) {
+            index = static_cast<u32>(symbols.size());
+            symbols.push_back({.name = name, .section = elf::NO_SECTION, .kind = elf::Symbol::NOTYPE, .binding = elf::Symbol::GLOBAL, .value = 0, .size = 0});
+        }
+        _symbol_index.push_back(index);
+    }
+}
+
+/**
+ * @brief encode function
+ * @details jumps start short, the function is encoded again whenever one of them has to be widened
+ */
+void cplus::x86_64::Assembler::_encode_function(const MachineFunction &function)
+{
+    const u64 start = _object.sections[_text].data.size();
+    const u64 relocations = _object.sections[_text].relocations.size();
+
+    _wide.assign(function.instructions.size(), false);
+
+    for (bool stable = false; !stable;) {
+        _object.sections[_text].data.resize(start);
+        _object.sections[_text].relocations.resize(relocations);
+        _labels.assign(function.labels.size(), ~0ull);
+        _fixups.clear();
+
+        for (u64 i = 0; i < function.instructions.size(); ++i) {
+            _encode(function.instructions[i], i);
+        }
+
+        stable = true;
+        for (const auto &fixup : _fixups) {
+            if (_labels[fixup.label] == ~0ull) {
+                throw exception::Error("x86_64::Assembler::_encode_function", "undefined label ", function.labels[fixup.label], " in ",
+                    function.name);
+            }
+
+            const i64 disp = static_cast<i64>(_labels[fixup.label]) - static_cast<i64>(fixup.at + (fixup.wide ? 4 : 1));
+
+            if (!fixup.wide && !_fits_i8(disp)) {
+                _wide[fixup.instruction] = true;
+                stable = false;
+            }
+        }
+    }
+
+    for (const auto &fixup : _fixups) {
+        const i64 disp = static_cast<i64>(_labels[fixup.label]) - static_cast<i64>(fixup.at + (fixup.wide ? 4 : 1));
+        const u32 value = static_cast<u32>(disp);
+        const u64 width = fixup.wide ? 4 : 1;
+
+        for (u64 b = 0; b < width; ++b) {
+            _object.sections[_text].data[fixup.at + b] = static_cast<u8>(value >> (8 * b));
+        }
+    }
+}
+
+void cplus::x86_64::Assembler::_encode(const MachineInstruction &instruction, const u64 index)
+{
+    const MachineOperand &dst = instruction.dst;
+
+    switch (instruction.mnemonic) {
+        case Mnemonic::LABEL:
+            _labels[dst.index()] = _object.sections[_text].data.size();
+            break;
+        case Mnemonic::MOV:
+            _encode_mov(instruction);
+            break;
+        case Mnemonic::MOVZX:
+            _rex(false, dst.reg, instruction.src);
+            _byte(0x0F);
+            _byte(0xB6);
+            _modrm(dst.reg, instruction.src);
+            break;
+        case Mnemonic::LEA:
+            _rex(false, dst.reg, instruction.src);
+            _byte(0x8D);
+            _modrm(dst.reg, instruction.src);
+            break;
+        case Mnemonic::ADD:
+            _encode_alu(instruction, 0x01, 0x03, 0);
+            break;
+        case Mnemonic::OR:
+            _encode_alu(instruction, 0x09, 0x0B, 1);
+            break;
+        case Mnemonic::AND:
+            _encode_alu(instruction, 0x21, 0x23, 4);
+            break;
+        case Mnemonic::SUB:
+            _encode_alu(instruction, 0x29, 0x2B, 5);
+            break;
+        case Mnemonic::CMP:
+            _encode_alu(instruction, 0x39, 0x3B, 7);
+            break;
+        case Mnemonic::TEST:
+            _rex(dst.size == 8, instruction.src.reg, dst);
+            _byte(0x85);
+            _modrm(instruction.src.reg, dst);
+            break;
+        case Mnemonic::SHL:
+            _rex(dst.size == 8, 0, dst);
+            _byte(instruction.src.value == 1 ? 0xD1 : 0xC1);
+            _modrm(4, dst);
+            if (instruction.src.value != 1) {
+                _byte(static_cast<u8>(instruction.src.value));
+            }
+            break;
+        case Mnemonic::IMUL:
+            _encode_imul(instruction);
+            break;
+        case Mnemonic::NEG:
+            _rex(dst.size == 8, 0, dst);
+            _byte(0xF7);
+            _modrm(3, dst);
+            break;
+        case Mnemonic::IDIV:
+            _rex(dst.size == 8, 0, dst);
+            _byte(0xF7);
+            _modrm(7, dst);
+            break;
+        case Mnemonic::CDQ:
+            _byte(0x99);
+            break;
+        case Mnemonic::SETCC:
+            _rex(false, 0, dst);
+            _byte(0x0F);
+            _byte(static_cast<u8>(0x90 | static_cast<u8>(instruction.condition)));
+            _modrm(0, dst);
+            break;
+        case Mnemonic::BT:
+            _rex(false, instruction.src.reg, dst);
+            _byte(0x0F);
+            _byte(0xA3);
+            _modrm(instruction.src.reg, dst);
+            break;
+        case Mnemonic::JMP:
+        case Mnemonic::JCC:
+            _encode_jump(instruction, index);
+            break;
+        case Mnemonic::CALL:
+            _byte(0xE8);
+            _relocate(_symbol_index[dst.index()], R_X86_64_PLT32, -4);
+            break;
+        case Mnemonic::PUSH:
+            if (dst.reg >= R8) {
+                _byte(0x41);
+            }
+            _byte(static_cast<u8>(0x50 | (dst.reg & 7)));
+            break;
+        case Mnemonic::LEAVE:
+            _byte(0xC9);
+            break;
+        case Mnemonic::RET:
+            _byte(0xC3);
+            break;
+        case Mnemonic::SYSCALL:
+            _byte(0x0F);
+            _byte(0x05);
+            break;
+        default:
+            throw exception::Error("x86_64::Assembler::_encode", "unsupported mnemonic ", static_cast<u32>(instruction.mnemonic));
+    }
+}
+
+/**
+ * @brief encode alu
+ * @info add/or/and/sub/cmp share their encodings: `op r/m, r`, `op r, r/m` and `op r/m, imm` with a /digit,
+ * plus a one byte shorter `op eax, imm32`
+ */
+void cplus::x86_64::Assembler::_encode_alu(const MachineInstruction &instruction, const u8 rm_r, const u8 r_rm, const u8 digit)
+{
+    const MachineOperand &dst = instruction.dst;
+    const MachineOperand &src = instruction.src;
+    const bool wide = dst.size == 8;
+
+    if (src.is_register()) {
+        _rex(wide, src.reg, dst);
+        _byte(rm_r);
+        _modrm(src.reg, dst);
+    } else if ((src.is_memory() || src.is_global()) && dst.is_register()) {
+        _rex(wide, dst.reg, src);
+        _byte(r_rm);
+        _modrm(dst.reg, src);
+    } else if (src.kind == MachineOperand::IMMEDIATE && _fits_i8(src.value)) {
+        _rex(wide, 0, dst);
+        _byte(0x83);
+        _modrm(digit, dst);
+        _byte(static_cast<u8>(src.value));
+    } else if (src.is_immediate() && dst.is_register() && dst.reg == RAX) {
+        _rex(wide, 0, dst);
+        _byte(static_cast<u8>(digit << 3 | 0x05));
+        _immediate32(src);
+    } else if (src.is_immediate()) {
+        _rex(wide, 0, dst);
+        _byte(0x81);
+        _modrm(digit, dst);
+        _immediate32(src);
+    } else {
+        throw exception::Error("x86_64::Assembler::_encode_alu", "unsupported operand combination");
+    }
+}
+
+void cplus::x86_64::Assembler::_encode_mov(const MachineInstruction &instruction)
+{
+    const MachineOperand &dst = instruction.dst;
+    const MachineOperand &src = instruction.src;
+    const bool wide = dst.size == 8;
+
+    if (src.is_register()) {
+        _rex(wide, src.reg, dst);
+        _byte(0x89);
+        _modrm(src.reg, dst);
+    } else if ((src.is_memory() || src.is_global()) && dst.is_register()) {
+        _rex(wide, dst.reg, src);
+        _byte(0x8B);
+        _modrm(dst.reg, src);
+    } else if (src.is_immediate() && dst.is_register() && !wide) {
+        _rex(false, 0, dst);
+        _byte(static_cast<u8>(0xB8 | (dst.reg & 7)));
+        _immediate32(src);
+    } else if (src.is_immediate()) {
+        _rex(wide, 0, dst);
+        _byte(0xC7);
+        _modrm(0, dst);
+        _immediate32(src);
+    } else {
+        throw exception::Error("x86_64::Assembler::_encode_mov", "unsupported operand combination");
+    }
+}
+
+void cplus::x86_64::Assembler::_encode_imul(const MachineInstruction &instruction)
+{
+    const MachineOperand &dst = instruction.dst;
+    const MachineOperand &src = instruction.src;
+    const bool wide = dst.size == 8;
+
+    if (!dst.is_register()) {
+        throw exception::Error("x86_64::Assembler::_encode_imul", "imul needs a register destination");
+    }
+    if (src.kind == MachineOperand::IMMEDIATE) {
+        _rex(wide, dst.reg, dst);
+        _byte(_fits_i8(src.value) ? 0x6B : 0x69);
+        _modrm(dst.reg, dst);
+        if (_fits_i8(src.value)) {
+            _byte(static_cast<u8>(src.value));
+        } else {
+            _immediate32(src);
+        }
+        return;
+    }
+    _rex(wide, dst.reg, src);
+    _byte(0x0F);
+    _byte(0xAF);
+    _modrm(dst.reg, src);
+}
+
+/**
+ * @brief encode jump
+ * @info `jmp qword ptr [table + reg * 8]` is FF /4 with a SIB byte (no base, disp32), the table address is relocated.
+ * a tail call `jmp symbol` is relocated like a call and never shortened
+ */
+void cplus::x86_64::Assembler::_encode_jump(const MachineInstruction &instruction, const u64 index)
+{
+    const bool wide = _wide[index];
+    const u8 cc = static_cast<u8>(instruction.condition);
+
+    if (instruction.dst.kind == MachineOperand::TABLE) {
+        const u8 reg = instruction.dst.reg;
+        const u32 table = instruction.dst.index();
+
+        if (reg >= R8) {
+            _byte(0x42);
+        }
+        _byte(0xFF);
+        _byte(0x24);
+        _byte(static_cast<u8>(0xC0 | (reg & 7) << 3 | 0x05));
+        _relocate(_table_symbols[table], R_X86_64_32S, static_cast<i64>(_table_offsets[table]));
+        return;
+    }
+    if (instruction.dst.kind == MachineOperand::SYMBOL) {
+        _byte(0xE9);
+        _relocate(_symbol_index[instruction.dst.index()], R_X86_64_PLT32, -4);
+        return;
+    }
+
+    if (instruction.mnemonic == Mnemonic::JMP) {
+        _byte(wide ? 0xE9 : 0xEB);
+    } else if (wide) {
+        _byte(0x0F);
+        _byte(static_cast<u8>(0x80 | cc));
+    } else {
+        _byte(static_cast<u8>(0x70 | cc));
+    }
+
+    _fixups.push_back({.at = _object.sections[_text].data.size(), .label = instruction.dst.index(), .instruction = index, .wide = wide});
+    if (wide) {
+        _dword(0);
+    } else {
+        _byte(0);
+    }
+}
+
+void cplus::x86_64::Assembler::_byte(const u8 byte)
+{
+    _object.sections[_text].data.push_back(byte);
+}
+
+void cplus::x86_64::Assembler::_dword(const u32 dword)
+{
+    for (u32 i = 0; i < 4; ++i) {
+        _byte(static_cast<u8>(dword >> (8 * i)));
+    }
+}
+
+/**
+ * @brief relocate
+ * @info a dword left to the linker: the relocation points at the current offset of .text, a zero holds its place
+ */
+void cplus::x86_64::Assembler::_relocate(const u32 symbol, const u32 type, const i64 addend)
+{
+    auto &text = _object.sections[_text];
+
+    text.relocations.push_back({.offset = text.data.size(), .symbol = symbol, .type = type, .addend = addend});
+    _dword(0);
+}
+
+/**
+ * @brief rex
+ * @info emitted only when needed: 64-bit operand size, an extended register, or spl/bpl/sil/dil
+ */
+void cplus::x86_64::Assembler::_rex(const bool wide, const u8 reg, const MachineOperand &rm)
+{
+    const bool extended_rm = (rm.is_register() || rm.is_memory()) && rm.reg >= R8;
+    const bool extended_index = (rm.is_memory() || rm.is_global()) && rm.index_reg != NO_REGISTER && rm.index_reg >= R8;
+    const bool byte_register = rm.is_register() && rm.size == 1 && rm.reg >= RSP && rm.reg <= RDI;
+    const u8 rex =
+        static_cast<u8>(0x40 | (wide ? 8 : 0) | (reg >= R8 ? 4 : 0) | (extended_index ? 2 : 0) | (extended_rm ? 1 : 0));
+
+    if (rex != 0x40 || byte_register) {
+        _byte(rex);
+    }
+}
+
+/**
+ * @brief modrm
+ * @info register direct, or [base + index * scale + disp] with the shortest displacement. an index, or a rsp/r12 base,
+ * needs a SIB byte and rbp/r13 bases always carry a displacement. a global is [index * 4 + disp32] without base,
+ * the displacement being its relocated address
+ */
+void cplus::x86_64::Assembler::_modrm(const u8 reg, const MachineOperand &rm)
+{
+    const u8 reg_bits = static_cast<u8>((reg & 7) << 3);
+    const u8 base = static_cast<u8>(rm.reg & 7);
+
+    if (rm.is_register()) {
+        _byte(static_cast<u8>(0xC0 | reg_bits | base));
+        return;
+    }
+    if (rm.is_global()) {
+        _byte(static_cast<u8>(reg_bits | 0x04));
+        _byte(static_cast<u8>(0x80 | (rm.index_reg & 7) << 3 | 0x05));
+        _relocate(_bss_symbol, R_X86_64_32S, static_cast<i64>(_global_offsets[rm.index()]));
+        return;
+    }
+
+    const bool no_disp = rm.value == 0 && base != RBP;
+    const u8 mod = no_disp ? 0x00 : (_fits_i8(rm.value) ? 0x40 : 0x80);
+
+    if (rm.index_reg != NO_REGISTER) {
+        const u8 scale = static_cast<u8>(rm.scale == 8 ? 3 : rm.scale == 4 ? 2 : rm.scale == 2 ? 1 : 0);
+
+        _byte(static_cast<u8>(mod | reg_bits | 0x04));
+        _byte(static_cast<u8>(scale << 6 | (rm.index_reg & 7) << 3 | base));
+    } else {
+        _byte(static_cast<u8>(mod | reg_bits | base));
+        if (base == RSP) {
+            _byte(0x24);
+        }
+    }
+    if (mod == 0x40) {
+        _byte(static_cast<u8>(rm.value));
+    } else if (mod == 0x80) {
+        _dword(static_cast<u32>(rm.value));
+    }
+}
+
+/**
+ * @brief immediate32
+ * @info string addresses become R_X86_64_32 relocations against .rodata, the image is linked below 4GiB
+ */
+void cplus::x86_64::Assembler::_immediate32(const MachineOperand &operand)
+{
+    if (operand.kind == MachineOperand::STRING) {
+        _relocate(_rodata_symbol, R_X86_64_32, static_cast<i64>(_string_offsets[operand.index()]));
+        return;
+    }
+    _dword(static_cast<u32>(operand.value));
+}
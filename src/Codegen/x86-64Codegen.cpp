@@ -1,270 +1,272 @@
 #include <CPlus/Codegen/x86-64Codegen.hpp>
+#include <CPlus/Error.hpp>
 
-#include <regex>
-#include <sstream>
+#include <algorithm>
 
 /**
  * public
  */
 
-const std::string cplus::x86_64::Codegen::run(const std::string &ir)
+cplus::x86_64::Codegen::Codegen(const OptLevel level) : _level(level)
 {
-    _ir = std::move(ir);
-    _output.clear();
+    /* __ctor__ */
+}
+
+cplus::x86_64::MachineModule cplus::x86_64::Codegen::run(const ir::Module &module)
+{
+    _module = &module;
+    _output = MachineModule{};
+    _output.name = module.name;
+    _output.strings = module.strings;
+    for (const auto &global : module.globals) {
+        _output.globals.push_back({.name = global.name, .size = static_cast<u64>(global.size) * 4});
+    }
+    _output.function_alignment = _level == OPT_O2 || _level == OPT_O3 ? FUNCTION_ALIGNMENT : 1;
     _stack_offset = 0;
+    _local_labels = 0;
 
-    _prologue();
     _generate();
-    _epilogue();
 
-    return _output;
+    _module = nullptr;
+    return std::move(_output);
 }
 
 /**
  * helpers
  */
 
-static constexpr const std::string REGISTERS[6] = {"edi", "esi", "edx", "ecx", "r8d", "r9d"};
+using cplus::x86_64::MachineOperand;
+
+static constexpr MachineOperand eax = MachineOperand::r(cplus::x86_64::RAX);
+static constexpr MachineOperand ecx = MachineOperand::r(cplus::x86_64::RCX);
+static constexpr MachineOperand edx = MachineOperand::r(cplus::x86_64::RDX);
+static constexpr MachineOperand al = MachineOperand::r(cplus::x86_64::RAX, 1);
+static constexpr MachineOperand rax = MachineOperand::r(cplus::x86_64::RAX, 8);
+static constexpr MachineOperand rbp = MachineOperand::r(cplus::x86_64::RBP, 8);
+static constexpr MachineOperand rsp = MachineOperand::r(cplus::x86_64::RSP, 8);
 
-static constexpr const std::string _get_compare_instruction(const std::string &op)
+static constexpr cplus::x86_64::Condition _get_compare_condition(const cplus::ir::Opcode op)
 {
-    if (op == "icmp.eq") {
-        return "sete";
-    }
-    if (op == "icmp.ne") {
-        return "setne";
-    }
-    if (op == "icmp.slt") {
-        return "setl";
-    }
-    if (op == "icmp.sle") {
-        return "setle";
-    }
-    if (op == "icmp.sgt") {
-        return "setg";
-    }
-    if (op == "icmp.sge") {
-        return "setge";
+    switch (op) {
+        case cplus::ir::Opcode::ICMP_EQ:
+            return cplus::x86_64::Condition::E;
+        case cplus::ir::Opcode::ICMP_NE:
+            return cplus::x86_64::Condition::NE;
+        case cplus::ir::Opcode::ICMP_SLT:
+            return cplus::x86_64::Condition::L;
+        case cplus::ir::Opcode::ICMP_SLE:
+            return cplus::x86_64::Condition::LE;
+        case cplus::ir::Opcode::ICMP_SGT:
+            return cplus::x86_64::Condition::G;
+        case cplus::ir::Opcode::ICMP_SGE:
+            return cplus::x86_64::Condition::GE;
+        default:
+            return cplus::x86_64::Condition::E;
     }
-    return "sete";
 }
 
-static const std::string _get_module_name(const std::string &ir)
+/** @brief the condition holding when the operands of the comparison are swapped */
+static constexpr cplus::x86_64::Condition _swap_condition(const cplus::x86_64::Condition condition)
 {
-    const cplus::u64 module = ir.find("module ");
-
-    if (module == std::string::npos) {
-        return "";
+    switch (condition) {
+        case cplus::x86_64::Condition::L:
+            return cplus::x86_64::Condition::G;
+        case cplus::x86_64::Condition::LE:
+            return cplus::x86_64::Condition::GE;
+        case cplus::x86_64::Condition::G:
+            return cplus::x86_64::Condition::L;
+        case cplus::x86_64::Condition::GE:
+            return cplus::x86_64::Condition::LE;
+        case cplus::x86_64::Condition::B:
+            return cplus::x86_64::Condition::A;
+        case cplus::x86_64::Condition::BE:
+            return cplus::x86_64::Condition::AE;
+        case cplus::x86_64::Condition::A:
+            return cplus::x86_64::Condition::B;
+        case cplus::x86_64::Condition::AE:
+            return cplus::x86_64::Condition::BE;
+        default:
+            return condition;
     }
-
-    const cplus::u64 start = module + 7;
-    const cplus::u64 end = ir.find_first_of("\n\r\t", start);
-
-    if (end == std::string::npos) {
-        return ir.substr(start);
-    }
-
-    return ir.substr(start, end - start);
 }
 
-static inline void _trim(std::string &s)
+/** @brief condition codes come in pairs differing by their lowest bit */
+static constexpr cplus::x86_64::Condition _invert_condition(const cplus::x86_64::Condition condition)
 {
-    const cplus::u64 first = s.find_first_not_of(" \t\n\r");
-    const cplus::u64 last = s.find_last_not_of(" \t\n\r");
+    return static_cast<cplus::x86_64::Condition>(static_cast<cplus::u8>(condition) ^ 1);
+}
 
-    if (first == std::string::npos || last == std::string::npos) {
-        s.clear();
-    } else {
-        s = s.substr(first, last - first + 1);
-    }
+static constexpr bool _fits_i32(const cplus::i64 value)
+{
+    return value >= -2147483648ll && value <= 2147483647ll;
 }
 
-/**
- * @brief count slots
- * @info counts every slots except immediates/temporary values
- * TODO: no regex maybe std::string_view for faster iteration
- */
-static cplus::u64 _count_slots(const std::string_view body)
+/** @brief scale of a `mul` by 2, 4 or 8 and the operand it scales, 0 for any other instruction */
+static cplus::u8 _get_scale(const cplus::ir::Instruction &instruction, cplus::ir::Operand &scaled)
 {
-    const std::regex slot_re(R"(%([a-zA-Z0-9_]+)\s*=\s*(.*))");
-    std::smatch match;
-    cplus::u64 count = 0;
-    const std::string s{body};
-    std::string::const_iterator search(s.cbegin());
+    if (instruction.opcode != cplus::ir::Opcode::MUL) {
+        return 0;
+    }
 
-    while (std::regex_search(search, s.cend(), match, slot_re)) {
-        const std::string var = match[1];
-        const std::string rhs = match[2];
+    const bool right = instruction.operands[1].is_immediate();
+    const cplus::ir::Operand &factor = instruction.operands[right ? 1 : 0];
 
-        if (var.size() > 1 && (var[0] == 'n' && isdigit(var[1]))) {
-            search = match.suffix().first;
-            continue;
-        }
-        if (var.size() > 1 && (var[0] == 't' || rhs.find("call") == std::string::npos)) {
-            search = match.suffix().first;
-            continue;
-        }
-        ++count;
-        search = match.suffix().first;
+    if (!factor.is_immediate() || (factor.data != 2 && factor.data != 4 && factor.data != 8)) {
+        return 0;
     }
-
-    return count;
+    scaled = instruction.operands[right ? 0 : 1];
+    return static_cast<cplus::u8>(factor.data);
 }
 
 /**
  * @brief function set stack offset
- * @info align the stack with %16 according to ABI System V convention
+ * @info callee-saved registers are saved in qwords right below rbp, followed by the dword spill slots,
+ * align the stack with %16 according to ABI System V convention
  */
-static inline void _function_set_stack_offset(cplus::u64 *offset, const std::string &ir, const std::string &current_function)
+static inline void _function_set_stack_offset(cplus::u64 *offset, const cplus::x86_64::RegisterAllocator &allocator)
 {
-    const cplus::u64 start = ir.find('{', ir.find("func @" + current_function));
-    const cplus::u64 end = ir.find('}', start);
-
-    if (start == std::string::npos || end == std::string::npos) {
-        *offset = 0;
-        return;
-    }
+    const cplus::u64 stack_size = allocator.callee_saved().size() * 8 + allocator.spill_slots() * 4;
 
-    const std::string_view body{ir.data() + start + 1, end - start - 1};
-    const cplus::u64 slots = _count_slots(body);
-    const cplus::u64 stack_size = slots * 8;
-    const cplus::u64 total_before_call = stack_size + 16;
-    cplus::u64 padding = (16 - (total_before_call % 16)) % 16;
-    const bool is_recursive = body.find("call @" + current_function) != std::string::npos;
-
-    if (is_recursive && (stack_size % 16 == 0)) {
-        padding += 8;
-    }
-
-    *offset = stack_size + padding;
+    *offset = (stack_size + 15) & ~static_cast<cplus::u64>(15);
 }
 
 /**
  * private
  */
 
-void cplus::x86_64::Codegen::_emit(const std::string &s)
+void cplus::x86_64::Codegen::_emit(const Mnemonic mnemonic, const MachineOperand &dst, const MachineOperand &src)
 {
-    _output += s;
-    _output += '\n';
+    _machine->instructions.push_back({.mnemonic = mnemonic, .condition = Condition::E, .dst = dst, .src = src});
 }
 
-void cplus::x86_64::Codegen::_prologue()
+void cplus::x86_64::Codegen::_emit(const Condition condition, const Mnemonic mnemonic, const MachineOperand &dst)
 {
-    _emit("# x86-64 Intel Assembly generated by CPlus Compiler");
-    _emit("\t.intel_syntax\tnoprefix");
-    _emit("\t.file\t\t\t\"" + _get_module_name(_ir) + "\"");
-    _emit("\t.section\t\t.text\n");
+    _machine->instructions.push_back({.mnemonic = mnemonic, .condition = condition, .dst = dst, .src = {}});
 }
 
-void cplus::x86_64::Codegen::_epilogue()
+void cplus::x86_64::Codegen::_generate()
 {
-    _emit("\n.globl\t\t\t_start");
-    _emit("_start:");
-    _emit("\tcall\tmain");
-    _emit("\tmov\t\trdi, rax");
-    _emit("\tmov\t\trax, 60");
-    _emit("\tsyscall");
+    for (const auto &function : _module->functions) {
+        _emit_function(function);
+    }
 }
 
 /**
- * @brief get stack location
- * @info returns the stack location of a variable, if not found, allocates a new slot
+ * @brief get location
+ * @info returns the register or the spill slot the allocator gave to a value
  */
-const std::string cplus::x86_64::Codegen::_get_stack_location(const std::string &var)
+const MachineOperand &cplus::x86_64::Codegen::_get_location(const ir::ValueId value) const
 {
-    if (_var_locations.find(var) == _var_locations.end()) {
-        _var_locations[var] = "dword ptr [rbp" + std::to_string(_next_stack_offset) + "]";
-        _next_stack_offset -= 4;
-    }
-    return _var_locations[var];
+    return _var_locations[value];
 }
 
 /**
  * @brief parse operand
  * @info as the title says
  */
-const std::string cplus::x86_64::Codegen::_get_operand(const std::string &operand)
+MachineOperand cplus::x86_64::Codegen::_get_operand(const ir::Operand &operand) const
 {
-    std::string op = operand;
-    _trim(op);
-
-    if (op.starts_with("imm.i32 ")) {
-        return op.substr(8);
-    }
-    if (op.starts_with("imm.bool ")) {
-        return op.substr(9);
-    }
-    if (op.starts_with("const.i32")) {
-        return op.substr(9);
-    }
-    if (op.starts_with("%")) {
-        return _get_stack_location(op);
+    switch (operand.kind) {
+        case ir::Operand::VALUE:
+            return _get_location(operand.id());
+        case ir::Operand::IMMEDIATE:
+            return MachineOperand::imm(operand.data);
+        case ir::Operand::STRING:
+            return MachineOperand::string(operand.id());
+        case ir::Operand::BLOCK:
+            return _get_label(operand.id());
+        case ir::Operand::NONE:
+        default:
+            return MachineOperand::imm(0);
     }
-    return op;
 }
 
-void cplus::x86_64::Codegen::_generate()
+MachineOperand cplus::x86_64::Codegen::_get_label(const ir::BlockId block) const
 {
-    std::istringstream stream(_ir);
-    std::string line;
+    return MachineOperand::label(block);
+}
 
-    while (std::getline(stream, line)) {
-        _trim(line);
-        _generate_line(line);
+/**
+ * @brief get edge label
+ * @info where a branch of the current block goes to reach block: its stub when the edge carries phi copies
+ */
+MachineOperand cplus::x86_64::Codegen::_get_edge_label(const ir::BlockId block) const
+{
+    for (const auto &[target, stub] : _edge_stubs) {
+        if (target == block) {
+            return stub;
+        }
     }
+    return _get_label(block);
 }
 
 /**
- * @brief generate line
- * @info emits line to valid Intel x86-64
+ * @brief new label
+ * @info a label that is not a block, e.g. inside a switch dispatch, numbered across the module to stay unique
  */
-void cplus::x86_64::Codegen::_generate_line(const std::string &line)
+MachineOperand cplus::x86_64::Codegen::_new_label(const std::string &name)
 {
-    if (line.empty() || line.starts_with(";")) {
-        return;
-    }
+    _machine->labels.push_back(".L" + name + std::to_string(_local_labels++));
+    return MachineOperand::label(static_cast<u32>(_machine->labels.size() - 1));
+}
+
+/**
+ * @brief get symbol
+ * @info interns a call target in the module symbol table
+ */
+MachineOperand cplus::x86_64::Codegen::_get_symbol(const std::string &name)
+{
+    auto &symbols = _output.symbols;
+    const auto it = std::find(symbols.begin(), symbols.end(), name);
 
-    if (line.starts_with("%") && line.find(" = ") != std::string::npos) {
-        _emit_assignement(line);
-    } else if (line.starts_with("func ")) {
-        _emit_function_declaration(line);
-    } else if (line == "{") {
-        _emit_function_start();
-    } else if (line == "}") {
-        _emit_function_end();
-    } else if (line.starts_with("label %")) {
-        _emit_label(line);
-    } else if (line.starts_with("br")) {
-        _emit_branch(line);
-    } else if (line.starts_with("ret")) {
-        _emit_return(line);
+    if (it != symbols.end()) {
+        return MachineOperand::symbol(static_cast<u32>(it - symbols.begin()));
     }
+    symbols.push_back(name);
+    return MachineOperand::symbol(static_cast<u32>(symbols.size() - 1));
 }
 
 /**
- * @brief function prologue
+ * @brief function
  * @info let the function "hello_world":
  *
  * .globl			hello_world
  * hello_world:
  */
-void cplus::x86_64::Codegen::_emit_function_declaration(const std::string &line)
+void cplus::x86_64::Codegen::_emit_function(const ir::Function &function)
 {
-    const std::string_view sv(line);
-    const u64 start = 6;
-    const u64 end = sv.find('(', start);
-
-    if (end == std::string::npos) {
-        return;
+    _function = &function;
+    _allocator.emplace(function, _level != OPT_O0);
+    _uses.assign(function.values, 0);
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            for (const auto &operand : instruction.operands) {
+                if (operand.is_value()) {
+                    ++_uses[operand.id()];
+                }
+            }
+        }
+    }
+    _machine = &_output.functions.emplace_back();
+    _machine->name = function.name;
+    for (const auto &block : function.blocks) {
+        _machine->labels.push_back(".L" + std::string(block.name) + std::to_string(block.label));
     }
+    _function_set_stack_offset(&_stack_offset, *_allocator);
+    _emit_function_start();
 
-    const std::string_view func_name = sv.substr(start, end - start);
+    for (_block_index = 0; _block_index < function.blocks.size(); ++_block_index) {
+        if (_block_index) {
+            _emit_label(static_cast<ir::BlockId>(_block_index));
+        }
+        for (_instruction_index = 0; _instruction_index < function.blocks[_block_index].instructions.size(); ++_instruction_index) {
+            if (!_is_folded(function.blocks[_block_index], _instruction_index)) {
+                _emit_instruction(function.blocks[_block_index].instructions[_instruction_index]);
+            }
+        }
+    }
 
-    _current_function = std::string(func_name);
-    _emit(".globl\t\t\t" + _current_function);
-    _emit(_current_function + ":");
-    _function_set_stack_offset(&_stack_offset, _ir, _current_function);
+    _emit_function_end();
 }
 
 /**
@@ -274,344 +276,942 @@ void cplus::x86_64::Codegen::_emit_function_declaration(const std::string &line)
  * push    rbp
  * mov     rbp, rsp
  * sub     rsp, sizeof(stack_offset)%16
+ * mov     qword ptr [rbp-8], rbx     (each used callee-saved register)
  */
 void cplus::x86_64::Codegen::_emit_function_start()
 {
-    _emit("\tpush\trbp");
-    _emit("\tmov\t\trbp, rsp");
+    const auto &saved = _allocator->callee_saved();
+    const i64 spill_base = static_cast<i64>(saved.size()) * 8;
+
+    _emit(Mnemonic::PUSH, rbp);
+    _emit(Mnemonic::MOV, rbp, rsp);
     if (_stack_offset > 0) {
-        _emit("\tsub\t\trsp, " + std::to_string(_stack_offset));
+        _emit(Mnemonic::SUB, rsp, MachineOperand::imm(static_cast<i64>(_stack_offset)));
+    }
+    for (u64 i = 0; i < saved.size(); ++i) {
+        _emit(Mnemonic::MOV, MachineOperand::mem(RBP, -static_cast<i64>((i + 1) * 8), 8), MachineOperand::r(saved[i], 8));
+    }
+
+    _var_locations.assign(_function->values, MachineOperand{});
+    for (ir::ValueId value = 0; value < _function->values; ++value) {
+        const Location &location = _allocator->location(value);
+
+        if (location.is_register()) {
+            _var_locations[value] = MachineOperand::r(location.reg);
+        } else {
+            _var_locations[value] = MachineOperand::mem(RBP, -(spill_base + (location.slot + 1) * 4));
+        }
+    }
+}
+
+/**
+ * @brief restore callee saved
+ * @info reloads the callee-saved registers right before leaving the frame
+ */
+void cplus::x86_64::Codegen::_emit_restore_callee_saved()
+{
+    const auto &saved = _allocator->callee_saved();
+
+    for (u64 i = 0; i < saved.size(); ++i) {
+        _emit(Mnemonic::MOV, MachineOperand::r(saved[i], 8), MachineOperand::mem(RBP, -static_cast<i64>((i + 1) * 8), 8));
     }
-    _register_index = 0;
-    _var_locations.clear();
-    _next_stack_offset = -4;
 }
 
 /**
  * @brief function end
- * @info just clear the stack 
+ * @info just clear the stack
  */
 void cplus::x86_64::Codegen::_emit_function_end()
 {
-    _emit("");
-    _current_function.clear();
+    _machine = nullptr;
+    _function = nullptr;
     _stack_offset = 0;
-    _register_index = 0;
     _var_locations.clear();
+    _allocator.reset();
 }
 
 /**
  * @brief emit label
- * @info let label %if.then0:
+ * @info let the block if.then0:
  *
  * .Lif.then0:
  */
-void cplus::x86_64::Codegen::_emit_label(const std::string &line)
+void cplus::x86_64::Codegen::_emit_label(const ir::BlockId block)
 {
-    std::string label = line.substr(6);
+    _emit(Mnemonic::LABEL, _get_label(block));
+}
 
-    if (!label.empty() && label.back() == ':') {
-        label.pop_back();
-    }
-    if (label.starts_with('%')) {
-        label = label.substr(1);
+/**
+ * @brief emit instruction
+ * @info dispatches on the opcode, results are always saved to the destination value's slot
+ */
+void cplus::x86_64::Codegen::_emit_instruction(const ir::Instruction &instruction)
+{
+    switch (instruction.opcode) {
+        case ir::Opcode::ARG:
+            _emit_arg_load(instruction);
+            break;
+        case ir::Opcode::MOV:
+            _emit_mov(instruction.result, instruction.operands[0]);
+            break;
+        case ir::Opcode::UNDEF:
+            break;
+        case ir::Opcode::ADD:
+            if (!_emit_address_arithmetic(instruction)) {
+                _emit_binary_op(instruction, Mnemonic::ADD);
+            }
+            break;
+        case ir::Opcode::SUB:
+            if (!_emit_address_arithmetic(instruction)) {
+                _emit_binary_op(instruction, Mnemonic::SUB);
+            }
+            break;
+        case ir::Opcode::MUL:
+            if (!_emit_address_arithmetic(instruction)) {
+                _emit_binary_op(instruction, Mnemonic::IMUL);
+            }
+            break;
+        case ir::Opcode::AND:
+            _emit_binary_op(instruction, Mnemonic::AND);
+            break;
+        case ir::Opcode::OR:
+            _emit_binary_op(instruction, Mnemonic::OR);
+            break;
+        case ir::Opcode::SDIV:
+            _emit_div(instruction);
+            break;
+        case ir::Opcode::SREM:
+            _emit_div(instruction, true);
+            break;
+        case ir::Opcode::NEG:
+            _emit_unary_op(instruction, Mnemonic::NEG);
+            break;
+        case ir::Opcode::ICMP_EQ:
+        case ir::Opcode::ICMP_NE:
+        case ir::Opcode::ICMP_SLT:
+        case ir::Opcode::ICMP_SLE:
+        case ir::Opcode::ICMP_SGT:
+        case ir::Opcode::ICMP_SGE:
+            _emit_compare(instruction);
+            break;
+        case ir::Opcode::LOAD:
+            _emit_load(instruction);
+            break;
+        case ir::Opcode::STORE:
+            _emit_store(instruction);
+            break;
+        case ir::Opcode::CALL:
+            _emit_call_instruction(instruction);
+            break;
+        case ir::Opcode::PHI:
+            _emit_phi(instruction);
+            break;
+        case ir::Opcode::BR:
+            _emit_branch(instruction);
+            break;
+        case ir::Opcode::JMP:
+            _emit_parallel_copy(_get_edge_copies(static_cast<ir::BlockId>(_block_index), instruction.operands[0].id()));
+            _emit_jump(instruction.operands[0].id());
+            break;
+        case ir::Opcode::SWITCH:
+            _emit_switch(instruction);
+            break;
+        case ir::Opcode::RET:
+            _emit_return(instruction);
+            break;
+        default:
+            throw exception::Error("x86_64::Codegen::_emit_instruction", "unsupported opcode ", ir::to_string(instruction.opcode));
     }
-    _emit(".L" + label + ":");
 }
 
 /**
  * @brief emit call instruction
- * @info called by _emit_assignement to handle the "call @..." expression
- * let the result of the call in `eax` register
+ * @info the first 6 arguments go through registers, set at once by a parallel copy since a value may already live in
+ * the register of another argument, the others are pushed right to left. the result is immediately saved from `eax`
+ * to the dest value's slot
  */
-void cplus::x86_64::Codegen::_emit_call_instruction(const std::string &call_expr)
+void cplus::x86_64::Codegen::_emit_call_instruction(const ir::Instruction &instruction)
 {
-    const u64 at_pos = call_expr.find('@');
-    const u64 paren_start = call_expr.find('(', at_pos);
-    const u64 paren_end = call_expr.find(')', paren_start);
+    const auto &args = instruction.operands;
+    const u64 stack_args = args.size() > 6 ? args.size() - 6 : 0;
+    const u64 padding = (stack_args % 2) * 8;
 
-    if (at_pos == std::string::npos || paren_start == std::string::npos || paren_end == std::string::npos) {
-        return;
+    if (padding) {
+        _emit(Mnemonic::SUB, rsp, MachineOperand::imm(static_cast<i64>(padding)));
+    }
+    for (u64 i = args.size(); i > 6; --i) {
+        _emit(Mnemonic::MOV, eax, _get_operand(args[i - 1]));
+        _emit(Mnemonic::PUSH, rax);
     }
 
-    const std::string func_name = call_expr.substr(at_pos + 1, paren_start - at_pos - 1);
-    const std::string args_str = call_expr.substr(paren_start + 1, paren_end - paren_start - 1);
-
-    /** @brief get args */
-    std::vector<std::string> args;
-    if (!args_str.empty()) {
-        std::istringstream ss(args_str);
-        std::string arg;
+    _emit_parallel_copy(_get_argument_copies(args));
+    _emit(Mnemonic::CALL, _get_symbol(_module->functions[instruction.callee].name));
 
-        while (std::getline(ss, arg, ',')) {
-            _trim(arg);
-            if (!arg.empty()) {
-                args.push_back(arg);
-            }
-        }
+    if (stack_args) {
+        _emit(Mnemonic::ADD, rsp, MachineOperand::imm(static_cast<i64>(stack_args * 8 + padding)));
     }
+    _emit(Mnemonic::MOV, _get_location(instruction.result), eax);
+}
 
-    /** @brief and emit them according to their register */
-    for (u64 i = 0; i < args.size() && i < 6; ++i) {
-        const std::string arg_parsed = _get_operand(args[i]);
-        const std::string reg32 = REGISTERS[i];
+/**
+* @brief get global
+* @info `dword ptr [global + index * 4]`, an index that is not in a register is loaded into `ecx`: a dword register
+* write clears the upper half, so the register can scale as a qword
+*/
+MachineOperand cplus::x86_64::Codegen::_get_global(const ir::Operand &global, const ir::Operand &index)
+{
+    MachineOperand location = _get_operand(index);
 
-        if (arg_parsed.find('[') != std::string::npos) {
-            _emit("\tmov\t\teax, " + arg_parsed);
-            _emit("\tmov\t\t" + reg32 + ", eax");
-        } else {
-            _emit("\tmov\t\t" + reg32 + ", " + arg_parsed);
-        }
+    if (!location.is_register()) {
+        _emit(Mnemonic::MOV, ecx, location);
+        location = ecx;
     }
-
-    _emit("\tcall\t" + func_name);
+    return MachineOperand::global(global.id(), location.reg);
 }
 
 /**
- * @brief emit assignement
- * @info if the right-hand is a `call`, emits the call & immediatly saves the result from `eax` to the dest variable's slot.
- */
-void cplus::x86_64::Codegen::_emit_assignement(const std::string &line)
+* @brief emit load
+* @info `%d = load @global, index`, through `eax` when %d was spilled
+*/
+void cplus::x86_64::Codegen::_emit_load(const ir::Instruction &instruction)
 {
-    const u64 eq_pos = line.find('=');
+    const MachineOperand source = _get_global(instruction.operands[0], instruction.operands[1]);
+    const MachineOperand &dest_loc = _get_location(instruction.result);
 
-    if (eq_pos == std::string::npos) {
+    if (dest_loc.is_register()) {
+        _emit(Mnemonic::MOV, dest_loc, source);
         return;
     }
+    _emit(Mnemonic::MOV, eax, source);
+    _emit(Mnemonic::MOV, dest_loc, eax);
+}
+
+/**
+* @brief emit store
+* @info `store @global, index, a`, through `eax` when a was spilled
+*/
+void cplus::x86_64::Codegen::_emit_store(const ir::Instruction &instruction)
+{
+    const MachineOperand dest = _get_global(instruction.operands[0], instruction.operands[1]);
+    const MachineOperand value = _get_operand(instruction.operands[2]);
 
-    std::string lhs = line.substr(0, eq_pos);
-    std::string rhs = line.substr(eq_pos + 2);
-    _trim(lhs);
-    _trim(rhs);
-
-    if (rhs.starts_with("call @")) {
-        _emit_call_instruction(rhs);
-        const std::string dest_loc = _get_stack_location(lhs);
-        _emit("\tmov\t\t" + dest_loc + ", eax");
-    } else if (rhs.starts_with("mov ")) {
-        _emit_mov(lhs, rhs.substr(4));
-    } else if (rhs.starts_with("add ")) {
-        _emit_binary_op(lhs, rhs, "add");
-    } else if (rhs.starts_with("sub ")) {
-        _emit_binary_op(lhs, rhs, "sub");
-    } else if (rhs.starts_with("mul ")) {
-        _emit_binary_op(lhs, rhs, "imul");
-    } else if (rhs.starts_with("sdiv ")) {
-        _emit_div(lhs, rhs);
-    } else if (rhs.starts_with("srem ")) {
-        _emit_div(lhs, rhs, true);
-    } else if (rhs.starts_with("icmp.")) {
-        _emit_compare(lhs, rhs);
-    } else if (rhs.starts_with("neg ")) {
-        _emit_unary_op(lhs, rhs, "neg");
-    } else if (rhs.starts_with("and ")) {
-        _emit_binary_op(lhs, rhs, "and");
-    } else if (rhs.starts_with("or ")) {
-        _emit_binary_op(lhs, rhs, "or");
-    } else if (rhs.starts_with("arg ")) {
-        _emit_arg_load(lhs, rhs);
-    } else if (rhs.starts_with("phi ")) {
-        _emit_phi(lhs, rhs);
-    } else if (rhs == "undef") {
-        _emit("\t# " + lhs + " = undef");
+    if (value.is_memory()) {
+        _emit(Mnemonic::MOV, eax, value);
+        _emit(Mnemonic::MOV, dest, eax);
+        return;
     }
+    _emit(Mnemonic::MOV, dest, value);
 }
 
 /**
 * @brief emit mov
 * @info if the source is a memory location, uses `eax` as a temporary
 */
-void cplus::x86_64::Codegen::_emit_mov(const std::string &dest, const std::string &src)
+void cplus::x86_64::Codegen::_emit_mov(const ir::ValueId dest, const ir::Operand &src)
 {
-    const std::string src_parsed = _get_operand(src);
-    const std::string dest_loc = _get_stack_location(dest);
+    const MachineOperand src_parsed = _get_operand(src);
+    const MachineOperand &dest_loc = _get_location(dest);
 
-    if (src_parsed.find('[') != std::string::npos) {
-        _emit("\tmov\t\teax, " + src_parsed);
-        _emit("\tmov\t\t" + dest_loc + ", eax");
+    if (src_parsed == dest_loc) {
+        return;
+    }
+    if (src_parsed.is_memory() && dest_loc.is_memory()) {
+        _emit(Mnemonic::MOV, eax, src_parsed);
+        _emit(Mnemonic::MOV, dest_loc, eax);
     } else {
-        _emit("\tmov\t\t" + dest_loc + ", " + src_parsed);
+        _emit(Mnemonic::MOV, dest_loc, src_parsed);
     }
 }
 
 /**
 * @brief emit binary operation
-* @info handles `add`, `sub`, `mul`, `and`, `or`
+* @info handles `add`, `sub`, `mul`, `and`, `or`, computes in place when the result lives in a register,
+* `a - b` into the register of b is `-b + a`, unless a shares that register: `x - x` is zero
 */
-void cplus::x86_64::Codegen::_emit_binary_op(const std::string &dest, const std::string &rhs, const std::string &op)
+void cplus::x86_64::Codegen::_emit_binary_op(const ir::Instruction &instruction, const Mnemonic op)
 {
-    const u64 comma_pos = rhs.find(',');
-
-    if (comma_pos == std::string::npos) {
+    const MachineOperand left_parsed = _get_operand(instruction.operands[0]);
+    const MachineOperand right_parsed = _get_operand(instruction.operands[1]);
+    const MachineOperand &dest_loc = _get_location(instruction.result);
+    const bool commutative = op != Mnemonic::SUB;
+
+    if (dest_loc.is_register() && dest_loc != right_parsed) {
+        if (dest_loc != left_parsed) {
+            _emit(Mnemonic::MOV, dest_loc, left_parsed);
+        }
+        _emit(op, dest_loc, right_parsed);
+        return;
+    }
+    if (dest_loc.is_register() && commutative) {
+        _emit(op, dest_loc, left_parsed);
+        return;
+    }
+    if (dest_loc.is_register() && dest_loc != left_parsed) {
+        _emit(Mnemonic::NEG, dest_loc);
+        _emit(Mnemonic::ADD, dest_loc, left_parsed);
+        return;
+    }
+    if (dest_loc.is_register()) {
+        _emit(Mnemonic::MOV, dest_loc, MachineOperand::imm(0));
         return;
     }
 
-    const std::string op_part = rhs.substr(0, rhs.find(' '));
-    const std::string left_op = rhs.substr(op_part.length() + 1, comma_pos - op_part.length() - 1);
-    const std::string right_op = rhs.substr(comma_pos + 2);
-    const std::string left_parsed = _get_operand(left_op);
-    const std::string right_parsed = _get_operand(right_op);
-    const std::string dest_loc = _get_stack_location(dest);
-
-    _emit("\tmov\t\teax, " + left_parsed);
-    _emit("\t" + op + "\t\teax, " + right_parsed);
-    _emit("\tmov\t\t" + dest_loc + ", eax");
+    _emit(Mnemonic::MOV, eax, left_parsed);
+    _emit(op, eax, right_parsed);
+    _emit(Mnemonic::MOV, dest_loc, eax);
 }
 
 /**
 * @brief emit division
+* @info `idiv` has no immediate form so the divisor goes through `ecx`
 */
-void cplus::x86_64::Codegen::_emit_div(const std::string &dest, const std::string &rhs, const bool is_mod)
+void cplus::x86_64::Codegen::_emit_div(const ir::Instruction &instruction, const bool is_mod)
 {
-    const u64 comma_pos = rhs.find(',');
-
-    if (comma_pos == std::string::npos) {
-        return;
-    }
+    const MachineOperand left_parsed = _get_operand(instruction.operands[0]);
+    const MachineOperand right_parsed = _get_operand(instruction.operands[1]);
+    const MachineOperand &dest_loc = _get_location(instruction.result);
+
+    _emit(Mnemonic::MOV, eax, left_parsed);
+    _emit(Mnemonic::CDQ);
+    _emit(Mnemonic::MOV, ecx, right_parsed);
+    _emit(Mnemonic::IDIV, ecx);
+    _emit(Mnemonic::MOV, dest_loc, is_mod ? edx : eax);
+}
 
-    const std::string left_op = rhs.substr(5, comma_pos - 5);
-    const std::string right_op = rhs.substr(comma_pos + 2);
-    const std::string left_parsed = _get_operand(left_op);
-    const std::string right_parsed = _get_operand(right_op);
-    const std::string dest_loc = _get_stack_location(dest);
+/**
+* @brief emit comparison
+* @info handles `icmp.eq`, `icmp.ne`, `icmp.slt`, `icmp.sle`, `icmp.sgt`, `icmp.sge` whose result is used as a value,
+* see _emit_branch for the comparisons fused with their branch
+*/
+void cplus::x86_64::Codegen::_emit_compare(const ir::Instruction &instruction)
+{
+    const MachineOperand &dest_loc = _get_location(instruction.result);
 
-    _emit("\tmov\t\teax, " + left_parsed);
-    _emit("\tcqo");
-    _emit("\tmov\t\trcx, " + right_parsed);
-    _emit("\tidiv\trcx");
+    _emit(_emit_flags(instruction), Mnemonic::SETCC, al);
+    if (dest_loc.is_register()) {
+        _emit(Mnemonic::MOVZX, dest_loc, al);
+    } else {
+        _emit(Mnemonic::MOVZX, eax, al);
+        _emit(Mnemonic::MOV, dest_loc, eax);
+    }
+}
 
-    if (is_mod) {
-        _emit("\tmov\t\t" + dest_loc + ", rdx");
+/**
+* @brief emit flags
+* @details sets the flags of a comparison and returns the condition that holds when it is true:
+* an immediate goes to the right (swapping the condition), a register against 0 is a `test`,
+* and the left operand is only loaded in `eax` when `cmp` cannot take both operands as they are
+*/
+cplus::x86_64::Condition cplus::x86_64::Codegen::_emit_flags(const ir::Instruction &compare)
+{
+    const bool swap = compare.operands[0].is_immediate() && !compare.operands[1].is_immediate();
+    const MachineOperand left = _get_operand(compare.operands[swap ? 1 : 0]);
+    const MachineOperand right = _get_operand(compare.operands[swap ? 0 : 1]);
+    const Condition condition = _get_compare_condition(compare.opcode);
+
+    if (left.is_register() && right == MachineOperand::imm(0)) {
+        _emit(Mnemonic::TEST, left, left);
+    } else if (left.is_register() || (left.is_memory() && !right.is_memory())) {
+        _emit(Mnemonic::CMP, left, right);
     } else {
-        _emit("\tmov\t\t" + dest_loc + ", eax");
+        _emit(Mnemonic::MOV, eax, left);
+        _emit(Mnemonic::CMP, eax, right);
     }
+    return swap ? _swap_condition(condition) : condition;
 }
 
 /**
-* @brief emit comparison
-* @info handles `icmp.eq`, `icmp.ne`, `icmp.slt`, `icmp.sle`, `icmp.sgt`, `icmp.sge`
+* @brief emit address arithmetic
+* @details selects the address unit for the arithmetic it can do in one instruction, returns false when nothing
+* matched. `lea` computes in a third register, so it only pays when the result does not overwrite an operand:
+*
+* - `add a, b` / `add a, imm` / `sub a, imm`: `lea dst, [a + b]`, `lea dst, [a +- imm]`
+* - `add a, (mul b, 2|4|8)`: `lea dst, [a + b * scale]`, the `mul` being folded, see _is_folded
+* - `mul a, 3|5|9`: `lea dst, [a + a * 2|4|8]`, `mul a, 2^k`: `shl dst, k`, see _emit_scale
 */
-void cplus::x86_64::Codegen::_emit_compare(const std::string &dest, const std::string &rhs)
+bool cplus::x86_64::Codegen::_emit_address_arithmetic(const ir::Instruction &instruction)
 {
-    const u64 comma_pos = rhs.find(',');
+    const MachineOperand &dest_loc = _get_location(instruction.result);
 
-    if (comma_pos == std::string::npos) {
-        return;
+    if (!dest_loc.is_register()) {
+        return false;
     }
 
-    const std::string op = rhs.substr(0, rhs.find(' '));
-    const std::string left_op = rhs.substr(op.length() + 1, comma_pos - op.length() - 1);
-    const std::string right_op = rhs.substr(comma_pos + 2);
-    const std::string left_parsed = _get_operand(left_op);
-    const std::string right_parsed = _get_operand(right_op);
-    const std::string dest_loc = _get_stack_location(dest);
+    const ir::BasicBlock &block = _function->blocks[_block_index];
+    const bool swap = instruction.opcode != ir::Opcode::SUB && instruction.operands[0].is_immediate();
+    const MachineOperand left = _get_operand(instruction.operands[swap ? 1 : 0]);
+    const MachineOperand right = _get_operand(instruction.operands[swap ? 0 : 1]);
 
-    _emit("\tmov\t\teax, " + left_parsed);
-    _emit("\tcmp\t\teax, " + right_parsed);
+    if (instruction.opcode == ir::Opcode::ADD && _instruction_index > 0 && _is_folded(block, _instruction_index - 1)) {
+        _emit(Mnemonic::LEA, dest_loc, *_get_scaled_address(instruction, block.instructions[_instruction_index - 1]));
+        return true;
+    }
+    if (!left.is_register()) {
+        return false;
+    }
 
-    const std::string set_instr = _get_compare_instruction(op);
+    if (instruction.opcode == ir::Opcode::MUL && right.kind == MachineOperand::IMMEDIATE) {
+        return _emit_scale(dest_loc, left, right.value);
+    }
+    if (dest_loc == left) {
+        return false;
+    }
+    if (instruction.opcode == ir::Opcode::ADD && right.is_register() && dest_loc != right) {
+        _emit(Mnemonic::LEA, dest_loc, MachineOperand::mem(left.reg, right.reg, 1, 0));
+        return true;
+    }
+    if (instruction.opcode != ir::Opcode::MUL && right.kind == MachineOperand::IMMEDIATE) {
+        const i64 displacement = instruction.opcode == ir::Opcode::SUB ? -right.value : right.value;
 
-    _emit("\t" + set_instr + "\tal");
-    _emit("\tmovzx\teax, al");
-    _emit("\tmov\t\t" + dest_loc + ", eax");
+        if (!_fits_i32(displacement)) {
+            return false;
+        }
+        _emit(Mnemonic::LEA, dest_loc, MachineOperand::mem(left.reg, NO_REGISTER, 1, displacement));
+        return true;
+    }
+    return false;
+}
+
+/**
+* @brief emit scale
+* @info `dst = src * factor` for the factors the address unit or a shift compute, in place or not
+*/
+bool cplus::x86_64::Codegen::_emit_scale(const MachineOperand &dst, const MachineOperand &src, const i64 factor)
+{
+    if (factor == 3 || factor == 5 || factor == 9) {
+        _emit(Mnemonic::LEA, dst, MachineOperand::mem(src.reg, src.reg, static_cast<u8>(factor - 1), 0));
+        return true;
+    }
+    if (factor < 2 || factor > (1ll << 30) || (factor & (factor - 1)) != 0) {
+        return false;
+    }
+    if (dst != src) {
+        _emit(Mnemonic::MOV, dst, src);
+    }
+    _emit(Mnemonic::SHL, dst, MachineOperand::imm(__builtin_ctzll(static_cast<u64>(factor))));
+    return true;
 }
 
 /**
 * @brief emit unary operation
 */
-void cplus::x86_64::Codegen::_emit_unary_op(const std::string &dest, const std::string &rhs, const std::string &op)
+void cplus::x86_64::Codegen::_emit_unary_op(const ir::Instruction &instruction, const Mnemonic op)
 {
-    const std::string operand = rhs.substr(op.length() + 1);
-    const std::string operand_parsed = _get_operand(operand);
-    const std::string dest_loc = _get_stack_location(dest);
+    const MachineOperand operand_parsed = _get_operand(instruction.operands[0]);
+    const MachineOperand &dest_loc = _get_location(instruction.result);
 
-    _emit("\tmov\t\teax, " + operand_parsed);
-    _emit("\t" + op + "\t\teax");
-    _emit("\tmov\t\t" + dest_loc + ", eax");
+    if (dest_loc.is_register()) {
+        if (dest_loc != operand_parsed) {
+            _emit(Mnemonic::MOV, dest_loc, operand_parsed);
+        }
+        _emit(op, dest_loc);
+        return;
+    }
+
+    _emit(Mnemonic::MOV, eax, operand_parsed);
+    _emit(op, eax);
+    _emit(Mnemonic::MOV, dest_loc, eax);
 }
 
 /**
 * @brief emit argument load
-* @info loads the argument from register or stack to the destination variable's slot
+* @info loads the argument from register or stack to the destination value's slot
 */
-void cplus::x86_64::Codegen::_emit_arg_load(const std::string &dest, const std::string &rhs)
+void cplus::x86_64::Codegen::_emit_arg_load(const ir::Instruction &instruction)
 {
-    const std::string arg_num = rhs.substr(4);
-    const i32 arg_index = std::stoi(arg_num);
-    const std::string dest_loc = _get_stack_location(dest);
+    const i64 arg_index = instruction.operands[0].data;
+    const MachineOperand &dest_loc = _get_location(instruction.result);
 
     if (arg_index < 6) {
-        _emit("\tmov\t\t" + dest_loc + ", " + REGISTERS[arg_index]);
+        if (dest_loc != MachineOperand::r(ARGUMENT_REGISTERS[arg_index])) {
+            _emit(Mnemonic::MOV, dest_loc, MachineOperand::r(ARGUMENT_REGISTERS[arg_index]));
+        }
     } else {
-        const i32 stack_arg_offset = (arg_index - 6 + 2) * 8;
+        const i64 stack_arg_offset = (arg_index - 6 + 2) * 8;
+        const MachineOperand source = MachineOperand::mem(RBP, stack_arg_offset);
 
-        _emit("\tmov\t\teax, dword ptr [rbp+" + std::to_string(stack_arg_offset) + "]");
-        _emit("\tmov\t\t" + dest_loc + ", eax");
+        if (dest_loc.is_register()) {
+            _emit(Mnemonic::MOV, dest_loc, source);
+        } else {
+            _emit(Mnemonic::MOV, eax, source);
+            _emit(Mnemonic::MOV, dest_loc, eax);
+        }
     }
 }
 
 /**
 * @brief emit phi
-* @info phi nodes are (or should be) resolved by control flow
+* @info phis are resolved on their incoming edges: a parallel copy at the end of each predecessor,
+* see _get_edge_copies, most of them are no-ops since the register allocator coalesces phis with their operands
 */
-void cplus::x86_64::Codegen::_emit_phi(const std::string &dest, const std::string &rhs)
+void cplus::x86_64::Codegen::_emit_phi(const ir::Instruction &)
 {
-    _emit("\t# " + dest + " = " + rhs + " (phi resolved by control flow)");
+    /* __phi__ */
 }
 
 /**
-* @brief emit branch
-* @info handles both unconditional and conditional branches
+* @brief get edge copies
+* @info the moves entering `to` from `from` performs, all at once: the operand of each phi of `to` for this edge
 */
-void cplus::x86_64::Codegen::_emit_branch(const std::string &line)
+std::vector<cplus::x86_64::Codegen::Copy> cplus::x86_64::Codegen::_get_edge_copies(const ir::BlockId from, const ir::BlockId to) const
 {
-    const u64 first_comma = line.find(',');
+    std::vector<Copy> copies;
+
+    for (const auto &instruction : _function->blocks[to].instructions) {
+        if (instruction.opcode != ir::Opcode::PHI) {
+            break;
+        }
+        for (u64 i = 0; i + 1 < instruction.operands.size(); i += 2) {
+            if (instruction.operands[i + 1].id() != from) {
+                continue;
+            }
 
-    if (first_comma == std::string::npos) {
-        std::string label = line.substr(3);
-        _trim(label);
+            const Copy copy{.dst = _get_location(instruction.result), .src = _get_operand(instruction.operands[i])};
 
-        if (label.starts_with('%')) {
-            label = label.substr(1);
+            if (copy.dst != copy.src) {
+                copies.push_back(copy);
+            }
+            break;
+        }
+    }
+    return copies;
+}
+
+/**
+* @brief get argument copies
+* @info the moves of the register arguments of a call, without those already in place
+*/
+std::vector<cplus::x86_64::Codegen::Copy> cplus::x86_64::Codegen::_get_argument_copies(const std::vector<ir::Operand> &arguments) const
+{
+    std::vector<Copy> copies;
+
+    for (u64 i = 0; i < arguments.size() && i < 6; ++i) {
+        const Copy copy{.dst = MachineOperand::r(ARGUMENT_REGISTERS[i]), .src = _get_operand(arguments[i])};
+
+        if (copy.dst != copy.src) {
+            copies.push_back(copy);
+        }
+    }
+    return copies;
+}
+
+/**
+* @brief prepare edges
+* @details a block with several successors cannot hold the copies of one of them (critical edge): each successor
+* that needs copies gets a stub, laid out after the terminator in successor order, holding them before jumping to it
+*/
+void cplus::x86_64::Codegen::_prepare_edges()
+{
+    const ir::BlockId block = static_cast<ir::BlockId>(_block_index);
+
+    _edge_stubs.clear();
+    for (const ir::BlockId successor : ir::successors(_function->blocks[block])) {
+        if (!_get_edge_copies(block, successor).empty()) {
+            _edge_stubs.emplace_back(successor, _new_label("edge"));
+        }
+    }
+}
+
+/**
+* @brief emit edge jump
+* @info unconditional branch to a successor, through its stub if it has one, omitted when it would jump right after
+*/
+void cplus::x86_64::Codegen::_emit_edge_jump(const ir::BlockId block)
+{
+    if (_edge_stubs.empty()) {
+        _emit_jump(block);
+    } else if (_edge_stubs.front().first != block) {
+        _emit(Mnemonic::JMP, _get_edge_label(block));
+    }
+}
+
+/**
+* @brief emit edge stubs
+* @info let the stub of if.end3 be:
+*
+* .Ledge0:
+*     mov     r10d, ebx      (phi copies)
+*     jmp     .Lif.end3      (omitted for the last stub when if.end3 is the next block)
+*/
+void cplus::x86_64::Codegen::_emit_edge_stubs()
+{
+    const ir::BlockId block = static_cast<ir::BlockId>(_block_index);
+    const auto stubs = std::move(_edge_stubs);
+
+    _edge_stubs.clear();
+    for (u64 i = 0; i < stubs.size(); ++i) {
+        _emit(Mnemonic::LABEL, stubs[i].second);
+        _emit_parallel_copy(_get_edge_copies(block, stubs[i].first));
+        if (i + 1 == stubs.size()) {
+            _emit_jump(stubs[i].first);
+        } else {
+            _emit(Mnemonic::JMP, _get_label(stubs[i].first));
         }
+    }
+}
 
-        _emit("\tjmp\t\t.L" + label);
+/**
+* @brief emit parallel copy
+* @details sequences moves that happen at once: a move is emitted once no other pending move reads its destination,
+* when every destination is still read the moves form cycles and one destination is saved in `eax` to break them.
+* memory to memory moves go through `ecx`
+*/
+void cplus::x86_64::Codegen::_emit_parallel_copy(std::vector<Copy> copies)
+{
+    while (!copies.empty()) {
+        const auto ready = std::find_if(copies.begin(), copies.end(), [&copies](const Copy &copy) {
+            return std::none_of(copies.begin(), copies.end(), [&copy](const Copy &other) { return other.src == copy.dst; });
+        });
+
+        if (ready == copies.end()) {
+            const MachineOperand saved = copies.front().dst;
+
+            _emit(Mnemonic::MOV, eax, saved);
+            for (auto &copy : copies) {
+                if (copy.src == saved) {
+                    copy.src = eax;
+                }
+            }
+            continue;
+        }
 
+        if (ready->dst.is_memory() && ready->src.is_memory()) {
+            _emit(Mnemonic::MOV, ecx, ready->src);
+            _emit(Mnemonic::MOV, ready->dst, ecx);
+        } else {
+            _emit(Mnemonic::MOV, ready->dst, ready->src);
+        }
+        copies.erase(ready);
+    }
+}
+
+/**
+* @brief emit branch
+* @info conditional branch on the flags of the fused comparison, or `test` of the condition value, jumping to the
+* block that does not follow (the `then` block, or its stub, falls through with the inverted condition)
+*/
+void cplus::x86_64::Codegen::_emit_branch(const ir::Instruction &instruction)
+{
+    const ir::BasicBlock &block = _function->blocks[_block_index];
+    const ir::BlockId then_block = instruction.operands[1].id();
+    const ir::BlockId else_block = instruction.operands[2].id();
+    const MachineOperand cond_loc = _get_operand(instruction.operands[0]);
+    Condition condition = Condition::NE;
+
+    _prepare_edges();
+    if (_instruction_index > 0 && _is_folded(block, _instruction_index - 1)) {
+        condition = _emit_flags(block.instructions[_instruction_index - 1]);
+    } else if (instruction.operands[0].is_immediate()) {
+        _emit_edge_jump(static_cast<i32>(instruction.operands[0].data) != 0 ? then_block : else_block);
+        _emit_edge_stubs();
+        return;
+    } else if (cond_loc.is_register()) {
+        _emit(Mnemonic::TEST, cond_loc, cond_loc);
     } else {
+        _emit(Mnemonic::CMP, cond_loc, MachineOperand::imm(0));
+    }
+
+    const bool then_follows = _edge_stubs.empty() ? then_block == _block_index + 1 : _edge_stubs.front().first == then_block;
+
+    if (then_follows) {
+        _emit(_invert_condition(condition), Mnemonic::JCC, _get_edge_label(else_block));
+        _emit_edge_jump(then_block);
+    } else {
+        _emit(condition, Mnemonic::JCC, _get_edge_label(then_block));
+        _emit_edge_jump(else_block);
+    }
+    _emit_edge_stubs();
+}
+
+/**
+* @brief is folded
+* @details instruction selection over pairs: a value defined right before its only use is not computed on its own,
+* the instruction using it selects both at once (the pattern is matched again there):
+*
+* - `icmp` + `br` on its result: `cmp` + `jcc`, the boolean is never materialized
+* - `mul` by 2, 4 or 8 + `add` of its result: one `lea`, see _get_scaled_address
+* - `call` + `ret` of its result: the frame is left and the callee jumped to, see _is_tail_call
+*
+* nothing is emitted between the two, so the operands of the folded instruction still hold their values at the user
+*/
+bool cplus::x86_64::Codegen::_is_folded(const ir::BasicBlock &block, const u64 index) const
+{
+    if (index + 1 >= block.instructions.size()) {
+        return false;
+    }
+
+    const ir::Instruction &instruction = block.instructions[index];
+    const ir::Instruction &user = block.instructions[index + 1];
+
+    if (instruction.opcode == ir::Opcode::CALL) {
+        return _is_tail_call(instruction, user);
+    }
+    if (instruction.result == ir::INVALID_ID || _uses[instruction.result] != 1) {
+        return false;
+    }
+    if (ir::is_compare(instruction.opcode)) {
+        return user.opcode == ir::Opcode::BR && user.operands[0] == ir::Operand::value(instruction.result);
+    }
+    return _get_scaled_address(user, instruction).has_value();
+}
+
+/**
+* @brief is tail call
+* @info the callee returns straight to our caller: only without stack arguments, which would have to outlive the
+* frame, and not at -O0 where every call stays visible in a backtrace
+*/
+bool cplus::x86_64::Codegen::_is_tail_call(const ir::Instruction &call, const ir::Instruction &ret) const
+{
+    if (_level == OPT_O0 || call.operands.size() > 6 || ret.opcode != ir::Opcode::RET) {
+        return false;
+    }
+    return ret.operands.empty() || ret.operands[0] == ir::Operand::value(call.result);
+}
+
+/**
+* @brief get scaled address
+* @info `[a + b * scale]` computing `add a, (mul b, scale)` when a, b and the sum live in registers
+*/
+std::optional<MachineOperand> cplus::x86_64::Codegen::_get_scaled_address(const ir::Instruction &add, const ir::Instruction &mul) const
+{
+    ir::Operand scaled;
+    const u8 scale = _get_scale(mul, scaled);
+
+    if (scale == 0 || add.opcode != ir::Opcode::ADD || !scaled.is_value()) {
+        return std::nullopt;
+    }
 
-        const std::string cond_var = line.substr(3, first_comma - 3);
-        const u64 second_comma = line.find(',', first_comma + 1);
-        const std::string else_label = line.substr(second_comma + 2);
-        const std::string cond_loc = _get_operand(cond_var);
-        std::string else_clean = else_label;
+    const ir::Operand product = ir::Operand::value(mul.result);
+    const ir::Operand &base = add.operands[0] == product ? add.operands[1] : add.operands[0];
 
-        _trim(else_clean);
-        if (else_clean.starts_with('%')) {
-            else_clean = else_clean.substr(1);
+    if ((add.operands[0] != product && add.operands[1] != product) || !base.is_value()) {
+        return std::nullopt;
+    }
+
+    const MachineOperand &base_loc = _get_location(base.id());
+    const MachineOperand &index_loc = _get_location(scaled.id());
+
+    if (!base_loc.is_register() || !index_loc.is_register() || !_get_location(add.result).is_register()) {
+        return std::nullopt;
+    }
+    return MachineOperand::mem(base_loc.reg, index_loc.reg, scale, 0);
+}
+
+/**
+* @brief emit jump
+* @info unconditional branch, omitted when the target is the next block
+*/
+void cplus::x86_64::Codegen::_emit_jump(const ir::BlockId block)
+{
+    if (block != _block_index + 1) {
+        _emit(Mnemonic::JMP, _get_label(block));
+    }
+}
+
+/**
+* @brief emit switch
+* @details the value is loaded in eax once, the sorted cases are grouped into clusters by density
+* and a balanced compare tree on eax selects the cluster:
+*
+* - single case: `cmp eax, value` + `je`
+* - jump table (dense range): range check on `ecx = eax - low`, then `jmp qword ptr [table + rcx*8]` through .rodata
+* - bit test (small range, few destinations): same range check, then one `bt mask, ecx` + `jb` per destination
+*/
+void cplus::x86_64::Codegen::_emit_switch(const ir::Instruction &instruction)
+{
+    const auto &operands = instruction.operands;
+    const ir::BlockId fallback = operands[1].id();
+    std::vector<SwitchCase> cases;
+
+    for (u64 i = 2; i + 1 < operands.size(); i += 2) {
+        cases.push_back({.value = operands[i].data, .block = operands[i + 1].id()});
+    }
+    std::sort(cases.begin(), cases.end(), [](const SwitchCase &a, const SwitchCase &b) { return a.value < b.value; });
+
+    _prepare_edges();
+    if (operands[0].is_immediate()) {
+        const auto it = std::find_if(cases.begin(), cases.end(), [&](const SwitchCase &c) { return c.value == operands[0].data; });
+
+        _emit_edge_jump(it != cases.end() ? it->block : fallback);
+    } else {
+        const u64 density = _level == OPT_OS ? JUMP_TABLE_MIN_DENSITY_SIZE : JUMP_TABLE_MIN_DENSITY;
+        const std::vector<SwitchCluster> clusters = _cluster_cases(cases, density);
+
+        _emit(Mnemonic::MOV, eax, _get_operand(operands[0]));
+        _emit_switch_tree(cases, clusters, 0, clusters.size(), fallback, true);
+    }
+    _emit_edge_stubs();
+}
+
+/**
+* @brief cluster cases
+* @details greedy, left to right: each cluster is the longest run starting at the first unclustered case
+* that forms a jump table or a bit test, a bit test wins over a jump table of the same size (no load, no indirect jump)
+*/
+std::vector<cplus::x86_64::Codegen::SwitchCluster> cplus::x86_64::Codegen::_cluster_cases(const std::vector<SwitchCase> &cases,
+    const u64 min_density)
+{
+    std::vector<SwitchCluster> clusters;
+
+    for (u64 first = 0; first < cases.size();) {
+        SwitchCluster best{.kind = SwitchCluster::SINGLE, .first = first, .last = first + 1};
+        std::vector<ir::BlockId> destinations{cases[first].block};
+
+        for (u64 last = first + 2; last <= cases.size(); ++last) {
+            const u64 count = last - first;
+            const u64 range = static_cast<u64>(cases[last - 1].value - cases[first].value) + 1;
+
+            if (range > JUMP_TABLE_MAX_RANGE) {
+                break;
+            }
+            if (std::find(destinations.begin(), destinations.end(), cases[last - 1].block) == destinations.end()) {
+                destinations.push_back(cases[last - 1].block);
+            }
+
+            const bool bits = count >= BIT_TEST_MIN_CASES && range <= BIT_TEST_MAX_RANGE && destinations.size() <= BIT_TEST_MAX_DESTINATIONS;
+            const bool table = count >= JUMP_TABLE_MIN_CASES && count * 100 >= range * min_density;
+
+            if (bits || table) {
+                best = {.kind = bits ? SwitchCluster::BITS : SwitchCluster::TABLE, .first = first, .last = last};
+            }
+        }
+        clusters.push_back(best);
+        first = best.last;
+    }
+    return clusters;
+}
+
+/**
+* @brief emit switch tree
+* @details binary search on the first value of each cluster, `tail` is set when the code falls through to the next block
+*/
+void cplus::x86_64::Codegen::_emit_switch_tree(const std::vector<SwitchCase> &cases, const std::vector<SwitchCluster> &clusters,
+    const u64 first, const u64 last, const ir::BlockId fallback, const bool tail)
+{
+    if (last - first <= SWITCH_LINEAR_CLUSTERS) {
+        bool terminated = false;
+
+        for (u64 i = first; i < last; ++i) {
+            terminated = _emit_switch_cluster(cases, clusters[i], fallback, i + 1 == last);
+        }
+        if (terminated) {
+            return;
         }
+        if (tail) {
+            _emit_edge_jump(fallback);
+        } else {
+            _emit(Mnemonic::JMP, _get_edge_label(fallback));
+        }
+        return;
+    }
+
+    const u64 middle = first + (last - first) / 2;
+    const MachineOperand upper = _new_label("switch");
 
-        _emit("\tmov\t\teax, " + cond_loc);
-        _emit("\tcmp\t\teax, 0");
-        _emit("\tje\t\t.L" + else_clean);
+    _emit(Mnemonic::CMP, eax, MachineOperand::imm(cases[clusters[middle].first].value));
+    _emit(Condition::GE, Mnemonic::JCC, upper);
+    _emit_switch_tree(cases, clusters, first, middle, fallback, false);
+    _emit(Mnemonic::LABEL, upper);
+    _emit_switch_tree(cases, clusters, middle, last, fallback, tail);
+}
+
+/**
+* @brief emit switch cluster
+* @details a value out of the range of a cluster goes on to the next one, or straight to the default (through its edge
+* stub) when the cluster is the `last` of its run
+* @return whether the cluster ends with a jump of its own, the run then needs no jump to the default after it
+*/
+bool cplus::x86_64::Codegen::_emit_switch_cluster(const std::vector<SwitchCase> &cases, const SwitchCluster &cluster,
+    const ir::BlockId fallback, const bool last)
+{
+    if (cluster.kind == SwitchCluster::SINGLE) {
+        _emit(Mnemonic::CMP, eax, MachineOperand::imm(cases[cluster.first].value));
+        _emit(Condition::E, Mnemonic::JCC, _get_edge_label(cases[cluster.first].block));
+        return false;
     }
+
+    const i64 low = cases[cluster.first].value;
+    const i64 high = cases[cluster.last - 1].value;
+    const MachineOperand next = last ? _get_edge_label(fallback) : _new_label("switch");
+
+    /** @brief one unsigned compare rejects both sides of [low, high] */
+    _emit(Mnemonic::MOV, ecx, eax);
+    if (low != 0) {
+        _emit(Mnemonic::SUB, ecx, MachineOperand::imm(low));
+    }
+    _emit(Mnemonic::CMP, ecx, MachineOperand::imm(high - low));
+    _emit(Condition::A, Mnemonic::JCC, next);
+
+    if (cluster.kind == SwitchCluster::TABLE) {
+        JumpTable table{.function = static_cast<u32>(_output.functions.size() - 1), .labels = {}};
+
+        table.labels.assign(static_cast<u64>(high - low) + 1, _get_edge_label(fallback).index());
+        for (u64 i = cluster.first; i < cluster.last; ++i) {
+            table.labels[static_cast<u64>(cases[i].value - low)] = _get_edge_label(cases[i].block).index();
+        }
+        _output.jump_tables.push_back(std::move(table));
+        _emit(Mnemonic::JMP, MachineOperand::table(static_cast<u32>(_output.jump_tables.size() - 1), RCX));
+        if (last) {
+            return true;
+        }
+    } else {
+        std::vector<std::pair<ir::BlockId, u32>> masks;
+
+        for (u64 i = cluster.first; i < cluster.last; ++i) {
+            const auto it = std::find_if(masks.begin(), masks.end(), [&](const auto &mask) { return mask.first == cases[i].block; });
+            const u32 bit = 1u << (cases[i].value - low);
+
+            if (it == masks.end()) {
+                masks.emplace_back(cases[i].block, bit);
+            } else {
+                it->second |= bit;
+            }
+        }
+        for (const auto &[block, mask] : masks) {
+            _emit(Mnemonic::MOV, edx, MachineOperand::imm(mask));
+            _emit(Mnemonic::BT, edx, ecx);
+            _emit(Condition::B, Mnemonic::JCC, _get_edge_label(block));
+        }
+        if (last) {
+            return false;
+        }
+        _emit(Mnemonic::JMP, _get_edge_label(fallback));
+    }
+    _emit(Mnemonic::LABEL, next);
+    return false;
 }
 
 /**
 * @brief emit return
 * @info handles both `ret` and `ret <value>`
 */
-void cplus::x86_64::Codegen::_emit_return(const std::string &line)
+void cplus::x86_64::Codegen::_emit_return(const ir::Instruction &instruction)
 {
-    if (line == "ret") {
-        _emit("\tleave");
-        _emit("\tret");
-
-    } else if (line.starts_with("ret ")) {
-        const std::string value = line.substr(4);
-        const std::string value_parsed = _get_operand(value);
-
-        _emit("\tmov\t\teax, " + value_parsed);
-        _emit("\tleave");
-        _emit("\tret");
+    if (_instruction_index > 0 && _is_folded(_function->blocks[_block_index], _instruction_index - 1)) {
+        _emit_tail_call(_function->blocks[_block_index].instructions[_instruction_index - 1]);
+        return;
     }
+    if (!instruction.operands.empty()) {
+        _emit(Mnemonic::MOV, eax, _get_operand(instruction.operands[0]));
+    }
+    _emit_restore_callee_saved();
+    _emit(Mnemonic::LEAVE);
+    _emit(Mnemonic::RET);
+}
+
+/**
+* @brief emit tail call
+* @info the arguments are set while the frame still holds our values, then the frame is left as for a `ret`
+* and the callee returns in our place:
+*
+* mov     edi, <arg0>
+* leave
+* jmp     callee
+*/
+void cplus::x86_64::Codegen::_emit_tail_call(const ir::Instruction &call)
+{
+    _emit_parallel_copy(_get_argument_copies(call.operands));
+    _emit_restore_callee_saved();
+    _emit(Mnemonic::LEAVE);
+    _emit(Mnemonic::JMP, _get_symbol(_module->functions[call.callee].name));
 }
@@ -0,0 +1,222 @@
+#include <CPlus/Codegen/x86-64Instruction.hpp>
+
+/**
+ * helpers
+ */
+
+static constexpr cplus::cstr _mnemonic_name(const cplus::x86_64::Mnemonic mnemonic)
+{
+    switch (mnemonic) {
+        case cplus::x86_64::Mnemonic::MOV:
+            return "mov";
+        case cplus::x86_64::Mnemonic::MOVZX:
+            return "movzx";
+        case cplus::x86_64::Mnemonic::LEA:
+            return "lea";
+        case cplus::x86_64::Mnemonic::ADD:
+            return "add";
+        case cplus::x86_64::Mnemonic::SUB:
+            return "sub";
+        case cplus::x86_64::Mnemonic::IMUL:
+            return "imul";
+        case cplus::x86_64::Mnemonic::AND:
+            return "and";
+        case cplus::x86_64::Mnemonic::OR:
+            return "or";
+        case cplus::x86_64::Mnemonic::SHL:
+            return "shl";
+        case cplus::x86_64::Mnemonic::CMP:
+            return "cmp";
+        case cplus::x86_64::Mnemonic::TEST:
+            return "test";
+        case cplus::x86_64::Mnemonic::NEG:
+            return "neg";
+        case cplus::x86_64::Mnemonic::CDQ:
+            return "cdq";
+        case cplus::x86_64::Mnemonic::IDIV:
+            return "idiv";
+        case cplus::x86_64::Mnemonic::BT:
+            return "bt";
+        case cplus::x86_64::Mnemonic::JMP:
+            return "jmp";
+        case cplus::x86_64::Mnemonic::CALL:
+            return "call";
+        case cplus::x86_64::Mnemonic::PUSH:
+            return "push";
+        case cplus::x86_64::Mnemonic::LEAVE:
+            return "leave";
+        case cplus::x86_64::Mnemonic::RET:
+            return "ret";
+        case cplus::x86_64::Mnemonic::SYSCALL:
+            return "syscall";
+        case cplus::x86_64::Mnemonic::SETCC:
+        case cplus::x86_64::Mnemonic::JCC:
+        case cplus::x86_64::Mnemonic::LABEL:
+        default:
+            return "";
+    }
+}
+
+static constexpr cplus::cstr _condition_name(const cplus::x86_64::Condition condition)
+{
+    switch (condition) {
+        case cplus::x86_64::Condition::B:
+            return "b";
+        case cplus::x86_64::Condition::AE:
+            return "ae";
+        case cplus::x86_64::Condition::E:
+            return "e";
+        case cplus::x86_64::Condition::NE:
+            return "ne";
+        case cplus::x86_64::Condition::BE:
+            return "be";
+        case cplus::x86_64::Condition::A:
+            return "a";
+        case cplus::x86_64::Condition::L:
+            return "l";
+        case cplus::x86_64::Condition::GE:
+            return "ge";
+        case cplus::x86_64::Condition::LE:
+            return "le";
+        case cplus::x86_64::Condition::G:
+            return "g";
+        default:
+            return "";
+    }
+}
+
+static std::string _operand(const cplus::x86_64::MachineModule &module, const cplus::x86_64::MachineFunction &function,
+    const cplus::x86_64::MachineOperand &operand)
+{
+    using cplus::x86_64::MachineOperand;
+
+    switch (operand.kind) {
+        case MachineOperand::REGISTER:
+            if (operand.size == 1) {
+                return cplus::x86_64::to_string8(operand.reg);
+            }
+            return operand.size == 8 ? cplus::x86_64::to_string64(operand.reg) : cplus::x86_64::to_string32(operand.reg);
+        case MachineOperand::IMMEDIATE:
+            return std::to_string(operand.value);
+        case MachineOperand::MEMORY: {
+            const std::string sign = operand.value < 0 ? "-" : "+";
+            const std::string disp = operand.value ? sign + std::to_string(operand.value < 0 ? -operand.value : operand.value) : "";
+            const std::string width = operand.size == 8 ? "qword" : (operand.size == 1 ? "byte" : "dword");
+            std::string base = cplus::x86_64::to_string64(operand.reg);
+
+            if (operand.index_reg != cplus::x86_64::NO_REGISTER) {
+                base += "+" + std::string(cplus::x86_64::to_string64(operand.index_reg));
+                base += operand.scale > 1 ? "*" + std::to_string(operand.scale) : "";
+            }
+            return width + " ptr [" + base + disp + "]";
+        }
+        case MachineOperand::LABEL:
+            return function.labels[operand.index()];
+        case MachineOperand::SYMBOL:
+            return module.symbols[operand.index()];
+        case MachineOperand::STRING:
+            return "OFFSET .Lstr" + std::to_string(operand.value);
+        case MachineOperand::GLOBAL:
+            return "dword ptr [.L" + module.globals[operand.index()].name + "+" + cplus::x86_64::to_string64(operand.index_reg) + "*4]";
+        case MachineOperand::TABLE:
+            return "qword ptr [.Ljt" + std::to_string(operand.value) + "+" + cplus::x86_64::to_string64(operand.reg) + "*8]";
+        case MachineOperand::NONE:
+        default:
+            return "";
+    }
+}
+
+/**
+ * @brief instruction
+ * @info mnemonics are padded with tabs so operands line up, e.g. `\tmov\t\teax, 1` and `\tmovzx\teax, al`
+ */
+static std::string _instruction(const cplus::x86_64::MachineModule &module, const cplus::x86_64::MachineFunction &function,
+    const cplus::x86_64::MachineInstruction &instruction)
+{
+    using cplus::x86_64::Mnemonic;
+
+    if (instruction.mnemonic == Mnemonic::LABEL) {
+        return _operand(module, function, instruction.dst) + ":";
+    }
+
+    std::string name = _mnemonic_name(instruction.mnemonic);
+
+    if (instruction.mnemonic == Mnemonic::SETCC) {
+        name = std::string("set") + _condition_name(instruction.condition);
+    } else if (instruction.mnemonic == Mnemonic::JCC) {
+        name = std::string("j") + _condition_name(instruction.condition);
+    }
+
+    std::string line = "\t" + name;
+
+    if (instruction.dst.kind == cplus::x86_64::MachineOperand::NONE) {
+        return line;
+    }
+    line += name.size() < 4 ? "\t\t" : "\t";
+    line += _operand(module, function, instruction.dst);
+    if (instruction.src.kind != cplus::x86_64::MachineOperand::NONE) {
+        line += ", " + _operand(module, function, instruction.src);
+    }
+    return line;
+}
+
+/**
+ * public
+ */
+
+std::string cplus::x86_64::print(const MachineModule &module)
+{
+    std::string out;
+
+    const auto emit = [&out](const std::string &s) {
+        out += s;
+        out += '\n';
+    };
+
+    emit("# x86-64 Intel Assembly generated by CPlus Compiler");
+    emit("\t.intel_syntax\tnoprefix");
+    emit("\t.file\t\t\t\"" + module.name + "\"\n");
+
+    for (const auto &function : module.functions) {
+        emit("\t.section\t\t.text." + function.name + ",\"ax\",@progbits");
+        if (module.function_alignment > 1) {
+            emit("\t.balign\t\t\t" + std::to_string(module.function_alignment) + ", 0xcc");
+        }
+        emit(".globl\t\t\t" + function.name);
+        emit(function.name + ":");
+        for (const auto &instruction : function.instructions) {
+            emit(_instruction(module, function, instruction));
+        }
+        emit("");
+    }
+
+    if (!module.strings.empty()) {
+        emit("\t.section\t\t.rodata");
+        for (u64 i = 0; i < module.strings.size(); ++i) {
+            emit(".Lstr" + std::to_string(i) + ":");
+            emit("\t.string\t\t\"" + module.strings[i] + "\"");
+        }
+    }
+    for (u64 i = 0; i < module.jump_tables.size(); ++i) {
+        const auto &table = module.jump_tables[i];
+
+        emit("\t.section\t\t.rodata." + module.functions[table.function].name + ",\"a\"");
+        emit("\t.p2align\t\t3");
+        emit(".Ljt" + std::to_string(i) + ":");
+        for (const u32 label : table.labels) {
+            emit("\t.quad\t\t" + module.functions[table.function].labels[label]);
+        }
+    }
+
+    if (!module.globals.empty()) {
+        emit("\t.section\t\t.bss");
+        emit("\t.p2align\t\t2");
+        for (const auto &global : module.globals) {
+            emit(".L" + global.name + ":");
+            emit("\t.zero\t\t" + std::to_string(global.size));
+        }
+    }
+
+    emit("\t.section\t\t.note.GNU-stack,\"\",@progbits");
+    return out;
+}
@@ -0,0 +1,344 @@
+#include <CPlus/Arguments.hpp>
+#include <CPlus/Compiler/Cache.hpp>
+#include <CPlus/Logger.hpp>
+#include <CPlus/Macros.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/file.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/**
+ * helpers
+ */
+
+/** @brief flags that change what a compilation produces, everything else (e.g. --show-ast) is left out of the key,
+ * the optimization level is keyed next to them */
+static constexpr cplus::i32 KEY_FLAGS = cplus::FLAG_EMIT_ASM | cplus::FLAG_AUTO_MEMOIZE;
+
+static constexpr cplus::u64 PRIME_1 = 0x9E3779B185EBCA87ull;
+static constexpr cplus::u64 PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+
+static constexpr cplus::u64 _avalanche(cplus::u64 h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief hash
+ * @info word-at-a-time multiply/rotate hash, chaining `seed` lets several buffers feed one digest
+ */
+static cplus::u64 _hash(const std::string_view data, const cplus::u64 seed)
+{
+    cplus::u64 h = seed ^ (data.size() * PRIME_1);
+    cplus::u64 i = 0;
+
+    for (; i + 8 <= data.size(); i += 8) {
+        cplus::u64 word;
+
+        std::memcpy(&word, data.data() + i, 8);
+        h ^= std::rotl(word * PRIME_2, 31) * PRIME_1;
+        h = std::rotl(h, 27) * PRIME_1 + PRIME_2;
+    }
+    if (i < data.size()) {
+        cplus::u64 word = 0;
+
+        std::memcpy(&word, data.data() + i, data.size() - i);
+        h ^= std::rotl(word * PRIME_2, 31) * PRIME_1;
+        h = std::rotl(h, 27) * PRIME_1 + PRIME_2;
+    }
+    return _avalanche(h);
+}
+
+static std::string _hex(const cplus::u64 value)
+{
+    constexpr char digits[] = "0123456789abcdef";
+    std::string out(16, '0');
+
+    for (cplus::u64 i = 0; i < 16; ++i) {
+        out[15 - i] = digits[(value >> (4 * i)) & 0xF];
+    }
+    return out;
+}
+
+static std::optional<std::string> _read(const fs::path &path)
+{
+    std::ifstream stream(path, std::ios::binary);
+
+    if (!stream.is_open()) {
+        return std::nullopt;
+    }
+
+    std::ostringstream content;
+    content << stream.rdbuf();
+    if (stream.bad()) {
+        return std::nullopt;
+    }
+    return content.str();
+}
+
+/**
+ * @brief write atomically
+ * @info readers only ever see a complete file: the content goes to a unique temporary which is then renamed over `path`
+ */
+static bool _write_atomically(const fs::path &path, const std::string &content)
+{
+    std::error_code ec;
+    const fs::path temporary = path.string() + ".tmp" + std::to_string(getpid()) + "-"
+        + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+
+        if (!stream.is_open()) {
+            return false;
+        }
+        stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!stream) {
+            fs::remove(temporary, ec);
+            return false;
+        }
+    }
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief compiler identity
+ * @info hashing our own executable invalidates every entry when the compiler is rebuilt, not only on version bumps
+ */
+static const std::string &_compiler_identity()
+{
+    static const std::string identity = []() {
+        const auto executable = _read("/proc/self/exe");
+
+        return std::string(CPLUS_VERSION) + "-" + (executable ? _hex(_hash(*executable, 0)) : "unknown");
+    }();
+
+    return identity;
+}
+
+/**
+ * public
+ */
+
+cplus::CompileCache::CompileCache(fs::path directory, const u64 max_size) : _directory(std::move(directory)), _max_size(max_size)
+{
+    /* __ctor__ */
+}
+
+std::string cplus::CompileCache::key(const FileContent &source) const
+{
+    const std::string header = _compiler_identity() + '\0' + std::to_string(cplus_flags & KEY_FLAGS) + '\0'
+        + std::to_string(cplus_opt_level) + '\0' + source.file + '\0';
+    const u64 low = _hash(source.content, _hash(header, 0));
+    const u64 high = _hash(source.content, _hash(header, PRIME_2));
+
+    return _hex(high) + _hex(low);
+}
+
+/**
+ * @brief load
+ * @details any missing or unreadable piece is a miss, the cache never fails a compilation
+ */
+std::optional<cplus::CompileCache::Entry> cplus::CompileCache::load(const std::string &key)
+{
+    std::error_code ec;
+    Entry entry;
+    const auto object = _read(_path(key, ".o"));
+
+    if (!object) {
+        ++_misses;
+        return std::nullopt;
+    }
+    entry.object = std::move(*object);
+
+    if (cplus_flags & FLAG_EMIT_ASM) {
+        auto assembly = _read(_path(key, ".s"));
+
+        if (!assembly) {
+            ++_misses;
+            return std::nullopt;
+        }
+        entry.assembly = std::move(*assembly);
+        fs::last_write_time(_path(key, ".s"), fs::file_time_type::clock::now(), ec);
+    }
+
+    fs::last_write_time(_path(key, ".o"), fs::file_time_type::clock::now(), ec);
+    ++_hits;
+    return entry;
+}
+
+/**
+ * @brief store
+ * @details the assembly is stored first, so an object on disk always means a complete entry
+ */
+void cplus::CompileCache::store(const std::string &key, const Entry &entry)
+{
+    std::error_code ec;
+
+    fs::create_directories(_path(key, ".o").parent_path(), ec);
+    if (ec) {
+        return;
+    }
+    if ((cplus_flags & FLAG_EMIT_ASM) && !_write_atomically(_path(key, ".s"), entry.assembly)) {
+        return;
+    }
+    if (_write_atomically(_path(key, ".o"), entry.object)) {
+        _written += entry.object.size() + entry.assembly.size();
+    }
+}
+
+/**
+ * @brief report
+ * @details adds the counters and the bytes written by this run to `<cache>/stats` under an exclusive lock, trims the
+ * cache once the recorded size is over the limit, prints them with --cache-stats. a run that neither used the cache nor
+ * asked for its statistics leaves the file alone
+ */
+void cplus::CompileCache::report()
+{
+    const bool changed = _hits != 0 || _misses != 0 || _written != 0;
+    const bool show = cplus_flags & FLAG_CACHE_STATS;
+    std::error_code ec;
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 size = 0;
+
+    if (!changed && !show) {
+        return;
+    }
+    if (changed) {
+        fs::create_directories(_directory, ec);
+    }
+
+    const std::string path = (_directory / "stats").string();
+    const i32 fd = changed ? open(path.c_str(), O_RDWR | O_CREAT, 0644) : open(path.c_str(), O_RDONLY);
+
+    if (fd >= 0 && flock(fd, changed ? LOCK_EX : LOCK_SH) == 0) {
+        char buffer[128] = {};
+
+        if (read(fd, buffer, sizeof(buffer) - 1) > 0) {
+            std::istringstream(buffer) >> hits >> misses >> size;
+        }
+        if (changed) {
+            hits += _hits;
+            misses += _misses;
+            size += _written;
+            if (size > _max_size) {
+                size = _trim();
+            }
+
+            const std::string content = std::to_string(hits) + " " + std::to_string(misses) + " " + std::to_string(size) + "\n";
+
+            if (ftruncate(fd, 0) != 0 || pwrite(fd, content.data(), content.size(), 0) < 0) {
+                hits = _hits;
+                misses = _misses;
+            }
+        }
+        flock(fd, LOCK_UN);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    if (!show) {
+        return;
+    }
+
+    const auto ratio = [](const u64 hit, const u64 miss) { return hit + miss ? (hit * 100) / (hit + miss) : 0; };
+
+    logger::info("Cache ", _directory.string(), ": ", _hits.load(), " hits, ", _misses.load(), " misses (", ratio(_hits, _misses),
+        "%) this run, ", hits, " hits, ", misses, " misses (", ratio(hits, misses), "%) in total");
+}
+
+/**
+ * @brief default directory
+ * @info $CPLUS_CACHE_DIR, then $XDG_CACHE_HOME/cplus, then $HOME/.cache/cplus
+ */
+std::optional<fs::path> cplus::CompileCache::default_directory()
+{
+    if (const char *dir = std::getenv("CPLUS_CACHE_DIR"); dir && *dir) {
+        return fs::path(dir);
+    }
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return fs::path(xdg) / "cplus";
+    }
+    if (const char *home = std::getenv("HOME"); home && *home) {
+        return fs::path(home) / ".cache" / "cplus";
+    }
+    return std::nullopt;
+}
+
+/**
+ * private
+ */
+
+/** @brief entries are sharded by the first byte of their key to keep directories small */
+fs::path cplus::CompileCache::_path(const std::string &key, const char *extension) const
+{
+    return _directory / key.substr(0, 2) / (key + extension);
+}
+
+/**
+ * @brief trim
+ * @details measures the entries on disk, the recorded size drifts when entries are overwritten or removed by hand,
+ * then evicts the least recently used ones down to 90% of the limit
+ * @return the size left on disk
+ */
+cplus::u64 cplus::CompileCache::_trim()
+{
+    // clang-format off
+    struct File {
+        fs::path path;
+        u64 size;
+        fs::file_time_type time;
+    };
+    // clang-format on
+
+    std::error_code ec;
+    std::vector<File> files;
+    u64 total = 0;
+
+    for (auto it = fs::recursive_directory_iterator(_directory, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().parent_path() == _directory) {
+            continue;
+        }
+
+        const u64 size = it->file_size(ec);
+
+        files.push_back({.path = it->path(), .size = size, .time = it->last_write_time(ec)});
+        total += size;
+    }
+
+    if (total <= _max_size) {
+        return total;
+    }
+
+    std::sort(files.begin(), files.end(), [](const File &a, const File &b) { return a.time < b.time; });
+    for (const auto &file : files) {
+        if (total <= _max_size / 10 * 9) {
+            break;
+        }
+        if (fs::remove(file.path, ec)) {
+            total -= file.size;
+            fs::remove(file.path.parent_path(), ec);//<< only succeeds once the shard is empty
+        }
+    }
+    return total;
+}
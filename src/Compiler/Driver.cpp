@@ -1,56 +1,121 @@
 #include <CPlus/Arguments.hpp>
 #include <CPlus/Compiler/Driver.hpp>
+#include <CPlus/Compiler/Linker.hpp>
 #include <CPlus/Error.hpp>
-#include <cstdlib>
+
 #include <fstream>
+#include <iterator>
 
 // clang-format off
-cplus::CompilerDriver::CompilerDriver()
+cplus::CompilerDriver::CompilerDriver(CompileCache *cache)
     : _pipeline(
         std::make_unique<lx::LexicalAnalyzer>(),
         std::make_unique<ast::AbstractSyntaxTree>(),
         std::make_unique<st::SymbolTable>(),
         std::make_unique<ir::IntermediateRepresentation>(),
-        std::make_unique<x86_64::Codegen>()
-    )
+        std::make_unique<opt::Optimizer>(cplus_opt_level),
+        std::make_unique<x86_64::Codegen>(cplus_opt_level)
+    ), _cache(cache)
 {
-    /* __ctor__ */
+    if (cplus_flags & FLAG_TIME_PASSES) {
+        _pipeline.time(&_timer);
+    }
 }
 // clang-format on
 
-static bool _call(const std::string &what, const std::string &args)
+static void _write_file(const std::string &filename, const std::string &content)
 {
-    const std::string cmd = what + " " + args;
-    const cplus::i32 ret = std::system(cmd.c_str());
+    std::ofstream stream(filename, std::ios::binary);
 
-    if (ret == -1) {
-        return false;
+    if (!stream.is_open()) {
+        throw cplus::exception::Error("CompilerDriver::compile", "Failed to open output stream ", filename);
     }
-    return true;
+    stream.write(content.data(), static_cast<std::streamsize>(content.size()));
 }
 
-void cplus::CompilerDriver::compile(const FileContent &source)
+/**
+ * @brief emit
+ * @details writes the -S / -c byproducts next to the source, from a fresh compilation or a cache entry alike
+ */
+static void _emit(const cplus::FileContent &source, const std::string &assembly, const std::string &object)
 {
-    const auto &x86_64 = _pipeline.execute(source);
-    const std::string filename = source.file + ".s";
-    const std::string object = source.file + ".o";
-    std::ofstream stream(filename, std::ios::binary);
+    if (cplus::cplus_flags & cplus::FLAG_EMIT_ASM) {
+        const std::string filename = source.file + ".s";
 
-    if (!stream.is_open()) {
-        throw exception::Error("CompilerDriver::compile", "Failed to open output stream");
+        _write_file(filename, assembly);
+        cplus::logger::info("Assembly code generated to ", filename);
+    }
+    if (cplus::cplus_flags & cplus::FLAG_EMIT_OBJ) {
+        const std::string filename = source.file + ".o";
+
+        _write_file(filename, object);
+        cplus::logger::info("Object file generated to ", filename);
+    }
+}
+
+/**
+ * @brief compile
+ * @details runs the pipeline on a single file and encodes it straight to an ELF object kept in memory,
+ * thread-safe as long as each thread owns its driver
+ *
+ * with a cache, a hit skips the pipeline entirely, the --show-* flags always compile since they dump the passes
+ */
+cplus::elf::ObjectFile cplus::CompilerDriver::compile(const FileContent &source)
+{
+    const bool cached = _cache && !(cplus_flags & (FLAG_SHOW_TOKENS | FLAG_SHOW_AST | FLAG_SHOW_IR));
+    const std::string key = cached ? _cache->key(source) : std::string();
+
+    if (cached) {
+        if (auto entry = _timed("cache", [&]() { return _cache->load(key); })) {
+            logger::info("Cache hit for ", source.file);
+            _emit(source, entry->assembly, entry->object);
+            return elf::read_relocatable(entry->object, source.file);
+        }
+    }
+
+    const auto machine = _pipeline.execute(source);
+    elf::ObjectFile object = _timed(_assembler.name(), [&]() { return _assembler.run(machine); });
+    const bool emit = cplus_flags & (FLAG_EMIT_ASM | FLAG_EMIT_OBJ);
+
+    if (cached || emit) {
+        const std::string assembly = (cplus_flags & FLAG_EMIT_ASM) ? x86_64::print(machine) : std::string();
+        const std::string image = elf::write_relocatable(object);
+
+        if (cached) {
+            _cache->store(key, {.object = image, .assembly = assembly});
+        }
+        _emit(source, assembly, image);
     }
 
-    stream.write(x86_64.data(), static_cast<std::streamsize>(x86_64.size()));
-    stream.close();
-    logger::info("Assembly code generated to ", filename);
+    return object;
+}
+
+const cplus::PassTimer &cplus::CompilerDriver::timings() const
+{
+    return _timer;
+}
+
+/**
+ * @brief link
+ * @details links every object of the invocation and the prebuilt objects of the command line into cplus_output_file
+ */
+void cplus::CompilerDriver::link(std::vector<elf::ObjectFile> objects)
+{
+    Linker linker;
 
-    if (!_call("as", filename + " -o " + object)) {
-        throw exception::Error("CompilerDriver::compile", "Failed to call 'as'");
+    for (auto &object : objects) {
+        linker.add(std::move(object));
     }
-    logger::info("Object file generated to ", object);
+    for (const cstr path : cplus_link_objects) {
+        std::ifstream stream(path, std::ios::binary);
+        const std::string image((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
 
-    if (!_call("ld", object + " -o " + cplus_output_file)) {
-        throw exception::Error("CompilerDriver::compile", "Failed to call 'ld'");
+        if (!stream) {
+            throw exception::Error("CompilerDriver::link", "Failed to read object file ", path);
+        }
+        linker.add(elf::read_relocatable(image, path));
     }
+
+    linker.link(cplus_output_file);
     logger::info("Executable linked to ", cplus_output_file);
 }
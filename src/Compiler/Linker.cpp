@@ -0,0 +1,406 @@
+#include <CPlus/Codegen/x86-64Assembler.hpp>
+#include <CPlus/Compiler/Linker.hpp>
+#include <CPlus/Error.hpp>
+
+#include <cstring>
+#include <elf.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+/**
+ * public
+ */
+
+void cplus::Linker::add(elf::ObjectFile object)
+{
+    _objects.push_back(std::move(object));
+}
+
+/**
+ * @brief link
+ * @details resolves, lays out, relocates and writes the executable in memory, then to `output` in one write
+ */
+void cplus::Linker::link(const std::string &output)
+{
+    _add_start_stub();
+    _resolve_symbols();
+    _collect_sections();
+    _layout();
+    _relocate();
+    _write(output);
+}
+
+/**
+ * helpers
+ */
+
+static constexpr cplus::u64 IMAGE_BASE = 0x400000;
+static constexpr cplus::u64 PAGE_SIZE = 0x1000;
+static constexpr cplus::u8 INT3 = 0xCC;//<< padding between aligned functions, traps if ever reached
+
+static inline cplus::u64 _align_up(const cplus::u64 value, const cplus::u64 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template<typename T>
+static inline void _store(std::string &image, const cplus::u64 offset, const T value)
+{
+    std::memcpy(image.data() + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief start object
+ * @info `_start: call main; mov rdi, rax; mov rax, 60; syscall`, the exit code is main's return value
+ */
+static cplus::elf::ObjectFile _start_object()
+{
+    using namespace cplus::x86_64;
+
+    MachineModule module;
+    MachineFunction &start = module.functions.emplace_back();
+
+    module.name = "_start";
+    module.symbols.push_back("main");
+    start.name = "_start";
+    start.instructions = {
+        {.mnemonic = Mnemonic::CALL, .condition = Condition::E, .dst = MachineOperand::symbol(0), .src = {}},
+        {.mnemonic = Mnemonic::MOV, .condition = Condition::E, .dst = MachineOperand::r(RDI, 8), .src = MachineOperand::r(RAX, 8)},
+        {.mnemonic = Mnemonic::MOV, .condition = Condition::E, .dst = MachineOperand::r(RAX, 8), .src = MachineOperand::imm(60)},
+        {.mnemonic = Mnemonic::SYSCALL, .condition = Condition::E, .dst = {}, .src = {}},
+    };
+
+    return Assembler().run(module);
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief add start stub
+ * @info placed first so `_start` opens the text segment
+ */
+void cplus::Linker::_add_start_stub()
+{
+    for (const auto &object : _objects) {
+        for (const auto &symbol : object.symbols) {
+            if (symbol.name == "_start" && symbol.binding != elf::Symbol::LOCAL && symbol.section != elf::NO_SECTION) {
+                return;
+            }
+        }
+    }
+    _objects.insert(_objects.begin(), _start_object());
+}
+
+void cplus::Linker::_resolve_symbols()
+{
+    _globals.clear();
+
+    for (u32 o = 0; o < _objects.size(); ++o) {
+        const auto &symbols = _objects[o].symbols;
+
+        for (u32 s = 0; s < symbols.size(); ++s) {
+            const auto &symbol = symbols[s];
+
+            if (symbol.binding == elf::Symbol::LOCAL || symbol.section == elf::NO_SECTION) {
+                continue;
+            }
+
+            const auto [it, inserted] = _globals.try_emplace(symbol.name, Definition{o, s});
+
+            if (inserted) {
+                continue;
+            }
+
+            const auto &existing = _objects[it->second.object].symbols[it->second.symbol];
+
+            if (existing.binding == elf::Symbol::GLOBAL && symbol.binding == elf::Symbol::GLOBAL) {
+                throw exception::Error("Linker::_resolve_symbols", "multiple definition of '", symbol.name, "' in ", _objects[o].name, " and ",
+                    _objects[it->second.object].name);
+            }
+            if (existing.binding == elf::Symbol::WEAK && symbol.binding == elf::Symbol::GLOBAL) {
+                it->second = Definition{o, s};
+            }
+        }
+    }
+}
+
+/**
+ * @brief collect sections
+ * @details marks the sections reachable from the section defining `_start`: a live section keeps alive the section of
+ * every symbol its relocations refer to, through the global table for non-local symbols
+ */
+void cplus::Linker::_collect_sections()
+{
+    std::vector<std::pair<u32, u32>> worklist;
+    const auto start = _globals.find("_start");
+
+    _live.assign(_objects.size(), {});
+    for (u64 o = 0; o < _objects.size(); ++o) {
+        _live[o].assign(_objects[o].sections.size(), start == _globals.end());
+    }
+    if (start == _globals.end()) {
+        return;
+    }
+
+    const auto mark = [&](const u32 object, const u32 section) {
+        if (section != elf::NO_SECTION && !_live[object][section]) {
+            _live[object][section] = true;
+            worklist.emplace_back(object, section);
+        }
+    };
+
+    mark(start->second.object, _objects[start->second.object].symbols[start->second.symbol].section);
+    while (!worklist.empty()) {
+        const auto [o, s] = worklist.back();
+
+        worklist.pop_back();
+        for (const auto &relocation : _objects[o].sections[s].relocations) {
+            const auto &symbol = _objects[o].symbols[relocation.symbol];
+
+            if (symbol.binding == elf::Symbol::LOCAL) {
+                mark(o, symbol.section);
+                continue;
+            }
+
+            const auto definition = _globals.find(symbol.name);
+
+            if (definition != _globals.end()) {
+                mark(definition->second.object, _objects[definition->second.object].symbols[definition->second.symbol].section);
+            }
+        }
+    }
+}
+
+/**
+ * @brief layout
+ * @details text goes right after the ELF and program headers, rodata and data + bss each start on a new page
+ * so every segment keeps its own protection, file offsets and addresses stay congruent modulo the page size
+ */
+void cplus::Linker::_layout()
+{
+    using Kind = elf::Section::Kind;
+
+    constexpr Kind groups[3][2] = {{elf::Section::TEXT, elf::Section::TEXT}, {elf::Section::RODATA, elf::Section::RODATA},
+        {elf::Section::DATA, elf::Section::BSS}};
+    constexpr u32 flags[3] = {PF_R | PF_X, PF_R, PF_R | PF_W};
+
+    const auto present = [&](const Kind kind) {
+        for (u64 o = 0; o < _objects.size(); ++o) {
+            for (u64 s = 0; s < _objects[o].sections.size(); ++s) {
+                if (_live[o][s] && _objects[o].sections[s].kind == kind && !_objects[o].sections[s].data.empty()) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    u64 loads = 0;
+    for (const auto &group : groups) {
+        loads += (present(group[0]) || present(group[1])) ? 1u : 0u;
+    }
+
+    _segments.clear();
+    _image.assign(sizeof(Elf64_Ehdr) + (loads + 1) * sizeof(Elf64_Phdr), '\0');
+    _addresses.assign(_objects.size(), {});
+    for (u64 o = 0; o < _objects.size(); ++o) {
+        _addresses[o].assign(_objects[o].sections.size(), 0);
+    }
+
+    for (u64 g = 0; g < 3; ++g) {
+        if (!present(groups[g][0]) && !present(groups[g][1])) {
+            continue;
+        }
+
+        Segment segment{.offset = g == 0 ? 0 : _align_up(_image.size(), PAGE_SIZE), .file_size = 0, .memory_size = 0, .flags = flags[g]};
+        u64 cursor = std::max<u64>(segment.offset, _image.size());
+
+        for (u64 k = 0; k < (groups[g][0] == groups[g][1] ? 1 : 2); ++k) {
+            const Kind kind = groups[g][k];
+
+            for (u64 o = 0; o < _objects.size(); ++o) {
+                for (u64 s = 0; s < _objects[o].sections.size(); ++s) {
+                    const auto &section = _objects[o].sections[s];
+
+                    if (section.kind != kind || !_live[o][s]) {
+                        continue;
+                    }
+                    cursor = _align_up(cursor, section.alignment);
+                    _addresses[o][s] = IMAGE_BASE + cursor;
+                    cursor += section.data.size();
+
+                    if (kind != elf::Section::BSS && !section.data.empty()) {
+                        _image.resize(cursor, kind == elf::Section::TEXT ? static_cast<char>(INT3) : '\0');
+                        std::memcpy(_image.data() + (cursor - section.data.size()), section.data.data(), section.data.size());
+                    }
+                }
+            }
+        }
+
+        /** @brief a segment holding only .bss has nothing in the file, its offset lies past the image */
+        segment.file_size = _image.size() > segment.offset ? _image.size() - segment.offset : 0;
+        segment.memory_size = cursor - segment.offset;
+        _segments.push_back(segment);
+    }
+}
+
+void cplus::Linker::_relocate()
+{
+    for (u32 o = 0; o < _objects.size(); ++o) {
+        const auto &object = _objects[o];
+
+        for (u64 s = 0; s < object.sections.size(); ++s) {
+            if (!_live[o][s]) {
+                continue;
+            }
+            for (const auto &relocation : object.sections[s].relocations) {
+                const u64 place = _addresses[o][s] + relocation.offset;
+                const u64 at = place - IMAGE_BASE;
+                const i64 value = static_cast<i64>(_symbol_address(o, relocation.symbol)) + relocation.addend;
+                const auto overflow = [&]() {
+                    throw exception::Error("Linker::_relocate", "relocation overflow against '",
+                        object.symbols[relocation.symbol].name, "' in ", object.name);
+                };
+
+                if (object.sections[s].kind == elf::Section::BSS) {
+                    throw exception::Error("Linker::_relocate", "relocation in a bss section of ", object.name);
+                }
+
+                switch (relocation.type) {
+                    case R_X86_64_NONE:
+                        break;
+                    case R_X86_64_64:
+                        _store(_image, at, static_cast<u64>(value));
+                        break;
+                    case R_X86_64_PC64:
+                        _store(_image, at, static_cast<u64>(value - static_cast<i64>(place)));
+                        break;
+                    case R_X86_64_GOTPCRELX:
+                    case R_X86_64_REX_GOTPCRELX:
+                        /** @brief no GOT in a static image: relax `mov reg, [rip + sym@GOTPCREL]` into `lea reg, [rip + sym]` */
+                        if (at < 2 || static_cast<u8>(_image[at - 2]) != 0x8B) {
+                            throw exception::Error("Linker::_relocate", "cannot relax GOT relocation in ", object.name);
+                        }
+                        _image[at - 2] = static_cast<char>(0x8D);
+                        [[fallthrough]];
+                    case R_X86_64_PC32:
+                    case R_X86_64_PLT32: {
+                        const i64 disp = value - static_cast<i64>(place);
+
+                        if (disp < std::numeric_limits<i32>::min() || disp > std::numeric_limits<i32>::max()) {
+                            overflow();
+                        }
+                        _store(_image, at, static_cast<u32>(disp));
+                        break;
+                    }
+                    case R_X86_64_32:
+                        if (value < 0 || value > std::numeric_limits<u32>::max()) {
+                            overflow();
+                        }
+                        _store(_image, at, static_cast<u32>(value));
+                        break;
+                    case R_X86_64_32S:
+                        if (value < std::numeric_limits<i32>::min() || value > std::numeric_limits<i32>::max()) {
+                            overflow();
+                        }
+                        _store(_image, at, static_cast<u32>(value));
+                        break;
+                    default:
+                        throw exception::Error("Linker::_relocate", "unsupported relocation type ", relocation.type, " in ", object.name);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief write
+ * @details fills the ELF and program headers reserved by _layout, the image has no section headers
+ */
+void cplus::Linker::_write(const std::string &output)
+{
+    const auto start = _globals.find("_start");
+
+    if (start == _globals.end()) {
+        throw exception::Error("Linker::_write", "no entry point '_start'");
+    }
+
+    Elf64_Ehdr header{};
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_EXEC;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_entry = _symbol_address(start->second.object, start->second.symbol);
+    header.e_phoff = sizeof(Elf64_Ehdr);
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_phentsize = sizeof(Elf64_Phdr);
+    header.e_phnum = static_cast<u16>(_segments.size() + 1);
+    _store(_image, 0, header);
+
+    for (u64 i = 0; i < _segments.size(); ++i) {
+        const Segment &segment = _segments[i];
+        Elf64_Phdr program{};
+
+        program.p_type = PT_LOAD;
+        program.p_flags = segment.flags;
+        program.p_offset = segment.offset;
+        program.p_vaddr = IMAGE_BASE + segment.offset;
+        program.p_paddr = program.p_vaddr;
+        program.p_filesz = segment.file_size;
+        program.p_memsz = segment.memory_size;
+        program.p_align = PAGE_SIZE;
+        _store(_image, sizeof(Elf64_Ehdr) + i * sizeof(Elf64_Phdr), program);
+    }
+
+    Elf64_Phdr stack{};
+    stack.p_type = PT_GNU_STACK;
+    stack.p_flags = PF_R | PF_W;
+    stack.p_align = 16;
+    _store(_image, sizeof(Elf64_Ehdr) + _segments.size() * sizeof(Elf64_Phdr), stack);
+
+    {
+        std::ofstream stream(output, std::ios::binary | std::ios::trunc);
+
+        if (!stream.is_open()) {
+            throw exception::Error("Linker::_write", "Failed to open output file ", output);
+        }
+        stream.write(_image.data(), static_cast<std::streamsize>(_image.size()));
+    }
+
+    namespace fs = std::filesystem;
+    fs::permissions(output, fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec, fs::perm_options::add);
+}
+
+/**
+ * @brief symbol address
+ * @info non-local symbols always go through the global table so a strong definition wins over a weak one,
+ * undefined weak symbols resolve to 0
+ */
+cplus::u64 cplus::Linker::_symbol_address(const u32 object, const u32 symbol) const
+{
+    const auto &sym = _objects[object].symbols[symbol];
+
+    if (sym.binding == elf::Symbol::LOCAL) {
+        return sym.section == elf::NO_SECTION ? 0 : _addresses[object][sym.section] + sym.value;
+    }
+
+    const auto it = _globals.find(sym.name);
+
+    if (it == _globals.end()) {
+        if (sym.binding == elf::Symbol::WEAK) {
+            return 0;
+        }
+        throw exception::Error("Linker::_symbol_address", "undefined reference to '", sym.name, "' in ", _objects[object].name);
+    }
+
+    const auto &definition = _objects[it->second.object].symbols[it->second.symbol];
+
+    return _addresses[it->second.object][definition.section] + definition.value;
+}
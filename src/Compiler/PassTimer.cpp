@@ -0,0 +1,197 @@
+#include <CPlus/Compiler/PassTimer.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * helpers
+ */
+
+static cplus::f64 _thread_cpu_time()
+{
+    timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<cplus::f64>(ts.tv_sec) * 1e3 + static_cast<cplus::f64>(ts.tv_nsec) / 1e6;
+}
+
+static cplus::f64 _percent(const cplus::f64 part, const cplus::f64 total)
+{
+    return total > 0 ? part * 100 / total : 0;
+}
+
+static std::string _json_string(const std::string &string)
+{
+    std::ostringstream oss;
+
+    oss << '"';
+    for (const char c : string) {
+        switch (c) {
+            case '"':
+                oss << "\\\"";
+                break;
+            case '\\':
+                oss << "\\\\";
+                break;
+            case '\n':
+                oss << "\\n";
+                break;
+            case '\t':
+                oss << "\\t";
+                break;
+            default:
+                if (static_cast<cplus::u8>(c) < 0x20) {
+                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<cplus::u32>(c) << std::dec;
+                } else {
+                    oss << c;
+                }
+        }
+    }
+    oss << '"';
+    return oss.str();
+}
+
+static std::string _json_timings(const std::vector<cplus::PassTiming> &timings, const std::string &indent)
+{
+    std::ostringstream oss;
+    cplus::f64 wall = 0;
+    cplus::f64 cpu = 0;
+
+    oss << std::fixed << std::setprecision(6) << "{\n" << indent << "  \"passes\": [";
+    for (cplus::u64 i = 0; i < timings.size(); ++i) {
+        oss << (i ? ",\n" : "\n") << indent << "    {\"name\": " << _json_string(timings[i].pass)
+            << ", \"wall_ms\": " << timings[i].wall << ", \"cpu_ms\": " << timings[i].cpu << "}";
+        wall += timings[i].wall;
+        cpu += timings[i].cpu;
+    }
+    oss << (timings.empty() ? "" : "\n" + indent + "  ") << "],\n"
+        << indent << "  \"wall_ms\": " << wall << ",\n"
+        << indent << "  \"cpu_ms\": " << cpu << "\n"
+        << indent << "}";
+    return oss.str();
+}
+
+/**
+ * public
+ */
+
+cplus::PassTimer::Scope::Scope(PassTimer &timer, cstr pass)
+    : _timer(timer), _pass(pass), _wall(std::chrono::steady_clock::now()), _cpu(_thread_cpu_time())
+{
+    /* __ctor__ */
+}
+
+cplus::PassTimer::Scope::~Scope()
+{
+    const std::chrono::duration<f64, std::milli> wall = std::chrono::steady_clock::now() - _wall;
+
+    _timer.add(_pass, wall.count(), _thread_cpu_time() - _cpu);
+}
+
+void cplus::PassTimer::add(const std::string &pass, const f64 wall, const f64 cpu)
+{
+    const auto it = std::find_if(_timings.begin(), _timings.end(), [&pass](const PassTiming &timing) { return timing.pass == pass; });
+
+    if (it == _timings.end()) {
+        _timings.push_back({.pass = pass, .wall = wall, .cpu = cpu});
+        return;
+    }
+    it->wall += wall;
+    it->cpu += cpu;
+}
+
+const std::vector<cplus::PassTiming> &cplus::PassTimer::timings() const
+{
+    return _timings;
+}
+
+/**
+ * @brief table
+ * @details one row per pass with its share of the total, in the order the passes ran
+ */
+std::string cplus::PassTimer::table(const std::string &title) const
+{
+    std::ostringstream oss;
+    f64 wall = 0;
+    f64 cpu = 0;
+
+    for (const auto &timing : _timings) {
+        wall += timing.wall;
+        cpu += timing.cpu;
+    }
+
+    oss << "===== Pass timings: " << title << " =====\n"
+        << std::left << std::setw(20) << "Pass" << std::right << std::setw(12) << "Wall (ms)" << std::setw(9) << "%"
+        << std::setw(12) << "CPU (ms)" << std::setw(9) << "%" << "\n"
+        << std::fixed;
+    for (const auto &timing : _timings) {
+        oss << std::left << std::setw(20) << timing.pass << std::right << std::setprecision(3) << std::setw(12) << timing.wall
+            << std::setprecision(1) << std::setw(8) << _percent(timing.wall, wall) << "%" << std::setprecision(3) << std::setw(12)
+            << timing.cpu << std::setprecision(1) << std::setw(8) << _percent(timing.cpu, cpu) << "%\n";
+    }
+    oss << std::left << std::setw(20) << "total" << std::right << std::setprecision(3) << std::setw(12) << wall << std::setw(9) << ""
+        << std::setw(12) << cpu << "\n";
+    return oss.str();
+}
+
+void cplus::TimeReport::add(const std::string &file, const PassTimer &timer)
+{
+    _files.push_back({.file = file, .timings = timer.timings()});
+}
+
+cplus::PassTimer &cplus::TimeReport::global()
+{
+    return _global;
+}
+
+/**
+ * @brief table
+ * @details every pass summed over all files, wall times add up past the elapsed time when files ran in parallel
+ */
+std::string cplus::TimeReport::table() const
+{
+    return _aggregate().table(std::to_string(_files.size()) + " file(s)");
+}
+
+/**
+ * @brief json
+ * @details {"files": [{"file", "passes": [{"name", "wall_ms", "cpu_ms"}], "wall_ms", "cpu_ms"}], "global": {...}, "total": {...}}
+ */
+std::string cplus::TimeReport::json() const
+{
+    std::ostringstream oss;
+
+    oss << "{\n  \"files\": [";
+    for (u64 i = 0; i < _files.size(); ++i) {
+        std::string timings = _json_timings(_files[i].timings, "    ");
+
+        timings.insert(1, "\n      \"file\": " + _json_string(_files[i].file) + ",");
+        oss << (i ? ",\n    " : "\n    ") << timings;
+    }
+    oss << (_files.empty() ? "" : "\n  ") << "],\n"
+        << "  \"global\": " << _json_timings(_global.timings(), "  ") << ",\n"
+        << "  \"total\": " << _json_timings(_aggregate().timings(), "  ") << "\n"
+        << "}\n";
+    return oss.str();
+}
+
+/**
+ * private
+ */
+
+cplus::PassTimer cplus::TimeReport::_aggregate() const
+{
+    PassTimer aggregate;
+
+    for (const auto &file : _files) {
+        for (const auto &timing : file.timings) {
+            aggregate.add(timing.pass, timing.wall, timing.cpu);
+        }
+    }
+    for (const auto &timing : _global.timings()) {
+        aggregate.add(timing.pass, timing.wall, timing.cpu);
+    }
+    return aggregate;
+}
@@ -0,0 +1,81 @@
+#include <CPlus/Compiler/WorkerPool.hpp>
+
+/**
+ * public
+ */
+
+cplus::WorkerPool::WorkerPool(const u32 workers)
+{
+    _workers.reserve(workers);
+    for (u32 i = 0; i < workers; ++i) {
+        _workers.emplace_back([this]() { _loop(); });
+    }
+}
+
+cplus::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _task_available.notify_all();
+
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void cplus::WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(std::move(task));
+        ++_pending;
+    }
+    _task_available.notify_one();
+}
+
+/**
+ * @brief wait
+ * @details blocks until every submitted task has returned
+ */
+void cplus::WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _tasks_done.wait(lock, [this]() { return _pending == 0; });
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief worker loop
+ * @details pops tasks until the pool is stopped and the queue is drained
+ */
+void cplus::WorkerPool::_loop()
+{
+    for (;;) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _task_available.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+            if (_tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_pending;
+        }
+        _tasks_done.notify_all();
+    }
+}
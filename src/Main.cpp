@@ -1,8 +1,10 @@
 #include <CPlus/Arguments.hpp>
 #include <CPlus/Compiler/Driver.hpp>
+#include <CPlus/Compiler/WorkerPool.hpp>
 #include <CPlus/Logger.hpp>
 #include <CPlus/Macros.hpp>
 
+#include <atomic>
 #include <fstream>
 
 static std::string read_file_content(const std::string &filename)
@@ -24,15 +26,138 @@ static std::string read_file_content(const std::string &filename)
     return content;
 }
 
-//TODO: in the future multithread this routine
+// clang-format off
+struct CompilationUnit {
+    cplus::cstr file;
+    std::ostringstream log;
+    cplus::elf::ObjectFile object;
+    cplus::PassTimer timer;
+    std::exception_ptr error;
+    bool done = false;
+};
+// clang-format on
+
+/**
+ * @brief report timings
+ * @details aggregate table of --time-passes, and its JSON form with --time-passes-json
+ */
+static void report_timings(const cplus::TimeReport &report)
+{
+    std::cout << report.table() << std::flush;
+
+    if (!cplus::cplus_time_report) {
+        return;
+    }
+
+    std::ofstream stream(cplus::cplus_time_report);
+
+    if (!stream.is_open()) {
+        throw cplus::exception::Error("cplus::Main", "Failed to open output stream ", cplus::cplus_time_report);
+    }
+    stream << report.json();
+    cplus::logger::info("Pass timings written to ", cplus::cplus_time_report);
+}
+
+/**
+ * @brief compile unit
+ * @details runs on a worker thread, logs are buffered in the unit and flushed by the main thread in input order
+ */
+static void compile_unit(CompilationUnit &unit, cplus::CompileCache *cache)
+{
+    cplus::logger::sink = &unit.log;
+
+    try {
+        cplus::CompilerDriver driver(cache);
+        const std::string content = read_file_content(unit.file);
+        cplus::logger::info("Compiling file: ", unit.file);
+
+        unit.object = driver.compile({unit.file, content});
+        unit.timer = driver.timings();
+
+        if (cplus::cplus_flags & cplus::FLAG_TIME_PASSES) {
+            *cplus::logger::sink << unit.timer.table(unit.file);
+        }
+    } catch (...) {
+        unit.error = std::current_exception();
+    }
+
+    cplus::logger::sink = &std::cout;
+}
+
+/**
+ * @brief compiler routine
+ * @details each input file gets its own CompilerDriver on a pool of cplus_jobs workers,
+ * then every object is linked together once all of them are encoded
+ *
+ * unchanged files are served by the compilation cache, which is trimmed to its size limit after the link
+ */
 static void cplus_compiler_routine()
 {
-    for (const auto &file : cplus::cplus_input_files) {
-        cplus::CompilerDriver driver;
-        const std::string content = read_file_content(file);
-        cplus::logger::info("Compiling file: ", file);
+    std::optional<cplus::CompileCache> cache;
+    cplus::TimeReport report;
+    const cplus::u64 count = cplus::cplus_input_files.size();
+    const cplus::u32 workers = static_cast<cplus::u32>(std::min<cplus::u64>(cplus::cplus_jobs, count));
+    std::vector<CompilationUnit> units(count);
+    std::vector<cplus::elf::ObjectFile> objects;
+    std::atomic<bool> failed = false;
+    std::mutex mutex;
+    std::condition_variable unit_done;
+    cplus::WorkerPool pool(workers);
+
+    if (!(cplus::cplus_flags & cplus::FLAG_NO_CACHE)) {
+        const auto directory = cplus::cplus_cache_dir ? std::optional<std::filesystem::path>(cplus::cplus_cache_dir)
+                                                      : cplus::CompileCache::default_directory();
+
+        if (directory) {
+            cache.emplace(*directory, cplus::cplus_cache_size);
+        }
+    }
+
+    for (cplus::u64 i = 0; i < count; ++i) {
+        units[i].file = cplus::cplus_input_files[i];
+
+        pool.submit([&, i]() {
+            if (!failed) {
+                compile_unit(units[i], cache ? &*cache : nullptr);
+            }
+            if (units[i].error) {
+                failed = true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                units[i].done = true;
+            }
+            unit_done.notify_all();
+        });
+    }
 
-        driver.compile({file, content});
+    /** @brief flush in input order, stop at the first failing file */
+    for (auto &unit : units) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            unit_done.wait(lock, [&unit]() { return unit.done; });
+        }
+
+        std::cout << unit.log.str() << std::flush;
+
+        if (unit.error) {
+            pool.wait();
+            std::rethrow_exception(unit.error);
+        }
+        objects.push_back(std::move(unit.object));
+        report.add(unit.file, unit.timer);
+    }
+
+    {
+        const cplus::PassTimer::Scope scope(report.global(), "linker");
+        cplus::CompilerDriver::link(std::move(objects));
+    }
+
+    if (cache) {
+        cache->report();
+    }
+    if (cplus::cplus_flags & cplus::FLAG_TIME_PASSES) {
+        report_timings(report);
     }
 }
 
@@ -0,0 +1,130 @@
+#include <CPlus/Error.hpp>
+#include <CPlus/Optimization/AnalysisManager.hpp>
+
+/**
+ * public
+ */
+
+cplus::opt::AnalysisManager::AnalysisManager(const ir::Module &module) : _module(module), _functions(module.functions.size())
+{
+    /* __ctor__ */
+}
+
+const cplus::ir::ControlFlowGraph &cplus::opt::AnalysisManager::cfg(const ir::FunctionId function)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!cache.cfg) {
+        cache.cfg = std::make_unique<ir::ControlFlowGraph>(_module.functions[function]);
+        ++_computed;
+    }
+    return *cache.cfg;
+}
+
+const cplus::ir::DominatorTree &cplus::opt::AnalysisManager::dominators(const ir::FunctionId function)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!cache.dominators) {
+        cache.dominators = std::make_unique<ir::DominatorTree>(cfg(function));
+        ++_computed;
+    }
+    return *cache.dominators;
+}
+
+const cplus::ir::DominanceFrontier &cplus::opt::AnalysisManager::dominance_frontier(const ir::FunctionId function)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!cache.dominance_frontier) {
+        cache.dominance_frontier = std::make_unique<ir::DominanceFrontier>(cfg(function), dominators(function));
+        ++_computed;
+    }
+    return *cache.dominance_frontier;
+}
+
+const cplus::ir::LoopInfo &cplus::opt::AnalysisManager::loops(const ir::FunctionId function)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!cache.loops) {
+        cache.loops = std::make_unique<ir::LoopInfo>(cfg(function), dominators(function));
+        ++_computed;
+    }
+    return *cache.loops;
+}
+
+const cplus::ir::Liveness &cplus::opt::AnalysisManager::liveness(const ir::FunctionId function)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!cache.liveness) {
+        cache.liveness = std::make_unique<ir::Liveness>(_module.functions[function]);
+        ++_computed;
+    }
+    return *cache.liveness;
+}
+
+const cplus::ir::CallGraph &cplus::opt::AnalysisManager::call_graph()
+{
+    if (!_call_graph) {
+        _call_graph = std::make_unique<ir::CallGraph>(_module);
+        ++_computed;
+    }
+    return *_call_graph;
+}
+
+void cplus::opt::AnalysisManager::invalidate(const ir::FunctionId function, u32 preserved)
+{
+    FunctionAnalyses &cache = _get(function);
+
+    if (!(preserved & ANALYSIS_CFG)) {
+        preserved &= ~(ANALYSIS_CONTROL_FLOW | ANALYSIS_LIVENESS);
+    }
+    if (!(preserved & ANALYSIS_DOMINATORS)) {
+        preserved &= ~(ANALYSIS_DOMINANCE_FRONTIER | ANALYSIS_LOOPS);
+    }
+
+    if (!(preserved & ANALYSIS_CFG)) {
+        cache.cfg.reset();
+    }
+    if (!(preserved & ANALYSIS_DOMINATORS)) {
+        cache.dominators.reset();
+    }
+    if (!(preserved & ANALYSIS_DOMINANCE_FRONTIER)) {
+        cache.dominance_frontier.reset();
+    }
+    if (!(preserved & ANALYSIS_LOOPS)) {
+        cache.loops.reset();
+    }
+    if (!(preserved & ANALYSIS_LIVENESS)) {
+        cache.liveness.reset();
+    }
+    if (!(preserved & ANALYSIS_CALL_GRAPH)) {
+        _call_graph.reset();
+    }
+}
+
+void cplus::opt::AnalysisManager::invalidate(const u32 preserved)
+{
+    _functions.resize(_module.functions.size());
+
+    for (ir::FunctionId f = 0; f < _functions.size(); ++f) {
+        invalidate(f, preserved);
+    }
+    if (!(preserved & ANALYSIS_CALL_GRAPH)) {
+        _call_graph.reset();
+    }
+}
+
+/**
+ * private
+ */
+
+cplus::opt::AnalysisManager::FunctionAnalyses &cplus::opt::AnalysisManager::_get(const ir::FunctionId function)
+{
+    if (function >= _functions.size()) {
+        throw exception::Error("AnalysisManager::_get", "function ", function, " was added without invalidating the module");
+    }
+    return _functions[function];
+}
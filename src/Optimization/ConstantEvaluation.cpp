@@ -0,0 +1,275 @@
+#include <CPlus/Optimization/ConstantEvaluation.hpp>
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * public
+ */
+
+cplus::opt::ConstantEvaluation::ConstantEvaluation(std::shared_ptr<std::unordered_set<std::string>> given_up)
+    : _given_up(given_up ? std::move(given_up) : std::make_shared<std::unordered_set<std::string>>())
+{
+    /* __ctor__ */
+}
+
+cplus::opt::PassResult cplus::opt::ConstantEvaluation::run(ir::Module &module, AnalysisManager &analyses)
+{
+    const ir::CallGraph &graph = analyses.call_graph();
+    u64 folded = 0;
+
+    _module = &module;
+    _steps = 0;
+    _pure.assign(module.functions.size(), false);
+    for (ir::FunctionId f = 0; f < module.functions.size(); ++f) {
+        _pure[f] = graph.is_pure(f);
+    }
+
+    for (ir::FunctionId f = 0; f < module.functions.size(); ++f) {
+        const u64 count = _fold(module.functions[f]);
+
+        if (count != 0) {
+            analyses.invalidate(f, ANALYSIS_CONTROL_FLOW);
+            folded += count;
+        }
+    }
+
+    _memory.clear();
+    _module = nullptr;
+    return {.changes = folded, .preserved = ANALYSIS_ALL};
+}
+
+/**
+ * helpers
+ */
+
+/** @brief only a number or a bool can replace a call, a string result is the address of a literal */
+static inline bool _returns_number(const cplus::ir::Function &function)
+{
+    return function.return_type == cplus::ast::Type::INT || function.return_type == cplus::ast::Type::BOOL;
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief fold
+ * @details an argument may be a copy of a constant, as the IR is generated, or the result of a call folded before it.
+ * the constants replace their uses once every call site of the function was evaluated. once the steps of the run
+ * are spent no call is evaluated anymore, the callee that spent them is given up
+ */
+cplus::u64 cplus::opt::ConstantEvaluation::_fold(ir::Function &function)
+{
+    std::vector<std::optional<i32>> constants(function.values);
+    std::vector<i32> arguments;
+    u64 folded = 0;
+
+    const auto constant = [&](const ir::Operand &operand) {
+        return operand.is_immediate() || (operand.is_value() && constants[operand.id()].has_value());
+    };
+    const auto read = [&](const ir::Operand &operand) {
+        return operand.is_value() ? *constants[operand.id()] : static_cast<i32>(operand.data);
+    };
+
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            if (instruction.opcode == ir::Opcode::MOV && constant(instruction.operands[0])) {
+                constants[instruction.result] = read(instruction.operands[0]);
+                continue;
+            }
+            if (instruction.opcode != ir::Opcode::CALL || !_pure[instruction.callee] || !_returns_number(_module->functions[instruction.callee])
+                || !std::ranges::all_of(instruction.operands, constant)) {
+                continue;
+            }
+
+            const std::string &callee = _module->functions[instruction.callee].name;
+
+            if (_steps > MAX_STEPS || _given_up->contains(callee)) {
+                continue;
+            }
+
+            arguments.clear();
+            for (const auto &operand : instruction.operands) {
+                arguments.push_back(read(operand));
+            }
+
+            _memory.clear();
+            constants[instruction.result] = _call(instruction.callee, arguments, 0);
+            folded += constants[instruction.result].has_value();
+            if (_steps > MAX_STEPS) {
+                _given_up->insert(callee);
+            }
+        }
+    }
+
+    if (folded == 0) {
+        return 0;
+    }
+
+    for (auto &block : function.blocks) {
+        std::erase_if(block.instructions, [&](const ir::Instruction &instruction) {
+            return instruction.opcode == ir::Opcode::CALL && constants[instruction.result];
+        });
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.is_value() && constants[operand.id()]) {
+                    operand = ir::Operand::immediate(*constants[operand.id()]);
+                }
+            }
+        }
+    }
+    return folded;
+}
+
+/**
+ * @brief call
+ * @details interprets a function from its entry block until it returns. the phis of a block are assigned together,
+ * from the edge it was entered by, before the rest of the block runs. reading an operand that is not a number, the
+ * address of a string or a global, gives up: it is only known once linked
+ * @return the returned value (0 for a `ret` without one), nothing if the evaluation was given up
+ */
+std::optional<cplus::i32> cplus::opt::ConstantEvaluation::_call(const ir::FunctionId function, const std::vector<i32> &arguments,
+    const u32 depth)
+{
+    const ir::Function &f = _module->functions[function];
+
+    if (depth > MAX_DEPTH || f.blocks.empty() || arguments.size() != f.parameters) {
+        return std::nullopt;
+    }
+
+    std::vector<i32> values(f.values, 0);
+    std::vector<std::pair<ir::ValueId, i32>> phis;
+    std::vector<i32> nested;
+    ir::BlockId block = 0;
+    ir::BlockId previous = ir::INVALID_ID;
+
+    bool opaque = false;//<< an operand that is not a number was read
+
+    const auto read = [&](const ir::Operand &operand) {
+        opaque = opaque || (!operand.is_value() && !operand.is_immediate());
+        return operand.is_value() ? values[operand.id()] : static_cast<i32>(operand.data);
+    };
+
+    for (;;) {
+        const auto &instructions = f.blocks[block].instructions;
+        const ir::BlockId current = block;
+        u64 i = 0;
+
+        /** @brief a block without a terminator would fall off the function */
+        if (instructions.empty() || !ir::is_terminator(instructions.back().opcode)) {
+            return std::nullopt;
+        }
+
+        phis.clear();
+        for (; i < instructions.size() && instructions[i].opcode == ir::Opcode::PHI; ++i) {
+            const auto &operands = instructions[i].operands;
+
+            for (u64 k = 0; k + 1 < operands.size(); k += 2) {
+                if (operands[k + 1].id() == previous) {
+                    phis.emplace_back(instructions[i].result, read(operands[k]));
+                    break;
+                }
+            }
+        }
+        if (opaque) {
+            return std::nullopt;
+        }
+        for (const auto &[value, incoming] : phis) {
+            values[value] = incoming;
+        }
+
+        for (; i < instructions.size(); ++i) {
+            const ir::Instruction &instruction = instructions[i];
+            const auto &operands = instruction.operands;
+
+            if (++_steps > MAX_STEPS) {
+                return std::nullopt;
+            }
+
+            switch (instruction.opcode) {
+                case ir::Opcode::ARG:
+                    values[instruction.result] = arguments[static_cast<u64>(operands[0].data)];
+                    break;
+                case ir::Opcode::MOV:
+                    values[instruction.result] = read(operands[0]);
+                    break;
+                case ir::Opcode::UNDEF:
+                    values[instruction.result] = 0;
+                    break;
+                case ir::Opcode::LOAD:
+                case ir::Opcode::STORE: {
+                    const u32 global = operands[0].id();
+                    const i32 index = read(operands[1]);
+
+                    if (index < 0 || static_cast<u32>(index) >= _module->globals[global].size) {
+                        return std::nullopt;
+                    }
+                    if (instruction.opcode == ir::Opcode::STORE) {
+                        _memory[{global, index}] = read(operands[2]);
+                        break;
+                    }
+
+                    const auto it = _memory.find({global, index});
+
+                    values[instruction.result] = it == _memory.end() ? 0 : it->second;
+                    break;
+                }
+                case ir::Opcode::CALL: {
+                    nested.clear();
+                    for (const auto &operand : operands) {
+                        nested.push_back(read(operand));
+                    }
+
+                    const std::optional<i32> result = _call(instruction.callee, nested, depth + 1);
+
+                    if (!result) {
+                        return std::nullopt;
+                    }
+                    values[instruction.result] = *result;
+                    break;
+                }
+                case ir::Opcode::BR:
+                    block = operands[read(operands[0]) != 0 ? 1 : 2].id();
+                    break;
+                case ir::Opcode::JMP:
+                    block = operands[0].id();
+                    break;
+                case ir::Opcode::SWITCH: {
+                    const i32 value = read(operands[0]);
+
+                    block = operands[1].id();
+                    for (u64 k = 2; k + 1 < operands.size(); k += 2) {
+                        if (static_cast<i32>(operands[k].data) == value) {
+                            block = operands[k + 1].id();
+                            break;
+                        }
+                    }
+                    break;
+                }
+                case ir::Opcode::RET: {
+                    const i32 result = operands.empty() ? 0 : read(operands[0]);
+
+                    if (opaque) {
+                        return std::nullopt;
+                    }
+                    return result;
+                }
+                default: {
+                    const i32 right = operands.size() > 1 ? read(operands[1]) : 0;
+                    const std::optional<i32> result = ir::fold(instruction.opcode, read(operands[0]), right);
+
+                    if (!result) {
+                        return std::nullopt;
+                    }
+                    values[instruction.result] = *result;
+                    break;
+                }
+            }
+            if (opaque) {
+                return std::nullopt;
+            }
+        }
+        previous = current;
+    }
+}
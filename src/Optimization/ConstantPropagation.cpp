@@ -0,0 +1,511 @@
+#include <CPlus/Optimization/ConstantPropagation.hpp>
+
+/**
+ * public
+ */
+
+cplus::opt::PassResult cplus::opt::ConstantPropagation::run(ir::Function &function, [[maybe_unused]] const ir::FunctionId id,
+    [[maybe_unused]] AnalysisManager &analyses)
+{
+    _cfg_changed = false;
+
+    const u64 changed = _propagate(function);
+
+    /** @brief calls are never folded, but a removed block takes its calls with it */
+    return {.changes = changed, .preserved = _cfg_changed ? ANALYSIS_NONE : ANALYSIS_CONTROL_FLOW | ANALYSIS_CALL_GRAPH};
+}
+
+/**
+ * helpers
+ */
+
+static inline constexpr cplus::u64 _edge(const cplus::ir::BlockId from, const cplus::ir::BlockId to)
+{
+    return static_cast<cplus::u64>(from) << 32 | to;
+}
+
+/** @brief leading phis of a block, the only instructions that depend on the edge a block is entered from */
+static inline bool _is_phi(const cplus::ir::Instruction &instruction)
+{
+    return instruction.opcode == cplus::ir::Opcode::PHI;
+}
+
+/**
+ * private
+ */
+
+cplus::u64 cplus::opt::ConstantPropagation::_propagate(ir::Function &function)
+{
+    if (function.blocks.empty()) {
+        return 0;
+    }
+
+    _function = &function;
+    _values.assign(function.values, Lattice{});
+    _uses.assign(function.values, {});
+    _executable.assign(function.blocks.size(), false);
+    _edges.clear();
+
+    for (ir::BlockId b = 0; b < function.blocks.size(); ++b) {
+        for (u32 i = 0; i < function.blocks[b].instructions.size(); ++i) {
+            for (const auto &operand : function.blocks[b].instructions[i].operands) {
+                if (operand.is_value()) {
+                    _uses[operand.id()].push_back({.block = b, .index = i});
+                }
+            }
+        }
+    }
+
+    _executable[0] = true;
+    _block_worklist.assign(1, 0);
+    _solve();
+
+    u64 changed = _rewrite();
+
+    changed += _simplify_phis();
+    changed += _merge_blocks();
+
+    _function = nullptr;
+    return changed;
+}
+
+/**
+ * @brief solve
+ * @details drains both worklists: a value that moved down the lattice re-evaluates its reachable uses,
+ * a block that became executable is evaluated as a whole
+ */
+void cplus::opt::ConstantPropagation::_solve()
+{
+    while (!_block_worklist.empty() || !_value_worklist.empty()) {
+        while (!_value_worklist.empty()) {
+            const ir::ValueId value = _value_worklist.back();
+
+            _value_worklist.pop_back();
+            for (const Use &use : _uses[value]) {
+                if (_executable[use.block]) {
+                    _visit(use.block, _function->blocks[use.block].instructions[use.index]);
+                }
+            }
+        }
+
+        if (!_block_worklist.empty()) {
+            const ir::BlockId block = _block_worklist.back();
+
+            _block_worklist.pop_back();
+            for (const auto &instruction : _function->blocks[block].instructions) {
+                _visit(block, instruction);
+            }
+        }
+    }
+}
+
+void cplus::opt::ConstantPropagation::_visit(const ir::BlockId block, const ir::Instruction &instruction)
+{
+    switch (instruction.opcode) {
+        case ir::Opcode::PHI:
+            _visit_phi(block, instruction);
+            return;
+        case ir::Opcode::BR:
+        case ir::Opcode::JMP:
+        case ir::Opcode::SWITCH:
+            _visit_terminator(block, instruction);
+            return;
+        case ir::Opcode::RET:
+        case ir::Opcode::STORE:
+            return;
+        case ir::Opcode::MOV:
+            _update(instruction.result, _lattice(instruction.operands[0]));
+            return;
+        case ir::Opcode::ARG:
+        case ir::Opcode::UNDEF:
+        case ir::Opcode::LOAD:
+        case ir::Opcode::CALL:
+            if (instruction.result != ir::INVALID_ID) {
+                _update(instruction.result, {.state = Lattice::OVERDEFINED});
+            }
+            return;
+        default:
+            break;
+    }
+
+    const Lattice left = _lattice(instruction.operands[0]);
+    const Lattice right = instruction.operands.size() > 1 ? _lattice(instruction.operands[1]) : Lattice{.state = Lattice::CONSTANT};
+
+    _update(instruction.result, _evaluate(instruction.opcode, left, right));
+}
+
+/** @brief meet of the incoming values whose edge is executable, the others may still never be taken */
+void cplus::opt::ConstantPropagation::_visit_phi(const ir::BlockId block, const ir::Instruction &instruction)
+{
+    Lattice merged;
+
+    for (u64 i = 0; i + 1 < instruction.operands.size(); i += 2) {
+        if (!_is_executable(instruction.operands[i + 1].id(), block)) {
+            continue;
+        }
+
+        const Lattice incoming = _lattice(instruction.operands[i]);
+
+        if (incoming.state == Lattice::UNKNOWN) {
+            continue;
+        }
+        if (merged.state == Lattice::UNKNOWN) {
+            merged = incoming;
+        } else if (merged != incoming) {
+            merged = {.state = Lattice::OVERDEFINED};
+            break;
+        }
+    }
+    _update(instruction.result, merged);
+}
+
+/**
+ * @brief visit terminator
+ * @info conditions are compared on 32 bits like the backend does, an unknown condition marks no edge yet
+ */
+void cplus::opt::ConstantPropagation::_visit_terminator(const ir::BlockId block, const ir::Instruction &instruction)
+{
+    const auto &operands = instruction.operands;
+
+    if (instruction.opcode == ir::Opcode::JMP) {
+        _mark_edge(block, operands[0].id());
+        return;
+    }
+
+    const Lattice condition = _lattice(operands[0]);
+
+    if (condition.state == Lattice::UNKNOWN) {
+        return;
+    }
+    if (condition.state == Lattice::OVERDEFINED) {
+        for (u64 i = 1; i < operands.size(); ++i) {
+            if (operands[i].kind == ir::Operand::BLOCK) {
+                _mark_edge(block, operands[i].id());
+            }
+        }
+        return;
+    }
+
+    const i32 value = static_cast<i32>(condition.value);
+
+    if (instruction.opcode == ir::Opcode::BR) {
+        _mark_edge(block, operands[value != 0 ? 1 : 2].id());
+        return;
+    }
+
+    ir::BlockId target = operands[1].id();
+
+    for (u64 i = 2; i + 1 < operands.size(); i += 2) {
+        if (static_cast<i32>(operands[i].data) == value) {
+            target = operands[i + 1].id();
+            break;
+        }
+    }
+    _mark_edge(block, target);
+}
+
+/** @brief a block reached for the first time is evaluated whole, a new edge into a known block only changes its phis */
+void cplus::opt::ConstantPropagation::_mark_edge(const ir::BlockId from, const ir::BlockId to)
+{
+    if (!_edges.insert(_edge(from, to)).second) {
+        return;
+    }
+    if (!_executable[to]) {
+        _executable[to] = true;
+        _block_worklist.push_back(to);
+        return;
+    }
+    for (const auto &instruction : _function->blocks[to].instructions) {
+        if (!_is_phi(instruction)) {
+            break;
+        }
+        _visit_phi(to, instruction);
+    }
+}
+
+/** @brief values only move down the lattice, overdefined is final */
+void cplus::opt::ConstantPropagation::_update(const ir::ValueId value, const Lattice lattice)
+{
+    Lattice &current = _values[value];
+
+    if (current == lattice || current.state == Lattice::OVERDEFINED || lattice.state == Lattice::UNKNOWN) {
+        return;
+    }
+    current = lattice;
+    _value_worklist.push_back(value);
+}
+
+cplus::opt::ConstantPropagation::Lattice cplus::opt::ConstantPropagation::_lattice(const ir::Operand &operand) const
+{
+    switch (operand.kind) {
+        case ir::Operand::IMMEDIATE:
+            return {.state = Lattice::CONSTANT, .value = operand.data};
+        case ir::Operand::VALUE:
+            return _values[operand.id()];
+        default:
+            return {.state = Lattice::OVERDEFINED};
+    }
+}
+
+bool cplus::opt::ConstantPropagation::_is_executable(const ir::BlockId from, const ir::BlockId to) const
+{
+    return _edges.contains(_edge(from, to));
+}
+
+/**
+ * @brief rewrite
+ * @details applies the solution to the executable blocks, then deletes the others
+ */
+cplus::u64 cplus::opt::ConstantPropagation::_rewrite()
+{
+    auto &blocks = _function->blocks;
+    u64 changed = 0;
+
+    for (ir::BlockId b = 0; b < blocks.size(); ++b) {
+        if (!_executable[b]) {
+            continue;
+        }
+
+        auto &instructions = blocks[b].instructions;
+
+        for (auto &instruction : instructions) {
+            if (_is_phi(instruction)) {
+                auto &operands = instruction.operands;
+
+                for (u64 i = operands.size(); i >= 2; i -= 2) {
+                    if (!_is_executable(operands[i - 1].id(), b)) {
+                        operands.erase(operands.begin() + static_cast<i64>(i) - 2, operands.begin() + static_cast<i64>(i));
+                    }
+                }
+            }
+            for (auto &operand : instruction.operands) {
+                if (operand.is_value() && _values[operand.id()].state == Lattice::CONSTANT) {
+                    operand = ir::Operand::immediate(_values[operand.id()].value);
+                }
+            }
+        }
+
+        changed += std::erase_if(instructions, [this](const ir::Instruction &instruction) {
+            return instruction.result != ir::INVALID_ID && instruction.opcode != ir::Opcode::CALL && instruction.opcode != ir::Opcode::ARG
+                && _values[instruction.result].state == Lattice::CONSTANT;
+        });
+
+        /** @brief a branch that takes a single edge is a jump */
+        if (instructions.empty() || (instructions.back().opcode != ir::Opcode::BR && instructions.back().opcode != ir::Opcode::SWITCH)) {
+            continue;
+        }
+
+        std::vector<ir::BlockId> taken;
+
+        for (const ir::BlockId successor : ir::successors(blocks[b])) {
+            if (_is_executable(b, successor)) {
+                taken.push_back(successor);
+            }
+        }
+        if (taken.size() == 1) {
+            instructions.back() = {.opcode = ir::Opcode::JMP, .operands = {ir::Operand::block(taken[0])}};
+            _cfg_changed = true;
+            ++changed;
+        }
+    }
+
+    _remove_blocks(_executable);
+    return changed;
+}
+
+/**
+ * @brief simplify phis
+ * @details a phi whose incoming values are all the same (or itself, around a loop) is that value,
+ * repeated until no phi folds since removing one may make another trivial
+ */
+cplus::u64 cplus::opt::ConstantPropagation::_simplify_phis()
+{
+    std::vector<ir::Operand> replacement(_function->values);
+    bool changed = true;
+    u64 folded = 0;
+
+    for (ir::ValueId v = 0; v < _function->values; ++v) {
+        replacement[v] = ir::Operand::value(v);
+    }
+
+    const auto resolve = [&replacement](ir::Operand operand) {
+        while (operand.is_value() && replacement[operand.id()] != operand) {
+            operand = replacement[operand.id()];
+        }
+        return operand;
+    };
+
+    while (changed) {
+        changed = false;
+
+        for (auto &block : _function->blocks) {
+            for (const auto &instruction : block.instructions) {
+                if (!_is_phi(instruction)) {
+                    break;
+                }
+                if (replacement[instruction.result] != ir::Operand::value(instruction.result)) {
+                    continue;
+                }
+
+                const ir::Operand self = ir::Operand::value(instruction.result);
+                ir::Operand single;
+                bool trivial = true;
+
+                for (u64 i = 0; i < instruction.operands.size(); i += 2) {
+                    const ir::Operand incoming = resolve(instruction.operands[i]);
+
+                    if (incoming == self || incoming == single) {
+                        continue;
+                    }
+                    if (single.kind != ir::Operand::NONE) {
+                        trivial = false;
+                        break;
+                    }
+                    single = incoming;
+                }
+                if (trivial && single.kind != ir::Operand::NONE) {
+                    replacement[instruction.result] = single;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (auto &block : _function->blocks) {
+        folded += std::erase_if(block.instructions, [&replacement](const ir::Instruction &instruction) {
+            return _is_phi(instruction) && replacement[instruction.result] != ir::Operand::value(instruction.result);
+        });
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                operand = resolve(operand);
+            }
+        }
+    }
+    return folded;
+}
+
+/**
+ * @brief merge blocks
+ * @details a block whose only predecessor is the block laid out before it, ending with a jump to it,
+ * is appended to that predecessor: resolved branches collapse into straight-line code
+ */
+cplus::u64 cplus::opt::ConstantPropagation::_merge_blocks()
+{
+    auto &blocks = _function->blocks;
+    std::vector<u32> predecessors(blocks.size(), 0);
+    std::vector<bool> live(blocks.size(), true);
+    u64 merged = 0;
+
+    for (const auto &block : blocks) {
+        for (const ir::BlockId successor : ir::successors(block)) {
+            ++predecessors[successor];
+        }
+    }
+
+    for (ir::BlockId b = 0; b < blocks.size(); ++b) {
+        ir::BlockId next = b + 1;
+
+        while (next < blocks.size()) {
+            auto &instructions = blocks[b].instructions;
+
+            if (instructions.empty() || instructions.back().opcode != ir::Opcode::JMP || instructions.back().operands[0].id() != next
+                || predecessors[next] != 1 || (!blocks[next].instructions.empty() && _is_phi(blocks[next].instructions.front()))) {
+                break;
+            }
+
+            instructions.pop_back();
+            instructions.insert(instructions.end(), std::make_move_iterator(blocks[next].instructions.begin()),
+                std::make_move_iterator(blocks[next].instructions.end()));
+            blocks[next].instructions.clear();
+            live[next] = false;
+            ++merged;
+
+            /** @brief the successors of the merged block are now entered from b */
+            for (const ir::BlockId successor : ir::successors(blocks[b])) {
+                for (auto &instruction : blocks[successor].instructions) {
+                    if (!_is_phi(instruction)) {
+                        break;
+                    }
+                    for (u64 i = 1; i < instruction.operands.size(); i += 2) {
+                        if (instruction.operands[i].id() == next) {
+                            instruction.operands[i] = ir::Operand::block(b);
+                        }
+                    }
+                }
+            }
+            ++next;
+        }
+        b = next - 1;
+    }
+
+    _remove_blocks(live);
+    return merged;
+}
+
+/** @brief erases the blocks that are not live and renumbers the others, keeping their layout order */
+void cplus::opt::ConstantPropagation::_remove_blocks(const std::vector<bool> &live)
+{
+    auto &blocks = _function->blocks;
+    std::vector<ir::BlockId> renamed(blocks.size(), ir::INVALID_ID);
+    ir::BlockId count = 0;
+
+    for (ir::BlockId b = 0; b < blocks.size(); ++b) {
+        if (live[b]) {
+            renamed[b] = count++;
+        }
+    }
+    if (count == blocks.size()) {
+        return;
+    }
+
+    _cfg_changed = true;
+    for (ir::BlockId b = 0; b < blocks.size(); ++b) {
+        if (live[b] && renamed[b] != b) {
+            blocks[renamed[b]] = std::move(blocks[b]);
+        }
+    }
+    blocks.resize(count);
+
+    for (auto &block : blocks) {
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.kind == ir::Operand::BLOCK) {
+                    operand = ir::Operand::block(renamed[operand.id()]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief evaluate
+ * @details folds a binary or unary instruction on 32 bits (the width of the backend), wrapping on overflow.
+ * a zero operand decides `mul` and `and`, all ones decides `or`, whatever the other operand is
+ */
+cplus::opt::ConstantPropagation::Lattice cplus::opt::ConstantPropagation::_evaluate(const ir::Opcode opcode, const Lattice left,
+    const Lattice right)
+{
+    const auto holds = [](const Lattice lattice, const i32 value) {
+        return lattice.state == Lattice::CONSTANT && static_cast<i32>(lattice.value) == value;
+    };
+
+    if ((opcode == ir::Opcode::MUL || opcode == ir::Opcode::AND) && (holds(left, 0) || holds(right, 0))) {
+        return {.state = Lattice::CONSTANT, .value = 0};
+    }
+    if (opcode == ir::Opcode::OR && (holds(left, -1) || holds(right, -1))) {
+        return {.state = Lattice::CONSTANT, .value = -1};
+    }
+    if (left.state == Lattice::UNKNOWN || right.state == Lattice::UNKNOWN) {
+        return {};
+    }
+    if (left.state == Lattice::OVERDEFINED || right.state == Lattice::OVERDEFINED) {
+        return {.state = Lattice::OVERDEFINED};
+    }
+
+    const std::optional<i32> result = ir::fold(opcode, static_cast<i32>(left.value), static_cast<i32>(right.value));
+
+    if (!result) {
+        return {.state = Lattice::OVERDEFINED};
+    }
+    return {.state = Lattice::CONSTANT, .value = *result};
+}
@@ -0,0 +1,67 @@
+#include <CPlus/Optimization/CopyPropagation.hpp>
+
+/**
+ * public
+ */
+
+cplus::opt::PassResult cplus::opt::CopyPropagation::run(ir::Function &function, [[maybe_unused]] const ir::FunctionId id,
+    [[maybe_unused]] AnalysisManager &analyses)
+{
+    return {.changes = _propagate(function), .preserved = ANALYSIS_CONTROL_FLOW | ANALYSIS_CALL_GRAPH};
+}
+
+/**
+ * helpers
+ */
+
+static inline bool _is_copy(const cplus::ir::Instruction &instruction)
+{
+    return instruction.opcode == cplus::ir::Opcode::MOV && (instruction.operands[0].is_value() || instruction.operands[0].is_immediate());
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief propagate
+ * @details the source of a copy may itself be a copy defined later in the layout (a loop phi operand),
+ * so sources are recorded for the whole function before any use is rewritten
+ */
+cplus::u64 cplus::opt::CopyPropagation::_propagate(ir::Function &function)
+{
+    std::vector<ir::Operand> sources(function.values);
+    u64 copies = 0;
+
+    for (ir::ValueId v = 0; v < function.values; ++v) {
+        sources[v] = ir::Operand::value(v);
+    }
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            if (_is_copy(instruction)) {
+                sources[instruction.result] = instruction.operands[0];
+                ++copies;
+            }
+        }
+    }
+    if (copies == 0) {
+        return 0;
+    }
+
+    const auto resolve = [&sources](ir::Operand operand) {
+        while (operand.is_value() && sources[operand.id()] != operand) {
+            operand = sources[operand.id()];
+        }
+        return operand;
+    };
+
+    for (auto &block : function.blocks) {
+        std::erase_if(block.instructions, _is_copy);
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                operand = resolve(operand);
+            }
+        }
+    }
+    return copies;
+}
@@ -0,0 +1,135 @@
+#include <CPlus/Optimization/DeadFunctionElimination.hpp>
+
+#include <algorithm>
+
+/**
+ * public
+ */
+
+cplus::opt::PassResult cplus::opt::DeadFunctionElimination::run(ir::Module &module, AnalysisManager &analyses)
+{
+    const std::vector<bool> live = _find_live(module, analyses.call_graph());
+    const u64 removed = static_cast<u64>(std::ranges::count(live, false));
+
+    if (removed == 0) {
+        return {};
+    }
+    _remove(module, live);
+    return {.changes = removed, .preserved = ANALYSIS_NONE};
+}
+
+/**
+ * helpers
+ */
+
+/**
+ * @brief compact
+ * @details drops the entries of a module pool (strings or globals) no operand of `kind` refers to anymore, and
+ * renumbers the operands referring to the others, which keep their order
+ */
+template<typename T>
+static void _compact(std::vector<cplus::ir::Function> &functions, std::vector<T> &pool, const cplus::ir::Operand::Kind kind)
+{
+    std::vector<cplus::u32> ids(pool.size(), cplus::ir::INVALID_ID);
+    std::vector<T> kept;
+
+    for (const auto &function : functions) {
+        for (const auto &block : function.blocks) {
+            for (const auto &instruction : block.instructions) {
+                for (const auto &operand : instruction.operands) {
+                    if (operand.kind == kind) {
+                        ids[operand.id()] = 0;
+                    }
+                }
+            }
+        }
+    }
+    for (cplus::u64 i = 0; i < pool.size(); ++i) {
+        if (ids[i] != cplus::ir::INVALID_ID) {
+            ids[i] = static_cast<cplus::u32>(kept.size());
+            kept.push_back(std::move(pool[i]));
+        }
+    }
+
+    for (auto &function : functions) {
+        for (auto &block : function.blocks) {
+            for (auto &instruction : block.instructions) {
+                for (auto &operand : instruction.operands) {
+                    if (operand.kind == kind) {
+                        operand.data = ids[operand.id()];
+                    }
+                }
+            }
+        }
+    }
+    pool = std::move(kept);
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief find live
+ * @return per function, whether it may be called: everything is live in a module without `main`
+ */
+std::vector<bool> cplus::opt::DeadFunctionElimination::_find_live(const ir::Module &module, const ir::CallGraph &graph)
+{
+    const auto &functions = module.functions;
+    const bool program = std::ranges::any_of(functions, [](const ir::Function &function) { return function.name == "main"; });
+    std::vector<bool> live(functions.size(), !program);
+    std::vector<ir::FunctionId> worklist;
+
+    if (!program) {
+        return live;
+    }
+
+    for (ir::FunctionId f = 0; f < functions.size(); ++f) {
+        if (functions[f].name == "main" || functions[f].exported) {
+            live[f] = true;
+            worklist.push_back(f);
+        }
+    }
+    while (!worklist.empty()) {
+        const ir::FunctionId function = worklist.back();
+
+        worklist.pop_back();
+        for (const ir::FunctionId callee : graph.callees(function)) {
+            if (!live[callee]) {
+                live[callee] = true;
+                worklist.push_back(callee);
+            }
+        }
+    }
+    return live;
+}
+
+/**
+ * @brief remove
+ * @details the live functions keep their order, calls are renumbered to their new index
+ */
+void cplus::opt::DeadFunctionElimination::_remove(ir::Module &module, const std::vector<bool> &live)
+{
+    std::vector<ir::FunctionId> ids(module.functions.size(), ir::INVALID_ID);
+    std::vector<ir::Function> kept;
+
+    for (ir::FunctionId f = 0; f < module.functions.size(); ++f) {
+        if (live[f]) {
+            ids[f] = static_cast<ir::FunctionId>(kept.size());
+            kept.push_back(std::move(module.functions[f]));
+        }
+    }
+    for (auto &function : kept) {
+        for (auto &block : function.blocks) {
+            for (auto &instruction : block.instructions) {
+                if (instruction.opcode == ir::Opcode::CALL) {
+                    instruction.callee = ids[instruction.callee];
+                }
+            }
+        }
+    }
+
+    module.functions = std::move(kept);
+    _compact(module.functions, module.strings, ir::Operand::STRING);
+    _compact(module.functions, module.globals, ir::Operand::GLOBAL);
+}
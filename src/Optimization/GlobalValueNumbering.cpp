@@ -0,0 +1,152 @@
+#include <CPlus/Optimization/GlobalValueNumbering.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+/**
+ * public
+ */
+
+cplus::opt::PassResult cplus::opt::GlobalValueNumbering::run(ir::Function &function, const ir::FunctionId id, AnalysisManager &analyses)
+{
+    const u64 removed = _number(function, analyses.dominators(id), analyses.call_graph());
+    u32 preserved = ANALYSIS_CONTROL_FLOW | ANALYSIS_CALL_GRAPH;
+
+    _leaders.clear();
+    if (removed == 0) {
+        return {};
+    }
+
+    /** @brief a removed call may have been the last one to its callee */
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            if (instruction.opcode == ir::Opcode::CALL && _numbers[instruction.result] != instruction.result) {
+                preserved &= ~ANALYSIS_CALL_GRAPH;
+            }
+        }
+    }
+    _replace(function);
+    return {.changes = removed, .preserved = preserved};
+}
+
+/**
+ * helpers
+ */
+
+static inline bool _is_commutative(const cplus::ir::Opcode opcode)
+{
+    return opcode == cplus::ir::Opcode::ADD || opcode == cplus::ir::Opcode::MUL || opcode == cplus::ir::Opcode::AND
+        || opcode == cplus::ir::Opcode::OR || opcode == cplus::ir::Opcode::ICMP_EQ || opcode == cplus::ir::Opcode::ICMP_NE;
+}
+
+/**
+ * private
+ */
+
+bool cplus::opt::GlobalValueNumbering::_is_candidate(const ir::Instruction &instruction, const ir::CallGraph &graph) const
+{
+    if (instruction.result == ir::INVALID_ID) {
+        return false;
+    }
+
+    const ir::Opcode opcode = instruction.opcode;
+
+    /** @brief two calls are redundant when nothing can happen between them that the callee observes or does */
+    if (opcode == ir::Opcode::CALL) {
+        return graph.is_pure(instruction.callee);
+    }
+    return (opcode >= ir::Opcode::ADD && opcode <= ir::Opcode::NEG) || ir::is_compare(opcode) || opcode == ir::Opcode::PHI;
+}
+
+/**
+ * @brief get expression
+ * @details the key two instructions computing the same value share, up to the order of commutative operands
+ */
+cplus::opt::GlobalValueNumbering::Expression cplus::opt::GlobalValueNumbering::_get_expression(const ir::Instruction &instruction,
+    const ir::BlockId block) const
+{
+    ir::Opcode opcode = instruction.opcode;
+    std::vector<ir::Operand> operands;
+    Expression expression;
+
+    operands.reserve(instruction.operands.size());
+    for (const auto &operand : instruction.operands) {
+        operands.push_back(_get_number(operand));
+    }
+
+    if (opcode == ir::Opcode::ICMP_SGT || opcode == ir::Opcode::ICMP_SGE) {
+        opcode = opcode == ir::Opcode::ICMP_SGT ? ir::Opcode::ICMP_SLT : ir::Opcode::ICMP_SLE;
+        std::swap(operands[0], operands[1]);
+    } else if (_is_commutative(opcode)
+        && std::pair(operands[1].kind, operands[1].data) < std::pair(operands[0].kind, operands[0].data)) {
+        std::swap(operands[0], operands[1]);
+    }
+
+    expression.reserve(2 + operands.size() * 2);
+    expression.push_back(static_cast<i64>(opcode));
+    expression.push_back(opcode == ir::Opcode::PHI ? block : instruction.callee);
+    for (const auto &operand : operands) {
+        expression.push_back(operand.kind);
+        expression.push_back(operand.data);
+    }
+    return expression;
+}
+
+cplus::ir::Operand cplus::opt::GlobalValueNumbering::_get_number(const ir::Operand &operand) const
+{
+    return operand.is_value() ? ir::Operand::value(_numbers[operand.id()]) : operand;
+}
+
+/**
+ * @brief number
+ * @details a leader is only reused where its block dominates: the preorder visits it before any block it dominates,
+ * and a leader of the same block comes earlier in it. a phi operand flowing in from a back edge is not numbered yet
+ * and keeps its own value, which can only miss a redundancy
+ */
+cplus::u64 cplus::opt::GlobalValueNumbering::_number(const ir::Function &function, const ir::DominatorTree &dominators,
+    const ir::CallGraph &graph)
+{
+    u64 removed = 0;
+
+    _numbers.resize(function.values);
+    std::iota(_numbers.begin(), _numbers.end(), 0);
+    _leaders.clear();
+
+    for (const ir::BlockId block : dominators.pre_order()) {
+        for (const auto &instruction : function.blocks[block].instructions) {
+            if (!_is_candidate(instruction, graph)) {
+                continue;
+            }
+
+            auto &leaders = _leaders[_get_expression(instruction, block)];
+            const auto leader =
+                std::ranges::find_if(leaders, [&](const Leader &candidate) { return dominators.dominates(candidate.block, block); });
+
+            if (leader == leaders.end()) {
+                leaders.push_back({.value = instruction.result, .block = block});
+                continue;
+            }
+            _numbers[instruction.result] = leader->value;
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+/**
+ * @brief replace
+ * @details every use of a redundant value is dominated by its definition, hence by its leader
+ */
+void cplus::opt::GlobalValueNumbering::_replace(ir::Function &function) const
+{
+    for (auto &block : function.blocks) {
+        std::erase_if(block.instructions, [&](const ir::Instruction &instruction) {
+            return instruction.result != ir::INVALID_ID && _numbers[instruction.result] != instruction.result;
+        });
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                operand = _get_number(operand);
+            }
+        }
+    }
+}
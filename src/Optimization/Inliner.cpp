@@ -0,0 +1,294 @@
+#include <CPlus/Optimization/Inliner.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+/**
+ * public
+ */
+
+cplus::opt::Inliner::Inliner(const OptLevel level)
+{
+    if (level == OPT_O3) {
+        _threshold = AGGRESSIVE_INLINE_THRESHOLD;
+    } else if (level == OPT_OS) {
+        _threshold = 0;
+        _single_call_site_bonus = 0;
+    }
+}
+
+cplus::opt::PassResult cplus::opt::Inliner::run(ir::Module &module, AnalysisManager &analyses)
+{
+    u64 inlined = 0;
+
+    _module = &module;
+    _analyses = &analyses;
+    _analyze();
+
+    for (const ir::FunctionId function : _order) {
+        const u64 count = _inline_calls(function);
+
+        if (count != 0) {
+            _analyses->invalidate(function, ANALYSIS_NONE);
+            inlined += count;
+        }
+    }
+
+    _module = nullptr;
+    _analyses = nullptr;
+    return {.changes = inlined, .preserved = ANALYSIS_ALL & ~ANALYSIS_CALL_GRAPH};
+}
+
+/**
+ * helpers
+ */
+
+/** @brief an operand of the callee, seen from the caller */
+static cplus::ir::Operand _remap(const cplus::ir::Operand &operand, const std::vector<cplus::ir::Operand> &values, const cplus::ir::BlockId first)
+{
+    switch (operand.kind) {
+        case cplus::ir::Operand::VALUE:
+            return values[operand.id()];
+        case cplus::ir::Operand::BLOCK:
+            return cplus::ir::Operand::block(first + operand.id());
+        default:
+            return operand;
+    }
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief analyze
+ * @details copies what the cost model needs from the call graph: inlining changes the calls of the module,
+ * so the cached graph does not outlive the pass
+ */
+void cplus::opt::Inliner::_analyze()
+{
+    const ir::CallGraph &graph = _analyses->call_graph();
+    const u64 count = _module->functions.size();
+
+    _recursive.assign(count, false);
+    _call_sites.assign(count, 0);
+    _sizes.assign(count, 0);
+    _order = graph.bottom_up();
+
+    for (ir::FunctionId f = 0; f < count; ++f) {
+        _recursive[f] = graph.is_recursive(f);
+        _call_sites[f] = graph.call_sites(f);
+        _sizes[f] = _size(_module->functions[f]);
+    }
+}
+
+/**
+ * @brief inline calls
+ * @details walks the caller once, a call that gets inlined resumes the walk at its continuation block:
+ * the inlined body was already processed when its function was
+ */
+cplus::u64 cplus::opt::Inliner::_inline_calls(const ir::FunctionId caller)
+{
+    ir::Function &function = _module->functions[caller];
+    std::vector<u32> depths = _loop_depths(caller);
+    u64 inlined = 0;
+
+    for (ir::BlockId b = 0; b < function.blocks.size(); ++b) {
+        for (u64 i = 0; i < function.blocks[b].instructions.size(); ++i) {
+            const ir::Instruction &instruction = function.blocks[b].instructions[i];
+
+            if (instruction.opcode != ir::Opcode::CALL || !_can_inline(caller, instruction.callee)
+                || !_should_inline(caller, instruction, depths[b])) {
+                continue;
+            }
+
+            const ir::FunctionId callee = instruction.callee;
+            const u32 blocks = static_cast<u32>(_module->functions[callee].blocks.size());
+
+            _inline(caller, b, i);
+            _sizes[caller] += _sizes[callee];
+            depths.insert(depths.begin() + b + 1, blocks + 1, depths[b]);
+            ++inlined;
+
+            b += blocks;//<< next iteration is the continuation
+            break;
+        }
+    }
+    return inlined;
+}
+
+/**
+ * @brief can inline
+ * @details legality only: recursion, @inline(never), and no phi in the callee entry block (it becomes a block entered
+ * from the caller only)
+ */
+bool cplus::opt::Inliner::_can_inline(const ir::FunctionId caller, const ir::FunctionId callee) const
+{
+    const ir::Function &function = _module->functions[callee];
+
+    if (callee == caller || _recursive[callee] || function.inline_hint == ir::Function::Inline::NEVER || function.blocks.empty()) {
+        return false;
+    }
+    return std::none_of(function.blocks[0].instructions.begin(), function.blocks[0].instructions.end(),
+        [](const ir::Instruction &instruction) { return instruction.opcode == ir::Opcode::PHI; });
+}
+
+/**
+ * @brief should inline
+ * @details cost = callee size - removed call sequence (argument moves, call, result move),
+ * threshold = level threshold x (1 + loop depth), plus a bonus for the only call site of the callee
+ */
+bool cplus::opt::Inliner::_should_inline(const ir::FunctionId caller, const ir::Instruction &call, const u32 loop_depth) const
+{
+    if (_module->functions[call.callee].inline_hint == ir::Function::Inline::ALWAYS) {
+        return true;
+    }
+    if (_sizes[caller] >= MAX_CALLER_SIZE) {
+        return false;
+    }
+
+    const u32 saved = static_cast<u32>(call.operands.size()) + 2;
+    const u32 cost = _sizes[call.callee] > saved ? _sizes[call.callee] - saved : 0;
+    u32 threshold = _threshold * (1 + std::min(loop_depth, MAX_LOOP_DEPTH));
+
+    if (_call_sites[call.callee] == 1) {
+        threshold += _single_call_site_bonus;
+    }
+    return cost <= threshold;
+}
+
+/**
+ * @brief inline
+ * @details splices the callee into `block` at the call `index`:
+ *
+ * [block: ..., call] [callee blocks, renamed] [inline.cont: rest of block] [following blocks]
+ *
+ * a single `ret` becomes a `mov` of the call result, several become a phi of their values in the continuation
+ */
+void cplus::opt::Inliner::_inline(const ir::FunctionId caller, const ir::BlockId block, const u64 index)
+{
+    ir::Function &function = _module->functions[caller];
+    const ir::Instruction call = std::move(function.blocks[block].instructions[index]);
+    const ir::Function &callee = _module->functions[call.callee];
+    const ir::BlockId first = block + 1;
+    const ir::BlockId continuation = first + static_cast<ir::BlockId>(callee.blocks.size());
+    std::vector<ir::Operand> values(callee.values);
+    std::vector<ir::BasicBlock> body;
+    ir::Instruction returned{.opcode = ir::Opcode::PHI, .result = call.result, .operands = {}};
+    u32 returns = 0;
+
+    /** @brief make room for the callee blocks and the continuation */
+    for (auto &b : function.blocks) {
+        for (auto &instruction : b.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.kind == ir::Operand::BLOCK && operand.id() > block) {
+                    operand.data += static_cast<i64>(callee.blocks.size()) + 1;
+                }
+            }
+        }
+    }
+
+    /** @brief arguments replace the `arg` values, every other callee value gets a fresh caller value */
+    for (const auto &b : callee.blocks) {
+        for (const auto &instruction : b.instructions) {
+            if (instruction.opcode == ir::Opcode::ARG) {
+                values[instruction.result] = call.operands[static_cast<u64>(instruction.operands[0].data)];
+            } else if (instruction.result != ir::INVALID_ID) {
+                values[instruction.result] = ir::Operand::value(function.new_value());
+            }
+        }
+    }
+
+    for (const auto &b : callee.blocks) {
+        returns += !b.instructions.empty() && b.instructions.back().opcode == ir::Opcode::RET;
+    }
+
+    body.reserve(callee.blocks.size() + 1);
+    for (const auto &b : callee.blocks) {
+        auto &copy = body.emplace_back(ir::BasicBlock{.name = b.name, .label = _module->labels++, .instructions = {}});
+
+        copy.instructions.reserve(b.instructions.size() + 1);
+        for (const auto &instruction : b.instructions) {
+            if (instruction.opcode == ir::Opcode::ARG) {
+                continue;
+            }
+            if (instruction.opcode == ir::Opcode::RET) {
+                const ir::Operand value =
+                    instruction.operands.empty() ? ir::Operand::immediate(0) : _remap(instruction.operands[0], values, first);
+
+                if (returns > 1) {
+                    returned.operands.push_back(value);
+                    returned.operands.push_back(ir::Operand::block(first + static_cast<ir::BlockId>(body.size()) - 1));
+                } else if (instruction.operands.empty()) {
+                    copy.instructions.push_back({.opcode = ir::Opcode::UNDEF, .result = call.result, .operands = {}});
+                } else {
+                    copy.instructions.push_back({.opcode = ir::Opcode::MOV, .result = call.result, .operands = {value}});
+                }
+                copy.instructions.push_back({.opcode = ir::Opcode::JMP, .operands = {ir::Operand::block(continuation)}});
+                continue;
+            }
+
+            ir::Instruction &clone = copy.instructions.emplace_back(instruction);
+
+            if (clone.result != ir::INVALID_ID) {
+                clone.result = values[clone.result].id();
+            }
+            for (auto &operand : clone.operands) {
+                operand = _remap(operand, values, first);
+            }
+        }
+    }
+
+    /** @brief split: the caller block jumps into the callee, its tail moves to the continuation */
+    auto &instructions = function.blocks[block].instructions;
+    auto &tail = body.emplace_back(ir::BasicBlock{.name = "inline.cont", .label = _module->labels++, .instructions = {}});
+
+    if (returns > 1) {
+        tail.instructions.push_back(std::move(returned));
+    }
+    tail.instructions.insert(tail.instructions.end(), std::make_move_iterator(instructions.begin() + static_cast<i64>(index) + 1),
+        std::make_move_iterator(instructions.end()));
+    instructions.erase(instructions.begin() + static_cast<i64>(index), instructions.end());
+    instructions.push_back({.opcode = ir::Opcode::JMP, .operands = {ir::Operand::block(first)}});
+
+    function.blocks.insert(function.blocks.begin() + first, std::make_move_iterator(body.begin()), std::make_move_iterator(body.end()));
+
+    /** @brief the successors of the tail are now entered from the continuation */
+    for (const ir::BlockId successor : ir::successors(function.blocks[continuation])) {
+        for (auto &instruction : function.blocks[successor].instructions) {
+            if (instruction.opcode != ir::Opcode::PHI) {
+                continue;
+            }
+            for (u64 i = 1; i < instruction.operands.size(); i += 2) {
+                if (instruction.operands[i].id() == block) {
+                    instruction.operands[i] = ir::Operand::block(continuation);
+                }
+            }
+        }
+    }
+}
+
+/** @brief instruction count, `arg` excluded since inlining removes it */
+cplus::u32 cplus::opt::Inliner::_size(const ir::Function &function)
+{
+    u32 size = 0;
+
+    for (const auto &block : function.blocks) {
+        for (const auto &instruction : block.instructions) {
+            size += instruction.opcode != ir::Opcode::ARG;
+        }
+    }
+    return size;
+}
+
+/** @brief loop nesting depth of each block, the static frequency estimate of its call sites */
+std::vector<cplus::u32> cplus::opt::Inliner::_loop_depths(const ir::FunctionId function)
+{
+    const ir::LoopInfo &loops = _analyses->loops(function);
+    std::vector<u32> depths(_module->functions[function].blocks.size(), 0);
+
+    for (ir::BlockId b = 0; b < depths.size(); ++b) {
+        depths[b] = loops.depth(b);
+    }
+    return depths;
+}
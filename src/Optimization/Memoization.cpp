@@ -0,0 +1,216 @@
+#include <CPlus/Logger.hpp>
+#include <CPlus/Optimization/Memoization.hpp>
+
+/**
+ * public
+ */
+
+cplus::opt::Memoization::Memoization(const bool automatic) : _automatic(automatic)
+{
+    /* __ctor__ */
+}
+
+cplus::opt::PassResult cplus::opt::Memoization::run(ir::Module &module, AnalysisManager &analyses)
+{
+    const ir::CallGraph &graph = analyses.call_graph();
+    std::vector<ir::FunctionId> memoized;
+
+    _module = &module;
+    for (ir::FunctionId f = 0; f < module.functions.size(); ++f) {
+        if (_should_memoize(f, graph)) {
+            memoized.push_back(f);
+        }
+    }
+
+    /** @brief the call graph reference dies with the first invalidation */
+    for (const ir::FunctionId f : memoized) {
+        _memoize(f);
+        analyses.invalidate(f, ANALYSIS_CALL_GRAPH);
+    }
+
+    _module = nullptr;
+    return {.changes = memoized.size(), .preserved = ANALYSIS_ALL};
+}
+
+/**
+ * helpers
+ */
+
+/** @brief appends `%d = opcode operands...` to a block and returns %d */
+static cplus::ir::Operand _append(cplus::ir::Function &function, cplus::ir::BasicBlock &block, const cplus::ir::Opcode opcode,
+    std::vector<cplus::ir::Operand> operands)
+{
+    const cplus::ir::ValueId result = function.new_value();
+
+    block.instructions.push_back({.opcode = opcode, .result = result, .operands = std::move(operands)});
+    return cplus::ir::Operand::value(result);
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief should memoize
+ * @details an explicit @memoize that cannot be honored is reported and ignored
+ */
+bool cplus::opt::Memoization::_should_memoize(const ir::FunctionId function, const ir::CallGraph &graph) const
+{
+    const ir::Function &f = _module->functions[function];
+    const u8 effects = graph.effects(function);
+    cstr reason = nullptr;
+
+    if (!f.memoize && !_automatic) {
+        return false;
+    }
+
+    if (effects & ir::EFFECT_WRITES_MEMORY) {
+        reason = "it writes memory";
+    } else if (effects & ir::EFFECT_READS_MEMORY) {
+        reason = "its result may depend on memory";
+    } else if (!graph.is_pure(function)) {
+        reason = "it is not pure";
+    } else if (f.return_type == ast::Type::VOID) {
+        reason = "it returns nothing";
+    } else if (f.parameters == 0 || f.parameters > MAX_PARAMETERS) {
+        reason = "it must have 1 to 3 parameters";
+    } else if (f.blocks.empty() || f.blocks[0].instructions.empty() || f.blocks[0].instructions[0].opcode == ir::Opcode::PHI) {
+        reason = "its entry block is a join";
+    }
+
+    if (reason) {
+        if (f.memoize) {
+            logger::info("Function ", f.name, " is not memoized: ", reason);
+        }
+        return false;
+    }
+    if (f.memoize) {
+        return true;
+    }
+    if (!(effects & ir::EFFECT_MAY_RECURSE)) {
+        return false;
+    }
+
+    u32 self_calls = 0;
+
+    for (const auto &block : f.blocks) {
+        for (const auto &instruction : block.instructions) {
+            self_calls += instruction.opcode == ir::Opcode::CALL && instruction.callee == function;
+        }
+    }
+    return self_calls >= MIN_SELF_CALLS;
+}
+
+/**
+ * @brief memoize
+ * @details the arguments move to a new entry block, followed by the hit block and the old body:
+ *
+ * [memo.entry: args, index, load valid] [memo.hit: load value, ret] [body..., store value and valid before each ret]
+ *
+ * index = in ? a0 * range^(n-1) + ... + an-1 : range^n, where in is 1 when every argument is in [0, range),
+ * computed without a branch as in * linear + (1 - in) * range^n. the spare entry is stored with valid = in = 0
+ */
+void cplus::opt::Memoization::_memoize(const ir::FunctionId function)
+{
+    ir::Function &f = _module->functions[function];
+    const u32 range = _range(f.parameters);
+    u32 entries = 1;
+
+    for (u32 p = 0; p < f.parameters; ++p) {
+        entries *= range;
+    }
+
+    const ir::Operand valid = ir::Operand::global(static_cast<u32>(_module->globals.size()));
+    const ir::Operand value = ir::Operand::global(static_cast<u32>(_module->globals.size() + 1));
+
+    _module->globals.push_back({.name = "memo." + f.name + ".valid", .size = entries + 1, .cache = true});
+    _module->globals.push_back({.name = "memo." + f.name + ".value", .size = entries + 1, .cache = true});
+
+    for (auto &block : f.blocks) {
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.kind == ir::Operand::BLOCK) {
+                    operand.data += 2;
+                }
+            }
+        }
+    }
+
+    ir::BasicBlock entry{.name = "memo.entry", .label = _module->labels++, .instructions = {}};
+    ir::BasicBlock hit{.name = "memo.hit", .label = _module->labels++, .instructions = {}};
+    std::vector<ir::Operand> arguments(f.parameters, ir::Operand::immediate(0));
+    auto &body = f.blocks[0].instructions;
+
+    /** @brief the `arg` values are defined first, a parameter the body never reads gets one */
+    for (auto it = body.begin(); it != body.end();) {
+        if (it->opcode != ir::Opcode::ARG) {
+            ++it;
+            continue;
+        }
+        arguments[static_cast<u64>(it->operands[0].data)] = ir::Operand::value(it->result);
+        entry.instructions.push_back(std::move(*it));
+        it = body.erase(it);
+    }
+    for (u32 p = 0; p < f.parameters; ++p) {
+        if (!arguments[p].is_value()) {
+            arguments[p] = _append(f, entry, ir::Opcode::ARG, {ir::Operand::immediate(p)});
+        }
+    }
+
+    ir::Operand in = ir::Operand::immediate(1);
+    ir::Operand linear = ir::Operand::immediate(0);
+
+    for (const ir::Operand &argument : arguments) {
+        const ir::Operand low = _append(f, entry, ir::Opcode::ICMP_SGE, {argument, ir::Operand::immediate(0)});
+        const ir::Operand high = _append(f, entry, ir::Opcode::ICMP_SLT, {argument, ir::Operand::immediate(range)});
+        const ir::Operand bounded = _append(f, entry, ir::Opcode::AND, {low, high});
+
+        in = in.is_immediate() ? bounded : _append(f, entry, ir::Opcode::AND, {in, bounded});
+        linear = linear.is_immediate() ? argument
+                                       : _append(f, entry, ir::Opcode::ADD,
+                                             {_append(f, entry, ir::Opcode::MUL, {linear, ir::Operand::immediate(range)}), argument});
+    }
+
+    const ir::Operand out = _append(f, entry, ir::Opcode::SUB, {ir::Operand::immediate(1), in});
+    const ir::Operand index = _append(f, entry, ir::Opcode::ADD,
+        {_append(f, entry, ir::Opcode::MUL, {in, linear}), _append(f, entry, ir::Opcode::MUL, {out, ir::Operand::immediate(entries)})});
+
+    entry.instructions.push_back({.opcode = ir::Opcode::BR,
+        .operands = {_append(f, entry, ir::Opcode::LOAD, {valid, index}), ir::Operand::block(1), ir::Operand::block(2)}});
+    hit.instructions.push_back({.opcode = ir::Opcode::RET, .operands = {_append(f, hit, ir::Opcode::LOAD, {value, index})}});
+
+    for (auto &block : f.blocks) {
+        auto &instructions = block.instructions;
+
+        if (instructions.empty() || instructions.back().opcode != ir::Opcode::RET || instructions.back().operands.empty()) {
+            continue;
+        }
+
+        const ir::Operand returned = instructions.back().operands[0];
+
+        instructions.insert(instructions.end() - 1, {.opcode = ir::Opcode::STORE, .operands = {value, index, returned}});
+        instructions.insert(instructions.end() - 1, {.opcode = ir::Opcode::STORE, .operands = {valid, index, in}});
+    }
+
+    f.blocks[0].name = "memo.body";
+    f.blocks.insert(f.blocks.begin(), std::move(hit));
+    f.blocks.insert(f.blocks.begin(), std::move(entry));
+}
+
+/** @brief largest range such that range^parameters fits TABLE_ENTRIES */
+cplus::u32 cplus::opt::Memoization::_range(const u32 parameters)
+{
+    u32 range = 1;
+
+    for (;;) {
+        u64 entries = 1;
+
+        for (u32 p = 0; p < parameters; ++p) {
+            entries *= range + 1;
+        }
+        if (entries > TABLE_ENTRIES) {
+            return range;
+        }
+        ++range;
+    }
+}
@@ -0,0 +1,89 @@
+#include <CPlus/Logger.hpp>
+#include <CPlus/Optimization/ConstantEvaluation.hpp>
+#include <CPlus/Optimization/ConstantPropagation.hpp>
+#include <CPlus/Optimization/CopyPropagation.hpp>
+#include <CPlus/Optimization/DeadFunctionElimination.hpp>
+#include <CPlus/Optimization/GlobalValueNumbering.hpp>
+#include <CPlus/Optimization/Inliner.hpp>
+#include <CPlus/Optimization/Memoization.hpp>
+#include <CPlus/Optimization/Optimizer.hpp>
+#include <CPlus/Optimization/TailRecursion.hpp>
+
+/**
+ * public
+ */
+
+cplus::opt::Optimizer::Optimizer(const OptLevel level)
+{
+    _build(level);
+}
+
+cplus::ir::Module cplus::opt::Optimizer::run(const ir::Module &input)
+{
+    return run(ir::Module(input));
+}
+
+/** @brief not part of CompilerPass: the pipeline calls it through Optimizer, the passes rewrite the module in place */
+cplus::ir::Module cplus::opt::Optimizer::run(ir::Module &&module)
+{
+    if (_passes.empty()) {
+        return std::move(module);
+    }
+
+    logger::info("Optimizing module " + module.name);
+
+    AnalysisManager analyses(module);
+    const u64 changes = _passes.run(module, analyses);
+
+    if (changes != 0 && (cplus_flags & FLAG_SHOW_IR)) {
+        const ir::CallGraph &graph = analyses.call_graph();
+        std::vector<std::string> effects;
+
+        for (ir::FunctionId f = 0; f < graph.size(); ++f) {
+            effects.push_back(ir::describe_effects(graph.effects(f)));
+        }
+        ir::dump(module, *logger::sink, effects);
+    }
+
+    return module;
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief build
+ * @details -O0 keeps the IR as generated and -O1 only cleans it up: copy propagation, value numbering, SCCP and dead
+ * functions, none of which grows the code or the memory of the program. the other levels also memoize, evaluate
+ * constant calls and inline first (with their own cost model) so the cleanups see through the calls. memoization
+ * comes first, it needs the recursive calls of a function as written. self tail calls become loops before inlining:
+ * a function left without recursion may then be inlined. constant calls are evaluated before inlining copies them into
+ * their callers, and again once SCCP made more arguments constant, SCCP then runs on the folded results. both
+ * evaluations share the callees given up, a call too long to evaluate is not interpreted twice. copies are
+ * propagated first so value numbering and SCCP read the values and not their temps, redundancies are removed before
+ * SCCP so it evaluates each value once. functions are only known dead once every call was inlined or evaluated
+ */
+void cplus::opt::Optimizer::_build(const OptLevel level)
+{
+    if (level == OPT_O0) {
+        return;
+    }
+
+    const auto given_up = std::make_shared<std::unordered_set<std::string>>();
+
+    if (level != OPT_O1) {
+        _passes.add(std::make_unique<Memoization>(cplus_flags & FLAG_AUTO_MEMOIZE));
+        _passes.add(std::make_unique<TailRecursion>());
+        _passes.add(std::make_unique<ConstantEvaluation>(given_up));
+        _passes.add(std::make_unique<Inliner>(level));
+    }
+    _passes.add(std::make_unique<CopyPropagation>());
+    _passes.add(std::make_unique<GlobalValueNumbering>());
+    _passes.add(std::make_unique<ConstantPropagation>());
+    if (level != OPT_O1) {
+        _passes.add(std::make_unique<ConstantEvaluation>(given_up));
+        _passes.add(std::make_unique<ConstantPropagation>());
+    }
+    _passes.add(std::make_unique<DeadFunctionElimination>());
+}
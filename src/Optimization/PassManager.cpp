@@ -0,0 +1,58 @@
+#include <CPlus/Logger.hpp>
+#include <CPlus/Optimization/PassManager.hpp>
+
+/**
+ * public
+ */
+
+void cplus::opt::PassManager::add(std::unique_ptr<ModulePass> pass)
+{
+    _passes.push_back(std::move(pass));
+}
+
+void cplus::opt::PassManager::add(std::unique_ptr<FunctionPass> pass)
+{
+    _passes.push_back(std::make_unique<FunctionPassAdaptor>(std::move(pass)));
+}
+
+cplus::u64 cplus::opt::PassManager::run(ir::Module &module, AnalysisManager &analyses)
+{
+    u64 changes = 0;
+
+    for (const auto &pass : _passes) {
+        const PassResult result = pass->run(module, analyses);
+
+        if (result.changes == 0) {
+            continue;
+        }
+
+        logger::info("Pass ", pass->name(), ": ", result.changes, " changes in module " + module.name);
+        analyses.invalidate(result.preserved);
+        changes += result.changes;
+    }
+    return changes;
+}
+
+/**
+ * FunctionPassAdaptor
+ */
+
+cplus::opt::PassManager::FunctionPassAdaptor::FunctionPassAdaptor(std::unique_ptr<FunctionPass> pass) : _pass(std::move(pass))
+{
+    /* __ctor__ */
+}
+
+cplus::opt::PassResult cplus::opt::PassManager::FunctionPassAdaptor::run(ir::Module &module, AnalysisManager &analyses)
+{
+    u64 changes = 0;
+
+    for (ir::FunctionId f = 0; f < module.functions.size(); ++f) {
+        const PassResult result = _pass->run(module.functions[f], f, analyses);
+
+        if (result.changes != 0) {
+            analyses.invalidate(f, result.preserved);
+            changes += result.changes;
+        }
+    }
+    return {.changes = changes, .preserved = ANALYSIS_ALL};
+}
@@ -0,0 +1,200 @@
+#include <CPlus/Optimization/TailRecursion.hpp>
+
+#include <iterator>
+
+/**
+ * public
+ */
+
+cplus::opt::PassResult cplus::opt::TailRecursion::run(ir::Function &function, const ir::FunctionId id,
+    [[maybe_unused]] AnalysisManager &analyses)
+{
+    std::optional<ir::Opcode> accumulator;
+    const std::vector<TailSite> sites = _find_sites(function, id, accumulator);
+
+    if (sites.empty()) {
+        return {};
+    }
+    _eliminate(function, sites, accumulator);
+    return {.changes = sites.size(), .preserved = ANALYSIS_NONE};
+}
+
+/**
+ * helpers
+ */
+
+static inline bool _is_self_call(const cplus::ir::Instruction &instruction, const cplus::ir::FunctionId id, const cplus::u32 parameters)
+{
+    return instruction.opcode == cplus::ir::Opcode::CALL && instruction.callee == id && instruction.operands.size() == parameters;
+}
+
+static inline bool _is_accumulator(const cplus::ir::Opcode opcode)
+{
+    return opcode == cplus::ir::Opcode::ADD || opcode == cplus::ir::Opcode::MUL || opcode == cplus::ir::Opcode::AND
+        || opcode == cplus::ir::Opcode::OR;
+}
+
+/** @brief the value the accumulator starts with, `op identity, x` is x */
+static constexpr cplus::i64 _identity(const cplus::ir::Opcode opcode)
+{
+    switch (opcode) {
+        case cplus::ir::Opcode::MUL:
+            return 1;
+        case cplus::ir::Opcode::AND:
+            return -1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * private
+ */
+
+/**
+ * @brief find sites
+ * @details the call result of a site is only read by the instructions that follow it in its block, which ends in the
+ * `ret`: nothing else uses it once the site is rewritten. the first accumulating site fixes the op of the function
+ */
+std::vector<cplus::opt::TailRecursion::TailSite> cplus::opt::TailRecursion::_find_sites(const ir::Function &function,
+    const ir::FunctionId id, std::optional<ir::Opcode> &accumulator)
+{
+    std::vector<TailSite> sites;
+
+    if (function.blocks.empty()) {
+        return sites;
+    }
+    for (const auto &instruction : function.blocks[0].instructions) {
+        if (instruction.opcode == ir::Opcode::PHI) {
+            return sites;
+        }
+    }
+
+    for (ir::BlockId b = 0; b < function.blocks.size(); ++b) {
+        const auto &instructions = function.blocks[b].instructions;
+        const u64 n = instructions.size();
+
+        if (n < 2 || instructions[n - 1].opcode != ir::Opcode::RET) {
+            continue;
+        }
+
+        const ir::Instruction &ret = instructions[n - 1];
+        const ir::Instruction &last = instructions[n - 2];
+
+        if (_is_self_call(last, id, function.parameters)
+            && (ret.operands.empty() || ret.operands[0] == ir::Operand::value(last.result))) {
+            sites.push_back({.block = b, .call = n - 2, .accumulates = false, .operand = {}});
+            continue;
+        }
+        if (n < 3 || ret.operands.empty() || !_is_accumulator(last.opcode) || ret.operands[0] != ir::Operand::value(last.result)) {
+            continue;
+        }
+
+        const ir::Instruction &call = instructions[n - 3];
+        const ir::Operand result = ir::Operand::value(call.result);
+
+        if (!_is_self_call(call, id, function.parameters) || (last.operands[0] == result) == (last.operands[1] == result)
+            || (accumulator && *accumulator != last.opcode)) {
+            continue;
+        }
+        accumulator = last.opcode;
+        sites.push_back({.block = b, .call = n - 3, .accumulates = true,
+            .operand = last.operands[0] == result ? last.operands[1] : last.operands[0]});
+    }
+    return sites;
+}
+
+/**
+ * @brief eliminate
+ * @details builds the loop, the new entry block is inserted last so the sites keep their block index until then:
+ *
+ * [tailrec.entry: args, jmp] [tailrec.loop: phis, old entry] [blocks..., tail sites jumping to tailrec.loop]
+ *
+ * the entry reuses the label of the old entry, whose label hint changes: both stay unique in the module
+ */
+void cplus::opt::TailRecursion::_eliminate(ir::Function &function, const std::vector<TailSite> &sites,
+    const std::optional<ir::Opcode> accumulator)
+{
+    ir::BasicBlock entry{.name = "tailrec.entry", .label = function.blocks[0].label, .instructions = {}};
+    auto &header = function.blocks[0].instructions;
+    std::vector<ir::Instruction> phis;
+    std::vector<u64> parameters;//<< per phi, the parameter it merges
+    ir::ValueId acc = ir::INVALID_ID;
+
+    for (auto &block : function.blocks) {
+        for (auto &instruction : block.instructions) {
+            for (auto &operand : instruction.operands) {
+                if (operand.kind == ir::Operand::BLOCK) {
+                    ++operand.data;
+                }
+            }
+        }
+    }
+
+    /** @brief the `arg` values become the parameter phis, the arguments get fresh values in the entry */
+    for (auto it = header.begin(); it != header.end();) {
+        if (it->opcode != ir::Opcode::ARG) {
+            ++it;
+            continue;
+        }
+
+        const ir::ValueId arg = function.new_value();
+
+        phis.push_back({.opcode = ir::Opcode::PHI, .result = it->result, .operands = {ir::Operand::value(arg), ir::Operand::block(0)}});
+        parameters.push_back(static_cast<u64>(it->operands[0].data));
+        it->result = arg;
+        entry.instructions.push_back(std::move(*it));
+        it = header.erase(it);
+    }
+    if (accumulator) {
+        acc = function.new_value();
+        phis.push_back({.opcode = ir::Opcode::PHI, .result = acc,
+            .operands = {ir::Operand::immediate(_identity(*accumulator)), ir::Operand::block(0)}});
+    }
+
+    for (const TailSite &site : sites) {
+        auto &instructions = function.blocks[site.block].instructions;
+        const ir::Instruction call = std::move(instructions[site.call]);
+        ir::Operand next = ir::Operand::value(acc);
+
+        instructions.erase(instructions.begin() + static_cast<i64>(site.call), instructions.end());
+        if (site.accumulates) {
+            next = ir::Operand::value(function.new_value());
+            instructions.push_back({.opcode = *accumulator, .result = next.id(), .operands = {ir::Operand::value(acc), site.operand}});
+        }
+        for (u64 p = 0; p < phis.size(); ++p) {
+            phis[p].operands.push_back(p < parameters.size() ? call.operands[parameters[p]] : next);
+            phis[p].operands.push_back(ir::Operand::block(site.block + 1));
+        }
+        instructions.push_back({.opcode = ir::Opcode::JMP, .operands = {ir::Operand::block(1)}});
+    }
+
+    /** @brief the remaining returns end the recursion, they apply what was accumulated */
+    if (accumulator) {
+        for (auto &block : function.blocks) {
+            auto &instructions = block.instructions;
+
+            if (instructions.empty() || instructions.back().opcode != ir::Opcode::RET || instructions.back().operands.empty()) {
+                continue;
+            }
+
+            const ir::Operand returned = instructions.back().operands[0];
+
+            if (returned == ir::Operand::immediate(_identity(*accumulator))) {
+                instructions.back().operands[0] = ir::Operand::value(acc);
+                continue;
+            }
+
+            const ir::ValueId value = function.new_value();
+
+            instructions.back().operands[0] = ir::Operand::value(value);
+            instructions.insert(instructions.end() - 1,
+                {.opcode = *accumulator, .result = value, .operands = {ir::Operand::value(acc), returned}});
+        }
+    }
+
+    header.insert(header.begin(), std::make_move_iterator(phis.begin()), std::make_move_iterator(phis.end()));
+    function.blocks[0].name = "tailrec.loop";
+    entry.instructions.push_back({.opcode = ir::Opcode::JMP, .operands = {ir::Operand::block(1)}});
+    function.blocks.insert(function.blocks.begin(), std::move(entry));
+}
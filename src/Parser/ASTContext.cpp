@@ -0,0 +1,15 @@
+#include <CPlus/Parser/ASTContext.hpp>
+
+/**
+ * public
+ */
+
+cplus::ast::ASTContext::ASTContext() : _arena(INITIAL_BLOCK_SIZE)
+{
+    /* __ctor__ */
+}
+
+cplus::ast::ASTContext::allocator_type cplus::ast::ASTContext::allocator()
+{
+    return allocator_type(&_arena);
+}
@@ -14,8 +14,8 @@ std::unique_ptr<cplus::ast::Module> cplus::ast::AbstractSyntaxTree::run(const st
     auto module = _parse_module();
 
     if (cplus_flags & FLAG_SHOW_AST) {
-        ASTLogger logger;
-        logger.show(*module);
+        ASTLogger ast_logger(*logger::sink);
+        ast_logger.show(*module);
     }
 
     return module;
@@ -109,6 +109,7 @@ void cplus::ast::AbstractSyntaxTree::_synchronize()
             case lx::TokenKind::TOKEN_IF:
             case lx::TokenKind::TOKEN_FOR:
             case lx::TokenKind::TOKEN_FOREACH:
+            case lx::TokenKind::TOKEN_WHILE:
             case lx::TokenKind::TOKEN_CASE:
             case lx::TokenKind::TOKEN_RETURN:
                 return;
@@ -124,11 +125,12 @@ void cplus::ast::AbstractSyntaxTree::_synchronize()
 
 std::unique_ptr<cplus::ast::Module> cplus::ast::AbstractSyntaxTree::_parse_module()
 {
-    auto module = make<Module>();
+    auto module = std::make_unique<Module>();
     const auto module_name = _consume(lx::TokenKind::TOKEN_MODULE, "Lexical error, expected 'module'");
 
     module->name = std::move(module_name.lexeme);
     _module = module->name.c_str();
+    _context = &module->context;
 
     logger::info("Building AST for module: ", _module, "...");
 
@@ -144,8 +146,14 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_declaration()
 {
     try {
 
+        if (_check(lx::TokenKind::TOKEN_AT)) {
+            auto attributes = _parse_attributes();
+
+            _consume(lx::TokenKind::TOKEN_DEF, "Expected 'def' after attributes");
+            return _parse_function_declaration(std::move(attributes));
+        }
         if (_match({lx::TokenKind::TOKEN_DEF})) {
-            return _parse_function_declaration();
+            return _parse_function_declaration(List<Attribute>(_context->allocator()));
         }
         if (_match({lx::TokenKind::TOKEN_CONST})) {
             return _parse_variable_declaration(true, true);
@@ -174,13 +182,14 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_declaration()
 *     return add(5, 10);
 * }
 */
-cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_function_declaration()
+cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_function_declaration(List<Attribute> attributes)
 {
     const auto name = _consume(lx::TokenKind::TOKEN_IDENTIFIER, "Expected function name");
-    auto func = make<FunctionDeclaration>(name.lexeme);
+    auto func = _context->make<FunctionDeclaration>(name.lexeme);
 
     func->line = name.line;
     func->column = name.column;
+    func->attributes = std::move(attributes);
 
     _consume(lx::TokenKind::TOKEN_OPEN_PAREN, "Expected '(' after function name");
 
@@ -208,6 +217,36 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_function_declara
     return func;
 }
 
+/**
+* @brief attributes
+* @syntax @name
+* @syntax @name(argument)
+*
+* @inline(always)
+* def square(x: int) -> int
+* {
+*     return x * x;
+* }
+*
+* @note names and arguments are checked by the semantic analysis
+*/
+cplus::ast::List<cplus::ast::Attribute> cplus::ast::AbstractSyntaxTree::_parse_attributes()
+{
+    List<Attribute> attributes(_context->allocator());
+
+    while (_match({lx::TokenKind::TOKEN_AT})) {
+        const auto name = _consume(lx::TokenKind::TOKEN_IDENTIFIER, "Expected attribute name after '@'");
+        Attribute attribute{.name = name.lexeme, .argument = {}, .line = name.line, .column = name.column};
+
+        if (_match({lx::TokenKind::TOKEN_OPEN_PAREN})) {
+            attribute.argument = _consume(lx::TokenKind::TOKEN_IDENTIFIER, "Expected attribute argument").lexeme;
+            _consume(lx::TokenKind::TOKEN_CLOSE_PAREN, "Expected ')' after attribute argument");
+        }
+        attributes.push_back(attribute);
+    }
+    return attributes;
+}
+
 /**
 * @brief variable declaration
 * @syntax var_name: type;
@@ -223,7 +262,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_function_declara
 cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_variable_declaration(bool is_const, bool expect_semicolon = true)
 {
     const auto name = _consume(lx::TokenKind::TOKEN_IDENTIFIER, "Expected variable name");
-    auto var_decl = make<VariableDeclaration>(name.lexeme, is_const);
+    auto var_decl = _context->make<VariableDeclaration>(name.lexeme, is_const);
 
     var_decl->line = name.line;
     var_decl->column = name.column;
@@ -246,7 +285,7 @@ cplus::ast::TypePtr cplus::ast::AbstractSyntaxTree::_parse_type()
     const auto type_token = _consume(lx::TokenKind::TOKEN_IDENTIFIER, "Expected type name");
     Type::Kind kind = from_string(type_token.lexeme);
 
-    return make<Type>(kind, type_token.lexeme);
+    return _context->make<Type>(kind, type_token.lexeme);
 }
 
 /**
@@ -299,6 +338,9 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_statement()
     if (_match({lx::TokenKind::TOKEN_FOREACH})) {
         return _parse_foreach_statement();
     }
+    if (_match({lx::TokenKind::TOKEN_WHILE})) {
+        return _parse_while_statement();
+    }
     if (_match({lx::TokenKind::TOKEN_CASE})) {
         return _parse_case_statement();
     }
@@ -335,7 +377,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_block_statement(
 {
     _consume(lx::TokenKind::TOKEN_OPEN_BRACE, "Expected '{'");
 
-    auto block = make<BlockStatement>();
+    auto block = _context->make<BlockStatement>();
 
     while (!_check(lx::TokenKind::TOKEN_CLOSE_BRACE) && !_is_at_end()) {
 
@@ -367,7 +409,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_if_statement()
         ;
 
     auto then_stmt = _parse_statement();
-    auto if_stmt = make<IfStatement>(std::move(condition), std::move(then_stmt));
+    auto if_stmt = _context->make<IfStatement>(std::move(condition), std::move(then_stmt));
 
     if (_match({lx::TokenKind::TOKEN_ELSE})) {
         if_stmt->else_statement = _parse_statement();
@@ -393,7 +435,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_if_statement()
 */
 cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_for_statement()
 {
-    auto for_stmt = make<ForStatement>();
+    auto for_stmt = _context->make<ForStatement>();
     const bool has_paren = _match({lx::TokenKind::TOKEN_OPEN_PAREN});
 
     if (!_check(lx::TokenKind::TOKEN_SEMICOLON)) {
@@ -407,11 +449,11 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_for_statement()
                 for_stmt->initializer = _parse_variable_declaration(false, false);
             } else {
                 _current = pos;
-                for_stmt->initializer = make<ExpressionStatement>(_parse_expression());
+                for_stmt->initializer = _context->make<ExpressionStatement>(_parse_expression());
             }
 
         } else {
-            for_stmt->initializer = make<ExpressionStatement>(_parse_expression());
+            for_stmt->initializer = _context->make<ExpressionStatement>(_parse_expression());
         }
     }
 
@@ -436,6 +478,23 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_for_statement()
     return for_stmt;
 }
 
+/**
+* @brief while loop statement
+* @syntax while (condition) { body }
+* @syntax while condition { body }
+*
+* while n > 1 {
+*     n = n / 2;
+* }
+*/
+cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_while_statement()
+{
+    auto condition = _parse_expression();
+    auto body = _parse_statement();
+
+    return _context->make<WhileStatement>(std::move(condition), std::move(body));
+}
+
 /**
 * @brief foreach loop statement
 * @syntax foreach (iterator in iterable) { body }
@@ -466,20 +525,22 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_foreach_statemen
 
     auto body = _parse_statement();
 
-    return make<ForeachStatement>(iterator_token.lexeme, std::move(iterable), std::move(body));
+    return _context->make<ForeachStatement>(iterator_token.lexeme, std::move(iterable), std::move(body));
 }
 
 /**
 * @brief case statement
-* @syntax case (expression) { value1: statements; value2: statements; ... default: statements; }
+* @syntax case (expression) { value1: statements; value2, value3: statements; ... default: statements; }
 *
 * case (x) {
 *   1: print("one");
-*   2: print("two");
+*   2, 3: print("two or three");
+*   LIMIT, (0 - 1): print("bounds");
 *   default: print("other");
 * }
 *
-* like a switch case, this is faster than multiple if-else if statements
+* like a switch case, this is faster than multiple if-else if statements.
+* a value is any expression folding to an integer constant, a clause runs until the next label
 */
 cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_case_statement()
 {
@@ -488,15 +549,18 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_case_statement()
     _consume(lx::TokenKind::TOKEN_CLOSE_PAREN, "Expected ')' after case expression");
     _consume(lx::TokenKind::TOKEN_OPEN_BRACE, "Expected '{' before case clauses");
 
-    auto case_stmt = make<CaseStatement>(std::move(expression));
+    auto case_stmt = _context->make<CaseStatement>(std::move(expression));
 
     while (!_check(lx::TokenKind::TOKEN_CLOSE_BRACE) && !_is_at_end()) {
-        CaseStatement::CaseClause clause;
-        clause.value = _match({lx::TokenKind::TOKEN_DEFAULT}) ? nullptr : _parse_expression();
+        CaseStatement::CaseClause clause(case_stmt->clauses.get_allocator());
+        if (!_match({lx::TokenKind::TOKEN_DEFAULT})) {
+            do {
+                clause.values.push_back(_parse_expression());
+            } while (_match({lx::TokenKind::TOKEN_COMMA}));
+        }
         _consume(lx::TokenKind::TOKEN_COLON, "Expected ':' after case value");
 
-        while (!_check(lx::TokenKind::TOKEN_CLOSE_BRACE) && !_is_at_end()
-            && !(_check(lx::TokenKind::TOKEN_INTEGER) || _check(lx::TokenKind::TOKEN_DEFAULT))) {
+        while (!_check(lx::TokenKind::TOKEN_CLOSE_BRACE) && !_is_at_end() && !_is_case_label()) {
             if (auto stmt = _parse_declaration()) {
                 clause.statements.push_back(std::move(stmt));
             }
@@ -508,6 +572,39 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_case_statement()
     return case_stmt;
 }
 
+/**
+* @brief is case label
+* @details whether the next tokens parse as `value, ...:` or `default:`, the position is restored.
+* `name: type` is a typed declaration (`x: int = 1;`), not the label `name` followed by a statement
+*/
+bool cplus::ast::AbstractSyntaxTree::_is_case_label()
+{
+    const u64 pos = _current;
+    bool label = false;
+
+    if (_check(lx::TokenKind::TOKEN_DEFAULT)) {
+        return true;
+    }
+    if (_check(lx::TokenKind::TOKEN_IDENTIFIER) && _check(lx::TokenKind::TOKEN_COLON, 1) && _check(lx::TokenKind::TOKEN_IDENTIFIER, 2)) {
+        const std::string_view type = _tokens[_current + 2].lexeme;
+
+        if (from_string(type) != Type::AUTO || type == "auto") {
+            return false;
+        }
+    }
+
+    try {
+        do {
+            _parse_expression();
+        } while (_match({lx::TokenKind::TOKEN_COMMA}));
+        label = _check(lx::TokenKind::TOKEN_COLON);
+    } catch (const std::exception &) {
+        label = false;
+    }
+    _current = pos;
+    return label;
+}
+
 /**
 * @brief parse return statement
 * @syntax return expression;
@@ -527,7 +624,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_return_statement
 
     _consume(lx::TokenKind::TOKEN_SEMICOLON, "Expected ';' after return value");
 
-    return make<ReturnStatement>(std::move(value));
+    return _context->make<ReturnStatement>(std::move(value));
 }
 
 cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_expression_statement()
@@ -535,7 +632,7 @@ cplus::ast::StatementPtr cplus::ast::AbstractSyntaxTree::_parse_expression_state
     auto expr = _parse_expression();
     _consume(lx::TokenKind::TOKEN_SEMICOLON, "Expected ';' after expression");
 
-    return make<ExpressionStatement>(std::move(expr));
+    return _context->make<ExpressionStatement>(std::move(expr));
 }
 
 cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_expression()
@@ -556,7 +653,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_logical_or()
     while (_match({lx::TokenKind::TOKEN_CMP_OR})) {
         auto op = BinaryExpression::OR;
         auto right = _parse_logical_and();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -575,7 +672,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_logical_and()
     while (_match({lx::TokenKind::TOKEN_CMP_AND})) {
         auto op = BinaryExpression::AND;
         auto right = _parse_equality();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -596,7 +693,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_equality()
     while (_match({lx::TokenKind::TOKEN_EQ, lx::TokenKind::TOKEN_NEQ})) {
         auto op = (_previous().kind == lx::TokenKind::TOKEN_EQ) ? BinaryExpression::EQ : BinaryExpression::NEQ;
         auto right = _parse_comparison();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -640,7 +737,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_comparison()
         }
 
         auto right = _parse_term();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -660,7 +757,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_term()
     while (_match({lx::TokenKind::TOKEN_MINUS, lx::TokenKind::TOKEN_PLUS})) {
         auto op = (_previous().kind == lx::TokenKind::TOKEN_MINUS) ? BinaryExpression::SUB : BinaryExpression::ADD;
         auto right = _parse_factor();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -697,7 +794,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_factor()
         }
 
         auto right = _parse_unary();
-        expr = make<BinaryExpression>(std::move(expr), op, std::move(right));
+        expr = _context->make<BinaryExpression>(std::move(expr), op, std::move(right));
     }
 
     return expr;
@@ -737,7 +834,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_unary()
         }
 
         auto right = _parse_unary();
-        return make<UnaryExpression>(op, std::move(right));
+        return _context->make<UnaryExpression>(op, std::move(right));
     }
 
     return _parse_call();
@@ -767,7 +864,7 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_finish_call(cplus::as
     }
 
     const std::string_view function_name = identifier_expr->name;
-    auto call_expr = make<CallExpression>(function_name);
+    auto call_expr = _context->make<CallExpression>(function_name);
 
     if (!_check(lx::TokenKind::TOKEN_CLOSE_PAREN)) {
         do {
@@ -785,24 +882,24 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_primary()
         auto &token = _previous();
         const std::string str(token.lexeme);
         const i32 value = std::stoi(str);
-        return make<LiteralExpression>(value);
+        return _context->make<LiteralExpression>(value);
     }
 
     if (_match({lx::TokenKind::TOKEN_FLOAT})) {
         auto &token = _previous();
         const std::string str(token.lexeme);
         const float value = std::stof(str);
-        return make<LiteralExpression>(value);
+        return _context->make<LiteralExpression>(value);
     }
 
     if (_match({lx::TokenKind::TOKEN_STRING})) {
         auto &token = _previous();
-        return make<LiteralExpression>(token.lexeme);
+        return _context->make<LiteralExpression>(token.lexeme);
     }
 
     if (_match({lx::TokenKind::TOKEN_CHARACTER})) {
         auto &token = _previous();
-        return make<LiteralExpression>(token.lexeme);
+        return _context->make<LiteralExpression>(token.lexeme);
     }
 
     if (_match({lx::TokenKind::TOKEN_IDENTIFIER})) {
@@ -810,10 +907,10 @@ cplus::ast::ExpressionPtr cplus::ast::AbstractSyntaxTree::_parse_primary()
 
         if (_match({lx::TokenKind::TOKEN_ASSIGN})) {
             auto value = _parse_expression();
-            return make<AssignmentExpression>(token.lexeme, std::move(value));
+            return _context->make<AssignmentExpression>(token.lexeme, std::move(value));
         }
 
-        return make<IdentifierExpression>(token.lexeme);
+        return _context->make<IdentifierExpression>(token.lexeme);
     }
 
     if (_match({lx::TokenKind::TOKEN_OPEN_PAREN})) {
@@ -1,31 +1,9 @@
 #include "CPlus/Arguments.hpp"
 #include "CPlus/Error.hpp"
 #include "CPlus/Logger.hpp"
+#include <CPlus/Parser/Keywords.hpp>
 #include <CPlus/Parser/LexicalAnalyzer.hpp>
 #include <cctype>
-#include <unordered_map>
-
-// clang-format off
-static const std::unordered_map<std::string_view, cplus::lx::TokenKind> keywords = {
-    {"def", cplus::lx::TokenKind::TOKEN_DEF},
-    {"const", cplus::lx::TokenKind::TOKEN_CONST},
-    {"return", cplus::lx::TokenKind::TOKEN_RETURN},
-    {"struct", cplus::lx::TokenKind::TOKEN_STRUCT},
-
-    {"if", cplus::lx::TokenKind::TOKEN_IF},
-    {"elsif", cplus::lx::TokenKind::TOKEN_ELSIF},
-    {"else", cplus::lx::TokenKind::TOKEN_ELSE},
-
-    {"for", cplus::lx::TokenKind::TOKEN_FOR},
-    {"foreach", cplus::lx::TokenKind::TOKEN_FOREACH},
-    {"while", cplus::lx::TokenKind::TOKEN_WHILE},
-    {"in", cplus::lx::TokenKind::TOKEN_IN},
-
-    {"case", cplus::lx::TokenKind::TOKEN_CASE},
-    {"when", cplus::lx::TokenKind::TOKEN_WHEN},
-    {"default", cplus::lx::TokenKind::TOKEN_DEFAULT},
-};
-// clang-format on
 
 /**
  * public
@@ -109,6 +87,9 @@ void cplus::lx::LexicalAnalyzer::_scan_token()
         case ';':
             _add_token(TokenKind::TOKEN_SEMICOLON, ";");
             break;
+        case '@':
+            _add_token(TokenKind::TOKEN_AT, "@");
+            break;
         case '+':
             if (_match('+')) {
                 _add_token(TokenKind::TOKEN_INC, "++");
@@ -316,10 +297,7 @@ void cplus::lx::LexicalAnalyzer::_scan_identifier()
 
     const std::string_view lexeme(_source.data() + start, _position - start);
 
-    const auto it = keywords.find(lexeme);
-    const TokenKind kind = (it != keywords.end()) ? it->second : TokenKind::TOKEN_IDENTIFIER;
-
-    _add_token(kind, lexeme);
+    _add_token(keyword(lexeme), lexeme);
 }
 
 void cplus::lx::LexicalAnalyzer::_scan_string()
@@ -242,6 +242,27 @@ void cplus::ast::ASTLogger::visit(ForStatement &node)
     _pop();
 }
 
+void cplus::ast::ASTLogger::visit(WhileStatement &node)
+{
+    _out << logger::CPLUS_MAGENTA;
+    _show_indent("While\n");
+    _out << logger::CPLUS_RESET;
+    _push();
+    _show_indent("Condition:\n");
+    _push();
+    node.condition->accept(*this);
+    _pop();
+
+    if (node.body) {
+        _show_indent("Body:\n");
+        _push();
+        node.body->accept(*this);
+        _pop();
+    }
+
+    _pop();
+}
+
 void cplus::ast::ASTLogger::visit(ForeachStatement &node)
 {
     _out << logger::CPLUS_MAGENTA;
@@ -281,12 +302,14 @@ void cplus::ast::ASTLogger::visit(CaseStatement &node)
     }
 
     for (const auto &clause : node.clauses) {
-        if (clause.value) {
+        if (!clause.values.empty()) {
             _out << logger::CPLUS_MAGENTA;
             _show_indent("Case:\n");
             _out << logger::CPLUS_RESET;
             _push();
-            clause.value->accept(*this);
+            for (const auto &value : clause.values) {
+                value->accept(*this);
+            }
             _pop();
         } else {
             _out << logger::CPLUS_MAGENTA;
@@ -310,6 +333,10 @@ void cplus::ast::ASTLogger::visit(FunctionDeclaration &node)
     _show_indent(std::string(logger::CPLUS_RED) + "Function " + std::string(logger::CPLUS_BLUE) + std::string(node.name) + "\n");
     _out << logger::CPLUS_RESET;
     _push();
+    for (const auto &attribute : node.attributes) {
+        _show_indent("Attribute: @" + std::string(attribute.name)
+            + (attribute.argument.empty() ? "" : "(" + std::string(attribute.argument) + ")") + "\n");
+    }
     for (auto &p : node.parameters) {
         _show_indent("Param: " + std::string(p.name) + "\n");
     }
@@ -60,6 +60,11 @@ void cplus::ast::ForStatement::accept(cplus::ast::ASTVisitor &visitor)
     visitor.visit(*this);
 }
 
+void cplus::ast::WhileStatement::accept(cplus::ast::ASTVisitor &visitor)
+{
+    visitor.visit(*this);
+}
+
 void cplus::ast::ForeachStatement::accept(cplus::ast::ASTVisitor &visitor)
 {
     visitor.visit(*this);